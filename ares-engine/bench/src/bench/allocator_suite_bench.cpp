@@ -0,0 +1,616 @@
+#include "bench/bench.h"
+#include "core/buddy_allocator.h"
+#include "core/concurrent_bump_allocator.h"
+#include "core/default_allocator.h"
+#include "core/frame_allocator.h"
+#include "core/guarded_allocator.h"
+#include "core/memory_budget.h"
+#include "core/pool_allocator.h"
+#include "core/stack_allocator.h"
+#include "core/temp_allocator.h"
+#include "core/thread_cache_allocator.h"
+#include "core/tlsf_allocator.h"
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+// Runs every allocator through the same workloads so they can be compared
+// and tracked between commits:
+//   suite_burst          quiet frames with periodic bursts, freed or reset per frame
+//   suite_cross_thread   two producers allocate, one consumer frees
+//   suite_trace          replays a recorded trace (ARES_BENCH_TRACE, or a built-in one)
+//   suite_fragmentation  long-running churn whose size mix shifts over time
+//   suite_large_blocks   streaming buffers from 64 KiB to 4 MiB
+// Each allocator is skipped by the workloads it can't serve.
+
+namespace {
+
+	using namespace ares;
+
+	enum subject_traits : uint32_t
+	{
+		frees_blocks = 1 << 0,   // individual frees make memory reusable
+		thread_safe = 1 << 1,
+		small_only = 1 << 2,     // fixed block size of small_size_limit
+		large_only = 1 << 3      // every block is at least 64 KiB
+	};
+
+	constexpr size_t small_size_limit = 256;
+	constexpr size_t latency_sample_rate = 8;
+
+	struct instance
+	{
+		std::unique_ptr<core::allocator> backing;
+		std::unique_ptr<core::memory_budget> budget;
+		std::unique_ptr<core::allocator> alloc;
+	};
+
+	struct subject
+	{
+		const char* name;
+		uint32_t traits;
+		instance (*create)();
+		// Releases a frame's allocations; null for allocators that free one by one.
+		void (*reset)(core::allocator& alloc);
+	};
+
+	template <typename allocator_type, typename... Args>
+	instance make(Args... args)
+	{
+		instance result;
+		result.alloc = std::make_unique<allocator_type>(args...);
+		return result;
+	}
+
+	const subject subjects[] = {
+		{ "malloc", frees_blocks | thread_safe, [] { return make<core::default_allocator>(); }, nullptr },
+		{ "thread_cache", frees_blocks | thread_safe, [] { return make<core::thread_cache_allocator>(); }, nullptr },
+		{ "tlsf", frees_blocks, [] { return make<core::tlsf_allocator>(); }, nullptr },
+		{ "pool_256", frees_blocks | small_only, [] { return make<core::pool_allocator>(small_size_limit); }, nullptr },
+		{ "buddy", frees_blocks | large_only, [] { return make<core::buddy_allocator>(); }, nullptr },
+		{ "guarded_1in64", frees_blocks | thread_safe, []
+			{
+				instance result;
+				result.backing = std::make_unique<core::default_allocator>();
+				result.alloc = std::make_unique<core::guarded_allocator>(result.backing.get(), 64u);
+				return result;
+			}, nullptr },
+		{ "budgeted_malloc", frees_blocks | thread_safe, []
+			{
+				instance result;
+				result.backing = std::make_unique<core::default_allocator>();
+				result.budget = std::make_unique<core::memory_budget>("bench");
+				result.alloc = std::make_unique<core::budgeted_allocator>(result.backing.get(), *result.budget);
+				return result;
+			}, nullptr },
+		{ "temp", 0, [] { return make<core::temp_allocator>(); },
+			[](core::allocator& alloc) { static_cast<core::temp_allocator&>(alloc).reset(); } },
+		{ "frame", thread_safe, [] { return make<core::frame_allocator>(); },
+			[](core::allocator& alloc) { static_cast<core::frame_allocator&>(alloc).flip(); } },
+		{ "stack", 0, [] { return make<core::stack_allocator>(); },
+			[](core::allocator& alloc) { static_cast<core::stack_allocator&>(alloc).rewind(0); } },
+		{ "concurrent_bump", thread_safe, [] { return make<core::concurrent_bump_allocator>(); },
+			[](core::allocator& alloc) { static_cast<core::concurrent_bump_allocator&>(alloc).reset(); } },
+	};
+
+	inline bool has_traits(const subject& entry, uint32_t traits) { return (entry.traits & traits) == traits; }
+
+	// Peak resident growth over a baseline, sampled by the workload.
+	class rss_tracker
+	{
+	public:
+		rss_tracker()
+		{
+			// glibc holds on to freed memory, which would count against whichever
+			// allocator runs next.
+		#if defined(__GLIBC__)
+			malloc_trim(0);
+		#endif
+			baseline_ = bench::current_rss();
+			peak_ = baseline_;
+		}
+
+		inline void sample()
+		{
+			size_t rss = bench::current_rss();
+			peak_ = rss > peak_ ? rss : peak_;
+		}
+
+		inline double peak_mib() const { return (peak_ - baseline_) / 1048576.0; }
+		inline double current_mib() const
+		{
+			size_t rss = bench::current_rss();
+			return rss > baseline_ ? (rss - baseline_) / 1048576.0 : 0.0;
+		}
+
+	private:
+		size_t baseline_ = 0;
+		size_t peak_ = 0;
+	};
+
+	// Times every latency_sample_rate-th call, so the clock reads don't dominate
+	// the throughput figure.
+	template <typename function_type>
+	inline void timed(bench::latency_histogram& latency, size_t op, function_type&& function)
+	{
+		if (op % latency_sample_rate)
+		{
+			function();
+			return;
+		}
+
+		bench::timer timer;
+		function();
+		latency.record(timer.elapsed_ns());
+	}
+
+	void report_latency(const char* benchmark, const char* variant, const char* prefix, const bench::latency_histogram& latency)
+	{
+		static const struct { const char* name; double fraction; } points[] = {
+			{ "p50", 0.5 }, { "p99", 0.99 }, { "p99.9", 0.999 }, { "p99.99", 0.9999 }
+		};
+
+		char metric[64];
+		for (const auto& point : points)
+		{
+			snprintf(metric, sizeof(metric), "%s_%s", prefix, point.name);
+			bench::report(benchmark, variant, metric, latency.percentile(point.fraction), "ns");
+		}
+		snprintf(metric, sizeof(metric), "%s_max", prefix);
+		bench::report(benchmark, variant, metric, latency.max(), "ns");
+	}
+
+	void touch(void* ptr)
+	{
+		if (ptr)
+		{
+			static_cast<volatile char*>(ptr)[0] = 1;
+		}
+	}
+
+	// Trace events: allocate size bytes as id, or free id. Ids are dense.
+	struct trace_event
+	{
+		uint32_t id;
+		uint32_t size;   // 0 for frees
+	};
+
+	// Text format, one event per line: "a <id> <size>" or "f <id>".
+	bool load_trace(const char* path, std::vector<trace_event>& events, uint32_t& id_count)
+	{
+		FILE* file = fopen(path, "r");
+		if (!file)
+		{
+			return false;
+		}
+
+		char op = 0;
+		unsigned long id = 0;
+		unsigned long size = 0;
+		id_count = 0;
+		while (fscanf(file, " %c %lu", &op, &id) == 2)
+		{
+			if (op == 'a' && fscanf(file, " %lu", &size) == 1)
+			{
+				events.push_back({ static_cast<uint32_t>(id), size ? static_cast<uint32_t>(size) : 1u });
+			}
+			else if (op == 'f')
+			{
+				events.push_back({ static_cast<uint32_t>(id), 0 });
+			}
+			id_count = static_cast<uint32_t>(id) + 1 > id_count ? static_cast<uint32_t>(id) + 1 : id_count;
+		}
+		fclose(file);
+		return !events.empty();
+	}
+
+	// Stand-in for a recorded session: mostly small short-lived blocks, some
+	// medium ones and a tail of large long-lived ones.
+	void make_trace(std::vector<trace_event>& events, uint32_t& id_count)
+	{
+		constexpr uint32_t allocation_count = 300000;
+		std::mt19937_64 rng(0x7ACE);
+
+		using death = std::pair<uint64_t, uint32_t>;
+		std::priority_queue<death, std::vector<death>, std::greater<death>> pending;
+		for (uint32_t id = 0; id < allocation_count; id++)
+		{
+			while (!pending.empty() && pending.top().first <= id)
+			{
+				events.push_back({ pending.top().second, 0 });
+				pending.pop();
+			}
+
+			uint32_t kind = static_cast<uint32_t>(rng() % 100);
+			uint32_t size = kind < 60 ? 16 + rng() % 48
+				: kind < 85 ? 64 + rng() % 448
+				: kind < 95 ? 512 + rng() % 3584
+				: 4096 + rng() % 61440;
+			uint64_t lifetime = rng() % 10 == 0 ? 1000 + rng() % 100000 : 1 + rng() % 100;
+			events.push_back({ id, size });
+			pending.push({ id + lifetime, id });
+		}
+		while (!pending.empty())
+		{
+			events.push_back({ pending.top().second, 0 });
+			pending.pop();
+		}
+		id_count = allocation_count;
+	}
+
+	void run_burst(const subject& entry)
+	{
+		constexpr size_t frame_count = 300;
+		constexpr size_t quiet_allocations = 500;
+		constexpr size_t burst_allocations = 20000;
+		constexpr size_t burst_interval = 8;
+
+		instance target = entry.create();
+		core::allocator& alloc = *target.alloc;
+		std::mt19937_64 rng(0xB0257);
+		bench::latency_histogram latency;
+		rss_tracker rss;
+		std::vector<void*> frame;
+		frame.reserve(burst_allocations);
+
+		size_t op = 0;
+		bench::timer timer;
+		for (size_t i = 0; i < frame_count; i++)
+		{
+			size_t count = i % burst_interval == 0 ? burst_allocations : quiet_allocations;
+			for (size_t n = 0; n < count; n++)
+			{
+				size_t size = 16 + rng() % (small_size_limit - 16 + 1);
+				void* ptr = nullptr;
+				timed(latency, op++, [&] { ptr = alloc.allocate(size); });
+				touch(ptr);
+				frame.push_back(ptr);
+			}
+
+			if (entry.reset)
+			{
+				entry.reset(alloc);
+			}
+			else
+			{
+				for (void* ptr : frame)
+				{
+					alloc.deallocate(ptr);
+				}
+			}
+			frame.clear();
+			rss.sample();
+		}
+		double ns = timer.elapsed_ns();
+
+		bench::report("suite_burst", entry.name, "throughput", op / ns * 1000.0, "Mops/s");
+		report_latency("suite_burst", entry.name, "alloc", latency);
+		bench::report("suite_burst", entry.name, "rss_peak", rss.peak_mib(), "MiB");
+	}
+
+	void run_cross_thread(const subject& entry)
+	{
+		constexpr size_t producer_count = 2;
+		constexpr size_t allocations_per_producer = 300000;
+		constexpr size_t batch_size = 64;
+		constexpr size_t max_queued_batches = 256;
+
+		instance target = entry.create();
+		core::allocator& alloc = *target.alloc;
+		rss_tracker rss;
+
+		std::mutex mutex;
+		std::condition_variable changed;
+		std::vector<std::vector<void*>> queue;
+		size_t finished_producers = 0;
+
+		bench::latency_histogram alloc_latency;
+		bench::latency_histogram free_latency;
+
+		bench::timer timer;
+		std::vector<std::thread> producers;
+		for (size_t p = 0; p < producer_count; p++)
+		{
+			producers.emplace_back([&, p]
+			{
+				std::mt19937_64 rng(0xC0DE + p);
+				bench::latency_histogram local_latency;
+				std::vector<void*> batch;
+				for (size_t op = 0; op < allocations_per_producer; op++)
+				{
+					size_t size = 16 + rng() % 1024;
+					void* ptr = nullptr;
+					timed(local_latency, op, [&] { ptr = alloc.allocate(size); });
+					touch(ptr);
+					batch.push_back(ptr);
+
+					if (batch.size() == batch_size || op + 1 == allocations_per_producer)
+					{
+						std::unique_lock<std::mutex> lock(mutex);
+						changed.wait(lock, [&] { return queue.size() < max_queued_batches; });
+						queue.push_back(std::move(batch));
+						batch.clear();
+						changed.notify_all();
+					}
+				}
+
+				std::lock_guard<std::mutex> lock(mutex);
+				if (p == 0)
+				{
+					alloc_latency = local_latency;
+				}
+				finished_producers++;
+				changed.notify_all();
+			});
+		}
+
+		size_t op = 0;
+		std::vector<std::vector<void*>> taken;
+		for (;;)
+		{
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				changed.wait(lock, [&] { return !queue.empty() || finished_producers == producer_count; });
+				if (queue.empty())
+				{
+					break;
+				}
+				taken.swap(queue);
+				changed.notify_all();
+			}
+
+			for (std::vector<void*>& batch : taken)
+			{
+				for (void* ptr : batch)
+				{
+					timed(free_latency, op++, [&] { alloc.deallocate(ptr); });
+				}
+			}
+			taken.clear();
+			if (op % (batch_size * 64) == 0)
+			{
+				rss.sample();
+			}
+		}
+
+		for (std::thread& producer : producers)
+		{
+			producer.join();
+		}
+		double ns = timer.elapsed_ns();
+		rss.sample();
+
+		bench::report("suite_cross_thread", entry.name, "throughput", producer_count * allocations_per_producer / ns * 1000.0, "Mops/s");
+		report_latency("suite_cross_thread", entry.name, "alloc", alloc_latency);
+		report_latency("suite_cross_thread", entry.name, "remote_free", free_latency);
+		bench::report("suite_cross_thread", entry.name, "rss_peak", rss.peak_mib(), "MiB");
+	}
+
+	void run_trace(const subject& entry, const std::vector<trace_event>& events, uint32_t id_count)
+	{
+		instance target = entry.create();
+		core::allocator& alloc = *target.alloc;
+		bench::latency_histogram alloc_latency;
+		bench::latency_histogram free_latency;
+		rss_tracker rss;
+		std::vector<void*> live(id_count, nullptr);
+
+		size_t op = 0;
+		bench::timer timer;
+		for (const trace_event& event : events)
+		{
+			void*& slot = live[event.id];
+			if (event.size)
+			{
+				timed(alloc_latency, op, [&] { slot = alloc.allocate(event.size); });
+				touch(slot);
+			}
+			else
+			{
+				timed(free_latency, op, [&] { alloc.deallocate(slot); });
+				slot = nullptr;
+			}
+
+			if (++op % 4096 == 0)
+			{
+				rss.sample();
+			}
+		}
+		double ns = timer.elapsed_ns();
+
+		for (void* ptr : live)
+		{
+			alloc.deallocate(ptr);
+		}
+
+		bench::report("suite_trace", entry.name, "throughput", op / ns * 1000.0, "Mops/s");
+		report_latency("suite_trace", entry.name, "alloc", alloc_latency);
+		report_latency("suite_trace", entry.name, "free", free_latency);
+		bench::report("suite_trace", entry.name, "rss_peak", rss.peak_mib(), "MiB");
+	}
+
+	void run_fragmentation(const subject& entry)
+	{
+		constexpr size_t round_count = 30;
+		constexpr size_t ops_per_round = 100000;
+		constexpr size_t working_set = 20000;
+		constexpr size_t long_lived = working_set / 20;
+
+		instance target = entry.create();
+		core::allocator& alloc = *target.alloc;
+		std::mt19937_64 rng(0xF2A6);
+		rss_tracker rss;
+
+		struct slot
+		{
+			void* ptr;
+			size_t size;
+		};
+		std::vector<slot> live(working_set, slot{ nullptr, 0 });
+		size_t live_bytes = 0;
+
+		// The size mix moves from small to large blocks and back, so holes left by
+		// one phase have to be reused by the next.
+		auto size_for_round = [&](size_t round)
+		{
+			size_t phase = round % 10 < 5 ? round % 10 : 10 - round % 10;
+			size_t limit = size_t(64) << phase;
+			return 16 + rng() % limit;
+		};
+
+		double first_round = 0.0;
+		double last_round = 0.0;
+		for (size_t round = 0; round < round_count; round++)
+		{
+			bench::timer timer;
+			for (size_t op = 0; op < ops_per_round; op++)
+			{
+				// The first long_lived slots are filled once and then left alone.
+				size_t index = round == 0 && op < long_lived ? op : long_lived + rng() % (working_set - long_lived);
+				slot& entry_slot = live[index];
+				alloc.deallocate(entry_slot.ptr);
+				live_bytes -= entry_slot.size;
+
+				entry_slot.size = size_for_round(round);
+				entry_slot.ptr = alloc.allocate(entry_slot.size);
+				touch(entry_slot.ptr);
+				live_bytes += entry_slot.ptr ? entry_slot.size : 0;
+				entry_slot.size = entry_slot.ptr ? entry_slot.size : 0;
+			}
+			double mops = ops_per_round / timer.elapsed_ns() * 1000.0;
+			first_round = round == 0 ? mops : first_round;
+			last_round = mops;
+			rss.sample();
+		}
+
+		double rss_end = rss.current_mib();
+		double live_mib = live_bytes / 1048576.0;
+		for (slot& entry_slot : live)
+		{
+			alloc.deallocate(entry_slot.ptr);
+		}
+
+		bench::report("suite_fragmentation", entry.name, "first_round", first_round, "Mops/s");
+		bench::report("suite_fragmentation", entry.name, "last_round", last_round, "Mops/s");
+		bench::report("suite_fragmentation", entry.name, "live", live_mib, "MiB");
+		bench::report("suite_fragmentation", entry.name, "rss_end", rss_end, "MiB");
+		bench::report("suite_fragmentation", entry.name, "rss_peak", rss.peak_mib(), "MiB");
+		bench::report("suite_fragmentation", entry.name, "rss_per_live", live_mib > 0.0 ? rss_end / live_mib : 0.0, "x");
+	}
+
+	void run_large_blocks(const subject& entry)
+	{
+		constexpr size_t op_count = 20000;
+		constexpr size_t working_set = 32;
+
+		instance target = entry.create();
+		core::allocator& alloc = *target.alloc;
+		std::mt19937_64 rng(0x1A26E);
+		bench::latency_histogram latency;
+		rss_tracker rss;
+		std::vector<void*> live(working_set, nullptr);
+
+		bench::timer timer;
+		for (size_t op = 0; op < op_count; op++)
+		{
+			size_t log = 16 + rng() % 6;
+			size_t size = (size_t(1) << log) + rng() % (size_t(1) << log);
+			void*& slot = live[rng() % working_set];
+			timed(latency, op, [&]
+			{
+				alloc.deallocate(slot);
+				slot = alloc.allocate(size);
+			});
+			touch(slot);
+			if (op % 256 == 0)
+			{
+				rss.sample();
+			}
+		}
+		double ns = timer.elapsed_ns();
+
+		for (void* ptr : live)
+		{
+			alloc.deallocate(ptr);
+		}
+
+		bench::report("suite_large_blocks", entry.name, "throughput", op_count / ns * 1000.0, "Mops/s");
+		report_latency("suite_large_blocks", entry.name, "replace", latency);
+		bench::report("suite_large_blocks", entry.name, "rss_peak", rss.peak_mib(), "MiB");
+	}
+
+}
+
+ARES_BENCHMARK(suite_burst)
+{
+	for (const subject& entry : subjects)
+	{
+		if (!has_traits(entry, large_only))
+		{
+			run_burst(entry);
+		}
+	}
+}
+
+ARES_BENCHMARK(suite_cross_thread)
+{
+	for (const subject& entry : subjects)
+	{
+		if (has_traits(entry, frees_blocks | thread_safe) && !has_traits(entry, large_only) && !has_traits(entry, small_only))
+		{
+			run_cross_thread(entry);
+		}
+	}
+}
+
+ARES_BENCHMARK(suite_trace)
+{
+	std::vector<trace_event> events;
+	uint32_t id_count = 0;
+	const char* path = getenv("ARES_BENCH_TRACE");
+	if (!path || !load_trace(path, events, id_count))
+	{
+		events.clear();
+		make_trace(events, id_count);
+	}
+
+	for (const subject& entry : subjects)
+	{
+		if (has_traits(entry, frees_blocks) && !has_traits(entry, large_only) && !has_traits(entry, small_only))
+		{
+			run_trace(entry, events, id_count);
+		}
+	}
+}
+
+ARES_BENCHMARK(suite_fragmentation)
+{
+	for (const subject& entry : subjects)
+	{
+		if (has_traits(entry, frees_blocks) && !has_traits(entry, large_only) && !has_traits(entry, small_only))
+		{
+			run_fragmentation(entry);
+		}
+	}
+}
+
+ARES_BENCHMARK(suite_large_blocks)
+{
+	for (const subject& entry : subjects)
+	{
+		if (has_traits(entry, frees_blocks) && !has_traits(entry, small_only))
+		{
+			run_large_blocks(entry);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include "bench/bench.h"
+#include "core/avl_tree.h"
+#include "core/default_allocator.h"
+#include "core/pool_allocator.h"
+#include "core/sys_allocator.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+
+	using namespace ares;
+
+	constexpr size_t key_count = 1000000;
+
+	template <typename allocator_type>
+	void run_build(const char* variant, allocator_type& alloc, const std::vector<eastl::pair<uint64_t, uint64_t>>& sorted)
+	{
+		using tree_type = core::avl_tree<uint64_t, uint64_t, allocator_type>;
+		typename tree_type::allocator_type tree_alloc(&alloc);
+		const double ops = static_cast<double>(sorted.size());
+
+		{
+			tree_type tree(tree_alloc);
+			bench::timer timer;
+			for (const auto& key_value : sorted)
+			{
+				tree.insert(key_value);
+			}
+			bench::report("avl_bulk_build", variant, "insert_sorted", timer.elapsed_ms(), "ms");
+			bench::do_not_optimize(tree.size());
+		}
+
+		tree_type tree(tree_alloc);
+		bench::timer timer;
+		tree.assign_sorted(sorted.begin(), sorted.end());
+		double build_ns = timer.elapsed_ns();
+		bench::report("avl_bulk_build", variant, "assign_sorted", build_ns / 1000000.0, "ms");
+		bench::report("avl_bulk_build", variant, "assign_sorted_rate", ops / build_ns * 1000.0, "Mops/s");
+
+		timer.restart();
+		uint64_t sum = 0;
+		for (const auto& key_value : tree)
+		{
+			sum += key_value.second;
+		}
+		bench::report("avl_bulk_build", variant, "iterate", timer.elapsed_ms(), "ms");
+		bench::do_not_optimize(sum);
+	}
+
+}
+
+ARES_BENCHMARK(avl_bulk_build)
+{
+	std::mt19937_64 rng(0xB017);
+	std::vector<eastl::pair<uint64_t, uint64_t>> unsorted(key_count);
+	for (auto& key_value : unsorted)
+	{
+		key_value = { rng(), 0 };
+	}
+
+	{
+		core::default_allocator heap;
+		using tree_type = core::avl_tree<uint64_t, uint64_t, core::default_allocator>;
+		tree_type::allocator_type tree_alloc(&heap);
+		tree_type tree(tree_alloc);
+		std::vector<eastl::pair<uint64_t, uint64_t>> keys = unsorted;
+		bench::timer timer;
+		tree.sort_and_assign(keys.begin(), keys.end());
+		bench::report("avl_bulk_build", "malloc", "sort_and_assign", timer.elapsed_ms(), "ms");
+	}
+
+	std::vector<eastl::pair<uint64_t, uint64_t>> sorted = unsorted;
+	std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+	{
+		core::default_allocator heap;
+		run_build("malloc", heap, sorted);
+	}
+
+	{
+		using node = core::avl_tree<uint64_t, uint64_t, core::pool_allocator>::node;
+		core::pool_allocator pool(sizeof(node), alignof(node));
+		run_build("pool", pool, sorted);
+	}
+}
\ No newline at end of file
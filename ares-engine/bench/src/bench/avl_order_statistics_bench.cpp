@@ -0,0 +1,82 @@
+#include "bench/bench.h"
+#include "core/avl_tree.h"
+#include "core/default_allocator.h"
+#include <random>
+#include <vector>
+
+namespace {
+
+	using namespace ares;
+
+	constexpr size_t key_count = 1000000;
+	constexpr size_t query_count = 100000;
+	constexpr size_t walk_query_count = 100;
+
+	template <bool order_statistics>
+	double insert_rate(const std::vector<uint64_t>& keys)
+	{
+		core::avl_tree<uint64_t, uint64_t, core::default_allocator, order_statistics> tree;
+		bench::timer timer;
+		for (uint64_t key : keys)
+		{
+			tree.insert({ key, key });
+		}
+		return static_cast<double>(keys.size()) / timer.elapsed_ns() * 1000.0;
+	}
+
+}
+
+ARES_BENCHMARK(avl_order_statistics)
+{
+	std::mt19937_64 rng(0x0057);
+	std::vector<uint64_t> keys(key_count);
+	for (uint64_t& key : keys)
+	{
+		key = rng();
+	}
+
+	bench::report("avl_order_statistics", "plain", "insert", insert_rate<false>(keys), "Mops/s");
+	bench::report("avl_order_statistics", "counted", "insert", insert_rate<true>(keys), "Mops/s");
+	bench::report("avl_order_statistics", "plain", "node_size", sizeof(core::avl_tree<uint64_t, uint64_t>::node), "bytes");
+	bench::report("avl_order_statistics", "counted", "node_size", sizeof(core::avl_tree<uint64_t, uint64_t, core::default_allocator, true>::node), "bytes");
+
+	core::avl_tree<uint64_t, uint64_t, core::default_allocator, true> tree;
+	for (uint64_t key : keys)
+	{
+		tree.insert({ key, key });
+	}
+
+	std::vector<uint64_t> queries(query_count);
+	for (uint64_t& query : queries)
+	{
+		query = rng();
+	}
+
+	// Without the augmentation a rank is an iterator walk from begin().
+	bench::timer timer;
+	size_t total = 0;
+	for (size_t i = 0; i < walk_query_count; i++)
+	{
+		auto bound = tree.lower_bound(queries[i]);
+		for (auto it = tree.begin(); it != bound; ++it)
+		{
+			total++;
+		}
+	}
+	bench::report("avl_order_statistics", "walk", "rank", timer.elapsed_ns() / walk_query_count, "ns/op");
+
+	timer.restart();
+	for (uint64_t query : queries)
+	{
+		total += tree.rank(query);
+	}
+	bench::report("avl_order_statistics", "counted", "rank", timer.elapsed_ns() / query_count, "ns/op");
+
+	timer.restart();
+	for (uint64_t query : queries)
+	{
+		total += tree.nth(query % key_count)->second;
+	}
+	bench::report("avl_order_statistics", "counted", "nth", timer.elapsed_ns() / query_count, "ns/op");
+	bench::do_not_optimize(total);
+}
\ No newline at end of file
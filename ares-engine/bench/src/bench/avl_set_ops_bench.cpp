@@ -0,0 +1,92 @@
+#include "bench/bench.h"
+#include "core/avl_tree.h"
+#include "core/default_allocator.h"
+#include <stdio.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+
+	using namespace ares;
+
+	using tree_type = core::avl_tree<uint64_t, uint64_t>;
+	using key_value = eastl::pair<uint64_t, uint64_t>;
+
+	constexpr size_t base_count = 1000000;
+	constexpr size_t batch_counts[] = { 1000, 100000, 1000000 };
+
+	std::vector<key_value> make_keys(std::mt19937_64& rng, size_t count)
+	{
+		std::vector<key_value> keys(count);
+		for (key_value& entry : keys)
+		{
+			entry = { rng() % (base_count * 4), 0 };
+		}
+		std::sort(keys.begin(), keys.end(), [](const key_value& a, const key_value& b) { return a.first < b.first; });
+		return keys;
+	}
+
+}
+
+ARES_BENCHMARK(avl_set_ops)
+{
+	std::mt19937_64 rng(0x5E7);
+	std::vector<key_value> base = make_keys(rng, base_count);
+
+	for (size_t batch_count : batch_counts)
+	{
+		std::vector<key_value> batch = make_keys(rng, batch_count);
+		std::vector<uint64_t> batch_keys(batch.size());
+		std::transform(batch.begin(), batch.end(), batch_keys.begin(), [](const key_value& entry) { return entry.first; });
+
+		char variant[32];
+		snprintf(variant, sizeof(variant), "batch_%zu", batch_count);
+
+		{
+			tree_type tree;
+			tree.assign_sorted(base.begin(), base.end());
+			bench::timer timer;
+			for (const key_value& entry : batch)
+			{
+				tree.insert(entry);
+			}
+			bench::report("avl_set_ops", variant, "insert_loop", timer.elapsed_ms(), "ms");
+
+			timer.restart();
+			for (uint64_t key : batch_keys)
+			{
+				tree.erase(key);
+			}
+			bench::report("avl_set_ops", variant, "erase_loop", timer.elapsed_ms(), "ms");
+		}
+
+		{
+			tree_type tree;
+			tree.assign_sorted(base.begin(), base.end());
+			bench::timer timer;
+			tree.insert_sorted(batch.begin(), batch.end());
+			bench::report("avl_set_ops", variant, "insert_sorted", timer.elapsed_ms(), "ms");
+
+			timer.restart();
+			tree.erase_sorted(batch_keys.begin(), batch_keys.end());
+			bench::report("avl_set_ops", variant, "erase_sorted", timer.elapsed_ms(), "ms");
+		}
+
+		tree_type other;
+		tree_type tree;
+		const auto run_set_op = [&](const char* metric, void (tree_type::*operation)(tree_type&&))
+		{
+			tree.assign_sorted(base.begin(), base.end());
+			other.assign_sorted(batch.begin(), batch.end());
+			bench::timer timer;
+			(tree.*operation)(eastl::move(other));
+			bench::report("avl_set_ops", variant, metric, timer.elapsed_ms(), "ms");
+		};
+		run_set_op("unite", &tree_type::unite);
+		run_set_op("intersect", &tree_type::intersect);
+		run_set_op("subtract", &tree_type::subtract);
+	}
+
+	bench::report("avl_set_ops", "all", "hardware_threads", std::thread::hardware_concurrency(), "threads");
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+#include "bench/bench.h"
+#include "core/avl_tree.h"
+#include "core/default_allocator.h"
+#include "core/pool_allocator.h"
+#include "core/sys_allocator.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+
+	using namespace ares;
+
+	constexpr size_t key_count = 1000000;
+
+	template <typename allocator_type>
+	void run_tree(const char* variant, allocator_type& alloc, const std::vector<uint64_t>& keys, const std::vector<uint64_t>& lookups)
+	{
+		using tree_type = core::avl_tree<uint64_t, uint64_t, allocator_type>;
+		typename tree_type::allocator_type tree_alloc(&alloc);
+		tree_type tree(tree_alloc);
+
+		bench::cache_miss_counter misses;
+		const double ops = static_cast<double>(keys.size());
+
+		misses.start();
+		bench::timer timer;
+		for (uint64_t key : keys)
+		{
+			tree.insert({ key, key });
+		}
+		double insert_ns = timer.elapsed_ns();
+		uint64_t insert_misses = misses.stop();
+
+		misses.start();
+		timer.restart();
+		uint64_t found = 0;
+		for (uint64_t key : lookups)
+		{
+			found += tree.find(key) != tree.end() ? 1 : 0;
+		}
+		double find_ns = timer.elapsed_ns();
+		uint64_t find_misses = misses.stop();
+		bench::do_not_optimize(found);
+
+		misses.start();
+		timer.restart();
+		for (uint64_t key : lookups)
+		{
+			tree.erase(key);
+		}
+		double erase_ns = timer.elapsed_ns();
+		uint64_t erase_misses = misses.stop();
+
+		bench::report("avl_tree_pool", variant, "insert", ops / insert_ns * 1000.0, "Mops/s");
+		bench::report("avl_tree_pool", variant, "find", ops / find_ns * 1000.0, "Mops/s");
+		bench::report("avl_tree_pool", variant, "erase", ops / erase_ns * 1000.0, "Mops/s");
+		if (misses.available())
+		{
+			bench::report("avl_tree_pool", variant, "insert_misses", insert_misses / ops, "miss/op");
+			bench::report("avl_tree_pool", variant, "find_misses", find_misses / ops, "miss/op");
+			bench::report("avl_tree_pool", variant, "erase_misses", erase_misses / ops, "miss/op");
+		}
+	}
+
+}
+
+ARES_BENCHMARK(avl_tree_pool)
+{
+	std::mt19937_64 rng(0xA2E5);
+	std::vector<uint64_t> keys(key_count);
+	for (uint64_t& key : keys)
+	{
+		key = rng();
+	}
+	std::vector<uint64_t> lookups = keys;
+	std::shuffle(lookups.begin(), lookups.end(), rng);
+
+	{
+		core::default_allocator heap;
+		run_tree("malloc", heap, keys, lookups);
+	}
+
+	{
+		using node = core::avl_tree<uint64_t, uint64_t, core::pool_allocator>::node;
+		core::pool_allocator pool(sizeof(node), alignof(node));
+		run_tree("pool", pool, keys, lookups);
+	}
+}
\ No newline at end of file
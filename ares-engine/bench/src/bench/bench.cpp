@@ -0,0 +1,252 @@
+#include "bench/bench.h"
+#include "core/platform.h"
+#include <stdio.h>
+#include <string>
+#include <time.h>
+#include <vector>
+
+#if ARES_PLATFORM_WINDOWS
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+#if ARES_PLATFORM_LINUX
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace ares::bench {
+
+	static std::vector<benchmark_entry>& registry()
+	{
+		static std::vector<benchmark_entry> result;
+		return result;
+	}
+
+	int register_benchmark(const char* name, bench_function function)
+	{
+		registry().push_back({ name, function });
+		return static_cast<int>(registry().size());
+	}
+
+	const benchmark_entry* get_benchmarks(size_t& count)
+	{
+		count = registry().size();
+		return registry().data();
+	}
+
+	struct result_row
+	{
+		std::string benchmark;
+		std::string variant;
+		std::string metric;
+		std::string unit;
+		double value;
+	};
+
+	static std::vector<result_row>& results()
+	{
+		static std::vector<result_row> result;
+		return result;
+	}
+
+	static void write_json_string(FILE* file, const char* text)
+	{
+		fputc('"', file);
+		for (const char* c = text; *c; c++)
+		{
+			if (*c == '"' || *c == '\\') fprintf(file, "\\%c", *c);
+			else if (static_cast<unsigned char>(*c) < 0x20) fprintf(file, "\\u%04x", *c);
+			else fputc(*c, file);
+		}
+		fputc('"', file);
+	}
+
+	void report(const char* benchmark, const char* variant, const char* metric, double value, const char* unit)
+	{
+		printf("%-24s %-24s %-20s %16.2f %s\n", benchmark, variant, metric, value, unit);
+		fflush(stdout);
+		results().push_back({ benchmark, variant, metric, unit, value });
+	}
+
+	bool write_json(const char* path, const char* label)
+	{
+		FILE* file = fopen(path, "w");
+		if (!file)
+		{
+			return false;
+		}
+
+		fprintf(file, "{\n\t\"label\": ");
+		write_json_string(file, label ? label : "");
+		fprintf(file, ",\n\t\"timestamp\": %lld,\n\t\"results\": [", static_cast<long long>(time(nullptr)));
+
+		const std::vector<result_row>& rows = results();
+		for (size_t i = 0; i < rows.size(); i++)
+		{
+			const result_row& row = rows[i];
+			fprintf(file, "%s\n\t\t{ \"benchmark\": ", i ? "," : "");
+			write_json_string(file, row.benchmark.c_str());
+			fprintf(file, ", \"variant\": ");
+			write_json_string(file, row.variant.c_str());
+			fprintf(file, ", \"metric\": ");
+			write_json_string(file, row.metric.c_str());
+			// JSON has no representation for inf or nan.
+			fprintf(file, ", \"value\": %.17g, \"unit\": ", row.value == row.value && row.value - row.value == 0.0 ? row.value : 0.0);
+			write_json_string(file, row.unit.c_str());
+			fprintf(file, " }");
+		}
+		fprintf(file, "\n\t]\n}\n");
+
+		bool ok = ferror(file) == 0;
+		return fclose(file) == 0 && ok;
+	}
+
+	size_t current_rss()
+	{
+	#if ARES_PLATFORM_LINUX
+		size_t result = 0;
+		if (FILE* file = fopen("/proc/self/statm", "r"))
+		{
+			unsigned long long size = 0, resident = 0;
+			if (fscanf(file, "%llu %llu", &size, &resident) == 2)
+			{
+				result = static_cast<size_t>(resident) * static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+			}
+			fclose(file);
+		}
+		return result;
+	#elif ARES_PLATFORM_WINDOWS
+		PROCESS_MEMORY_COUNTERS counters = {};
+		if (::GetProcessMemoryInfo(::GetCurrentProcess(), &counters, sizeof(counters)))
+		{
+			return static_cast<size_t>(counters.WorkingSetSize);
+		}
+		return 0;
+	#else
+		return 0;
+	#endif
+	}
+
+	// Octave 0 covers [0, 2); octave i above it covers [2^i, 2^(i + 1)).
+	void latency_histogram::record(double ns)
+	{
+		size_t octave = 0;
+		while (octave + 1 < octave_count && ns >= static_cast<double>(uint64_t(1) << (octave + 1)))
+		{
+			octave++;
+		}
+
+		double lower = octave ? static_cast<double>(uint64_t(1) << octave) : 0.0;
+		double width = static_cast<double>(uint64_t(1) << (octave ? octave : 1));
+		size_t step = ns > lower ? static_cast<size_t>((ns - lower) * sub_buckets / width) : 0;
+		if (step >= sub_buckets)
+		{
+			step = sub_buckets - 1;
+		}
+
+		buckets_[octave * sub_buckets + step]++;
+		count_++;
+		if (ns > max_)
+		{
+			max_ = ns;
+		}
+	}
+
+	double latency_histogram::percentile(double fraction) const
+	{
+		uint64_t target = static_cast<uint64_t>(fraction * static_cast<double>(count_));
+		uint64_t seen = 0;
+		for (size_t bucket = 0; bucket < bucket_count; bucket++)
+		{
+			seen += buckets_[bucket];
+			if (seen > target)
+			{
+				double limit = upper_bound(bucket);
+				return limit < max_ ? limit : max_;
+			}
+		}
+		return max_;
+	}
+
+	void latency_histogram::report(const char* benchmark, const char* variant) const
+	{
+		bench::report(benchmark, variant, "p50", percentile(0.5), "ns");
+		bench::report(benchmark, variant, "p99", percentile(0.99), "ns");
+		bench::report(benchmark, variant, "p99.9", percentile(0.999), "ns");
+		bench::report(benchmark, variant, "p99.99", percentile(0.9999), "ns");
+		bench::report(benchmark, variant, "max", max_, "ns");
+
+		for (size_t bucket = 0; bucket < bucket_count; bucket++)
+		{
+			if (buckets_[bucket])
+			{
+				char metric[32];
+				snprintf(metric, sizeof(metric), "<%.15g ns", upper_bound(bucket));
+				bench::report(benchmark, variant, metric, static_cast<double>(buckets_[bucket]), "ops");
+			}
+		}
+	}
+
+	double latency_histogram::upper_bound(size_t bucket)
+	{
+		size_t octave = bucket / sub_buckets;
+		double lower = octave ? static_cast<double>(uint64_t(1) << octave) : 0.0;
+		double width = static_cast<double>(uint64_t(1) << (octave ? octave : 1));
+		return lower + width * static_cast<double>(bucket % sub_buckets + 1) / sub_buckets;
+	}
+
+	cache_miss_counter::cache_miss_counter()
+	{
+	#if ARES_PLATFORM_LINUX
+		perf_event_attr attr = {};
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.size = sizeof(attr);
+		attr.config = PERF_COUNT_HW_CACHE_MISSES;
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		fd_ = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+	#endif
+	}
+
+	cache_miss_counter::~cache_miss_counter()
+	{
+	#if ARES_PLATFORM_LINUX
+		if (fd_ >= 0)
+		{
+			::close(fd_);
+		}
+	#endif
+	}
+
+	void cache_miss_counter::start()
+	{
+	#if ARES_PLATFORM_LINUX
+		if (fd_ >= 0)
+		{
+			::ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+			::ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+		}
+	#endif
+	}
+
+	uint64_t cache_miss_counter::stop()
+	{
+		uint64_t result = 0;
+	#if ARES_PLATFORM_LINUX
+		if (fd_ >= 0)
+		{
+			::ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+			if (::read(fd_, &result, sizeof(result)) != sizeof(result))
+			{
+				result = 0;
+			}
+		}
+	#endif
+		return result;
+	}
+
+}
\ No newline at end of file
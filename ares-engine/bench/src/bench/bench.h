@@ -0,0 +1,109 @@
+#ifndef ARES_BENCH_BENCH_H
+#define ARES_BENCH_BENCH_H
+#include <chrono>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace ares::bench {
+
+	using bench_function = void(*)();
+
+	struct benchmark_entry
+	{
+		const char* name;
+		bench_function function;
+	};
+
+	int register_benchmark(const char* name, bench_function function);
+	const benchmark_entry* get_benchmarks(size_t& count);
+
+	// Prints one result row: benchmark / variant / metric = value unit. Rows are
+	// also kept for write_json().
+	void report(const char* benchmark, const char* variant, const char* metric, double value, const char* unit);
+
+	// Writes every reported row to path as JSON, tagged with label (a commit
+	// hash, say) so runs can be compared. Returns false if the file can't be written.
+	bool write_json(const char* path, const char* label);
+
+	// Resident set size of the process in bytes, 0 where it can't be read.
+	size_t current_rss();
+
+	class timer
+	{
+	public:
+		timer() : start_(clock::now()) {}
+
+		inline void restart() { start_ = clock::now(); }
+		inline double elapsed_ns() const { return std::chrono::duration<double, std::nano>(clock::now() - start_).count(); }
+		inline double elapsed_ms() const { return elapsed_ns() / 1000000.0; }
+
+	private:
+		using clock = std::chrono::steady_clock;
+		clock::time_point start_;
+	};
+
+	// Per-operation latencies in power of two nanosecond buckets.
+	class latency_histogram
+	{
+	public:
+		// Each power of two is split into sub_buckets linear steps, so a
+		// percentile moves by at most a quarter of its value.
+		static constexpr size_t octave_count = 40;
+		static constexpr size_t sub_buckets = 4;
+		static constexpr size_t bucket_count = octave_count * sub_buckets;
+
+		void record(double ns);
+		// Upper bound of the bucket holding the given fraction (0..1) of samples,
+		// but never above the largest sample.
+		double percentile(double fraction) const;
+		inline double max() const { return max_; }
+		inline uint64_t count() const { return count_; }
+
+		// Prints the tail percentiles, the maximum and every non-empty bucket.
+		void report(const char* benchmark, const char* variant) const;
+
+	private:
+		static double upper_bound(size_t bucket);
+
+		uint64_t buckets_[bucket_count] = {};
+		uint64_t count_ = 0;
+		double max_ = 0.0;
+	};
+
+	// Hardware cache-miss counter for the calling thread. Reads as unavailable on
+	// platforms (or containers) without perf events.
+	class cache_miss_counter
+	{
+	public:
+		cache_miss_counter();
+		~cache_miss_counter();
+		cache_miss_counter(const cache_miss_counter&) = delete;
+		cache_miss_counter& operator=(const cache_miss_counter&) = delete;
+
+		inline bool available() const { return fd_ >= 0; }
+		void start();
+		uint64_t stop();
+
+	private:
+		int fd_ = -1;
+	};
+
+	template <typename T>
+	inline void do_not_optimize(const T& value)
+	{
+	#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r,m"(value) : "memory");
+	#else
+		static volatile const void* sink;
+		sink = &value;
+	#endif
+	}
+
+}
+
+#define ARES_BENCHMARK(name)																\
+	static void name();																		\
+	static const int name##_registered = ::ares::bench::register_benchmark(#name, &name);	\
+	static void name()
+
+#endif // ARES_BENCH_BENCH_H
\ No newline at end of file
@@ -0,0 +1,117 @@
+#include "bench/bench.h"
+#include "core/avl_tree.h"
+#include "core/btree.h"
+#include "core/default_allocator.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace {
+
+	using namespace ares;
+
+	// ARES_BENCH_BTREE_KEYS overrides the key count, for the 10M-100M runs.
+	constexpr size_t default_key_count = 1000000;
+	constexpr size_t lookup_count = 1000000;
+
+	template <typename tree_type, typename key_type>
+	void run_tree(const char* benchmark, const char* variant, const std::vector<key_type>& keys, const std::vector<key_type>& lookups)
+	{
+		const double ops = static_cast<double>(keys.size());
+		const double lookup_ops = static_cast<double>(lookups.size());
+	#if defined(__GLIBC__)
+		malloc_trim(0);
+	#endif
+		size_t rss_before = bench::current_rss();
+
+		tree_type tree;
+		bench::timer timer;
+		for (const key_type& key : keys)
+		{
+			tree.insert({ key, 0 });
+		}
+		bench::report(benchmark, variant, "insert", ops / timer.elapsed_ns() * 1000.0, "Mops/s");
+		bench::report(benchmark, variant, "memory", static_cast<double>(bench::current_rss() - rss_before) / ops, "bytes/key");
+
+		timer.restart();
+		size_t found = 0;
+		for (const key_type& key : lookups)
+		{
+			found += tree.find(key) != tree.end() ? 1 : 0;
+		}
+		bench::report(benchmark, variant, "find", lookup_ops / timer.elapsed_ns() * 1000.0, "Mops/s");
+
+		timer.restart();
+		for (const key_type& key : lookups)
+		{
+			found += tree.lower_bound(key) != tree.end() ? 1 : 0;
+		}
+		bench::report(benchmark, variant, "lower_bound", lookup_ops / timer.elapsed_ns() * 1000.0, "Mops/s");
+
+		timer.restart();
+		for (const auto& key_value : tree)
+		{
+			found += key_value.second;
+		}
+		bench::report(benchmark, variant, "iterate", ops / timer.elapsed_ns() * 1000.0, "Mops/s");
+
+		timer.restart();
+		for (const key_type& key : keys)
+		{
+			tree.erase(key);
+		}
+		bench::report(benchmark, variant, "erase", ops / timer.elapsed_ns() * 1000.0, "Mops/s");
+		bench::do_not_optimize(found);
+	}
+
+	template <typename key_type>
+	void run_both(const char* benchmark, const std::vector<key_type>& keys, std::mt19937_64& rng)
+	{
+		std::vector<key_type> lookups(lookup_count);
+		for (key_type& lookup : lookups)
+		{
+			lookup = keys[rng() % keys.size()];
+		}
+
+		run_tree<core::avl_tree<key_type, uint64_t>>(benchmark, "avl_tree", keys, lookups);
+		run_tree<core::btree<key_type, uint64_t>>(benchmark, "btree", keys, lookups);
+	}
+
+}
+
+ARES_BENCHMARK(btree)
+{
+	size_t key_count = default_key_count;
+	if (const char* count = getenv("ARES_BENCH_BTREE_KEYS"))
+	{
+		key_count = strtoull(count, nullptr, 10);
+	}
+
+	std::mt19937_64 rng(0xB7EE);
+	{
+		std::vector<uint64_t> keys(key_count);
+		for (uint64_t& key : keys)
+		{
+			key = rng();
+		}
+		run_both("btree_u64", keys, rng);
+	}
+
+	{
+		std::vector<std::string> keys(key_count);
+		char buffer[32];
+		for (std::string& key : keys)
+		{
+			snprintf(buffer, sizeof(buffer), "entity/%016llx", static_cast<unsigned long long>(rng()));
+			key = buffer;
+		}
+		run_both("btree_string", keys, rng);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#include "bench/bench.h"
+#include "core/buddy_allocator.h"
+#include "core/default_allocator.h"
+#include <random>
+#include <vector>
+
+namespace {
+
+	using namespace ares;
+
+	constexpr size_t op_count = 200000;
+	constexpr size_t working_set = 64;
+
+	// Streaming-buffer sized requests, log-uniform between 64 KiB and 16 MiB.
+	std::vector<size_t> make_sizes()
+	{
+		std::mt19937_64 rng(0xB0DD1E5);
+		std::vector<size_t> result(op_count);
+		for (size_t& size : result)
+		{
+			size_t log = 16 + rng() % 8;
+			size = (size_t(1) << log) + rng() % (size_t(1) << log);
+		}
+		return result;
+	}
+
+	void run_allocator(const char* variant, core::allocator& alloc, const std::vector<size_t>& sizes)
+	{
+		std::mt19937_64 rng(0x5107);
+		std::vector<void*> live(working_set, nullptr);
+
+		bench::timer timer;
+		for (size_t size : sizes)
+		{
+			void*& slot = live[rng() % working_set];
+			alloc.deallocate(slot);
+			slot = alloc.allocate(size);
+			static_cast<char*>(slot)[0] = 1;
+		}
+		double ns = timer.elapsed_ns();
+		bench::report("buddy", variant, "throughput", sizes.size() / ns * 1000.0, "Mops/s");
+
+		for (void* ptr : live)
+		{
+			alloc.deallocate(ptr);
+		}
+	}
+
+}
+
+ARES_BENCHMARK(buddy)
+{
+	std::vector<size_t> sizes = make_sizes();
+
+	{
+		core::default_allocator heap;
+		run_allocator("malloc", heap, sizes);
+	}
+
+	{
+		core::buddy_allocator buddy(4ull * 1024 * 1024 * 1024);
+		run_allocator("buddy", buddy, sizes);
+
+		// Fragmentation while half the working set is live, then what stays
+		// committed once everything is freed.
+		std::mt19937_64 rng(0xF2A6);
+		std::vector<void*> live;
+		for (size_t i = 0; i < working_set; i++)
+		{
+			live.push_back(buddy.allocate(sizes[i]));
+		}
+		for (size_t i = 0; i < working_set; i += 2)
+		{
+			buddy.deallocate(live[i]);
+		}
+		core::buddy_stats stats = buddy.get_stats();
+		bench::report("buddy", "buddy", "internal_fragmentation", stats.internal_fragmentation * 100.0, "%");
+		bench::report("buddy", "buddy", "external_fragmentation", stats.external_fragmentation * 100.0, "%");
+		bench::report("buddy", "buddy", "committed_half_live", stats.committed_bytes / (1024.0 * 1024.0), "MiB");
+
+		for (size_t i = 1; i < working_set; i += 2)
+		{
+			buddy.deallocate(live[i]);
+		}
+		bench::report("buddy", "buddy", "committed_all_free", buddy.committed() / (1024.0 * 1024.0), "MiB");
+	}
+}
\ No newline at end of file
@@ -0,0 +1,127 @@
+#include "bench/bench.h"
+#include "core/concurrent_bump_allocator.h"
+#include "core/default_allocator.h"
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <random>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+namespace {
+
+	using namespace ares;
+
+	constexpr size_t rounds = 64;
+	constexpr size_t allocations_per_round = 16384;
+	constexpr size_t max_block_size = 256;
+
+	class round_barrier
+	{
+	public:
+		explicit round_barrier(size_t count) : count_(count) {}
+
+		void arrive_and_wait()
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			size_t generation = generation_;
+			if (++arrived_ == count_)
+			{
+				arrived_ = 0;
+				generation_++;
+				released_.notify_all();
+				return;
+			}
+			released_.wait(lock, [this, generation] { return generation_ != generation; });
+		}
+
+	private:
+		std::mutex mutex_;
+		std::condition_variable released_;
+		size_t count_;
+		size_t arrived_ = 0;
+		size_t generation_ = 0;
+	};
+
+	// Every round each thread makes a batch of small transient allocations, as a
+	// parallel job would, and the batch is dropped at the end of the round: freed
+	// one by one for the heap, with a single reset for the bump allocator.
+	template <typename allocate_function, typename end_round_function>
+	double run_rounds(size_t thread_count, allocate_function&& allocate, end_round_function&& end_round)
+	{
+		round_barrier barrier(thread_count);
+		std::vector<std::thread> threads;
+		bench::timer timer;
+		for (size_t index = 0; index < thread_count; index++)
+		{
+			threads.emplace_back([&, index]()
+			{
+				std::mt19937 rng(static_cast<uint32_t>(0xB0B + index));
+				std::vector<void*> batch(allocations_per_round);
+				for (size_t round = 0; round < rounds; round++)
+				{
+					for (void*& ptr : batch)
+					{
+						ptr = allocate(8 + rng() % max_block_size);
+						static_cast<char*>(ptr)[0] = 1;
+					}
+					end_round(index, batch);
+					barrier.arrive_and_wait();
+				}
+			});
+		}
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+		return timer.elapsed_ns();
+	}
+
+	void report(const char* variant, size_t thread_count, double ns)
+	{
+		char metric[32];
+		snprintf(metric, sizeof(metric), "t%zu", thread_count);
+		bench::report("concurrent_bump", variant, metric, thread_count * rounds * allocations_per_round / ns * 1000.0, "Mops/s");
+	}
+
+	void run_bump(const char* variant, size_t chunk_size, size_t thread_count)
+	{
+		core::concurrent_bump_allocator bump(core::concurrent_bump_allocator::default_reserve_size, chunk_size);
+		round_barrier reset_barrier(thread_count);
+		double ns = run_rounds(thread_count,
+			[&bump](size_t size) { return bump.allocate(size); },
+			[&bump, &reset_barrier](size_t index, std::vector<void*>&)
+			{
+				// Everyone has to be done allocating before the epoch ends.
+				reset_barrier.arrive_and_wait();
+				if (index == 0) bump.reset();
+			});
+		report(variant, thread_count, ns);
+	}
+
+}
+
+ARES_BENCHMARK(concurrent_bump)
+{
+	size_t hardware = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+	for (size_t thread_count = 1; thread_count <= hardware; thread_count *= 2)
+	{
+		core::default_allocator heap;
+		double ns = run_rounds(thread_count,
+			[&heap](size_t size) { return heap.allocate(size); },
+			[&heap](size_t, std::vector<void*>& batch)
+			{
+				for (void* ptr : batch)
+				{
+					heap.deallocate(ptr);
+				}
+			});
+		report("malloc", thread_count, ns);
+
+		run_bump("bump_chunk64k", core::concurrent_bump_allocator::default_chunk_size, thread_count);
+		// Page-sized chunks send a claim to the shared cursor every few dozen
+		// allocations, which shows what the per-thread chunks buy.
+		run_bump("bump_chunk4k", 4096, thread_count);
+	}
+}
\ No newline at end of file
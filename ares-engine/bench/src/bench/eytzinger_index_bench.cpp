@@ -0,0 +1,100 @@
+#include "bench/bench.h"
+#include "core/avl_tree.h"
+#include "core/btree.h"
+#include "core/eytzinger_index.h"
+#include <stdlib.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+
+	using namespace ares;
+
+	// ARES_BENCH_EYTZINGER_KEYS overrides the key count.
+	constexpr size_t default_key_count = 1000000;
+	constexpr size_t lookup_count = 1000000;
+
+	// Half of the lookups miss, so lower_bound and find see both outcomes.
+	template <typename index_type>
+	void run_lookups(const char* variant, const index_type& index, const std::vector<uint64_t>& lookups)
+	{
+		const double ops = static_cast<double>(lookups.size());
+
+		bench::timer timer;
+		size_t found = 0;
+		for (uint64_t key : lookups)
+		{
+			found += index.find(key) != index.end() ? 1 : 0;
+		}
+		bench::report("eytzinger_index", variant, "find", ops / timer.elapsed_ns() * 1000.0, "Mops/s");
+
+		timer.restart();
+		for (uint64_t key : lookups)
+		{
+			found += index.lower_bound(key) != index.end() ? 1 : 0;
+		}
+		bench::report("eytzinger_index", variant, "lower_bound", ops / timer.elapsed_ns() * 1000.0, "Mops/s");
+		bench::do_not_optimize(found);
+	}
+
+}
+
+ARES_BENCHMARK(eytzinger_index)
+{
+	size_t key_count = default_key_count;
+	if (const char* count = getenv("ARES_BENCH_EYTZINGER_KEYS"))
+	{
+		key_count = strtoull(count, nullptr, 10);
+	}
+
+	// Even keys are present, odd ones miss.
+	std::mt19937_64 rng(0xE172);
+	std::vector<uint64_t> keys(key_count);
+	for (uint64_t& key : keys)
+	{
+		key = rng() & ~uint64_t(1);
+	}
+	std::sort(keys.begin(), keys.end());
+	keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+	std::vector<uint64_t> lookups(lookup_count);
+	for (uint64_t& lookup : lookups)
+	{
+		lookup = keys[rng() % keys.size()] | (rng() & 1);
+	}
+
+	{
+		core::avl_tree<uint64_t> tree;
+		tree.assign_sorted(keys.begin(), keys.end());
+		run_lookups("avl_tree", tree, lookups);
+
+		core::eytzinger_index<uint64_t> index;
+		bench::timer timer;
+		index.freeze(tree);
+		bench::report("eytzinger_index", "eytzinger_index", "freeze", static_cast<double>(keys.size()) / timer.elapsed_ns() * 1000.0, "Mops/s");
+		run_lookups("eytzinger_index", index, lookups);
+	}
+
+	{
+		core::btree<uint64_t> tree;
+		for (uint64_t key : keys)
+		{
+			tree.insert(key);
+		}
+		run_lookups("btree", tree, lookups);
+	}
+
+	{
+		const double ops = static_cast<double>(lookups.size());
+		bench::timer timer;
+		size_t found = 0;
+		for (uint64_t key : lookups)
+		{
+			auto it = std::lower_bound(keys.begin(), keys.end(), key);
+			found += it != keys.end() && *it == key ? 1 : 0;
+		}
+		bench::report("eytzinger_index", "sorted_vector", "find", ops / timer.elapsed_ns() * 1000.0, "Mops/s");
+		bench::do_not_optimize(found);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#include "bench/bench.h"
+#include "core/memory_warmup.h"
+#include "core/temp_allocator.h"
+#include <string.h>
+
+namespace {
+
+	using namespace ares;
+
+	constexpr size_t arena_size = 256ull * 1024 * 1024;
+	constexpr size_t frame_count = 512;
+	constexpr size_t frame_step = arena_size / frame_count - 4096;
+
+	// Each frame moves on to a part of the arena no earlier frame touched, so a
+	// cold arena commits and faults in fresh pages every frame.
+	void run_frames(const char* variant, core::temp_allocator& arena)
+	{
+		bench::latency_histogram frame_latency;
+		for (size_t frame = 0; frame < frame_count; frame++)
+		{
+			bench::timer timer;
+			char* data = static_cast<char*>(arena.allocate(frame_step, 4096));
+			memset(data, static_cast<int>(frame), frame_step);
+			frame_latency.record(timer.elapsed_ns());
+		}
+		arena.reset();
+		frame_latency.report("first_touch_frames", variant);
+	}
+
+}
+
+ARES_BENCHMARK(first_touch_frames)
+{
+	{
+		core::temp_allocator arena(arena_size);
+		run_frames("cold", arena);
+	}
+
+	{
+		core::temp_allocator arena(arena_size);
+		core::memory_warmup warmup;
+		warmup.add(arena, arena_size);
+
+		bench::timer timer;
+		warmup.start();
+		warmup.wait();
+		bench::report("first_touch_frames", "warmed", "warmup", timer.elapsed_ms(), "ms");
+		run_frames("warmed", arena);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,139 @@
+#include "bench/bench.h"
+#include "core/handle_heap.h"
+#include <string.h>
+#include <random>
+#include <vector>
+
+namespace {
+
+	using namespace ares;
+
+	constexpr size_t reserve_size = 64ull * 1024 * 1024;
+	constexpr size_t fill_size = 56ull * 1024 * 1024;
+	constexpr size_t large_size = 16ull * 1024 * 1024;
+	constexpr uint32_t frame_budget_us = 1000;
+	constexpr size_t churn_operations = 200000;
+
+	void report_stats(const char* variant, const core::handle_heap_stats& stats)
+	{
+		bench::report("handle_heap", variant, "free", stats.free_bytes / 1048576.0, "MiB");
+		bench::report("handle_heap", variant, "largest_free", stats.largest_free_block / 1048576.0, "MiB");
+		bench::report("handle_heap", variant, "top", stats.top / 1048576.0, "MiB");
+		bench::report("handle_heap", variant, "fragmentation", stats.fragmentation * 100.0, "%");
+	}
+
+}
+
+ARES_BENCHMARK(handle_heap)
+{
+	core::handle_heap heap(reserve_size);
+	std::mt19937_64 rng(0xDEF7A6);
+
+	// Fill most of the heap with small and medium blocks, then free half of them
+	// at random so the free space is spread all over it.
+	std::vector<core::heap_handle> handles;
+	size_t filled = 0;
+	while (filled < fill_size)
+	{
+		size_t size = 16 + rng() % (rng() % 8 == 0 ? 16384 : 512);
+		core::heap_handle handle = heap.allocate(size);
+		if (!handle) break;
+		handles.push_back(handle);
+		filled += size;
+	}
+	for (core::heap_handle& handle : handles)
+	{
+		if (rng() % 2)
+		{
+			heap.deallocate(handle);
+			handle = core::heap_handle{};
+		}
+	}
+
+	report_stats("before", heap.get_stats());
+	core::heap_handle large = heap.allocate(large_size);
+	bench::report("handle_heap", "before", "large_alloc", large ? 1.0 : 0.0, "ok");
+	heap.deallocate(large);
+
+	uint32_t frames = 0;
+	double max_frame_ns = 0.0;
+	bench::timer total;
+	bool done = false;
+	while (!done)
+	{
+		bench::timer frame;
+		done = heap.compact(frame_budget_us);
+		double ns = frame.elapsed_ns();
+		max_frame_ns = ns > max_frame_ns ? ns : max_frame_ns;
+		frames++;
+	}
+	bench::report("handle_heap", "compact", "frames", frames, "frames");
+	bench::report("handle_heap", "compact", "total", total.elapsed_ms(), "ms");
+	bench::report("handle_heap", "compact", "max_frame", max_frame_ns / 1000.0, "us");
+
+	report_stats("after", heap.get_stats());
+	large = heap.allocate(large_size);
+	bench::report("handle_heap", "after", "large_alloc", large ? 1.0 : 0.0, "ok");
+	heap.deallocate(large);
+
+	for (core::heap_handle handle : handles)
+	{
+		heap.deallocate(handle);
+	}
+
+	// Frees and allocations between partial compactions change the blocks around
+	// where the next compact() resumes. Every live block keeps a fill byte, so a
+	// block moved over another shows up as corrupt.
+	{
+		core::handle_heap churn(reserve_size);
+		struct live_block
+		{
+			core::heap_handle handle;
+			unsigned char fill;
+		};
+		std::vector<live_block> live;
+		size_t corrupt = 0;
+		bench::timer timer;
+		for (size_t operation = 0; operation < churn_operations; operation++)
+		{
+			uint64_t choice = rng() % 10;
+			if (choice < 5)
+			{
+				core::heap_handle handle = churn.allocate(16 + rng() % (rng() % 8 == 0 ? 4096 : 256));
+				if (handle)
+				{
+					unsigned char fill = static_cast<unsigned char>(rng());
+					memset(churn.resolve(handle), fill, churn.size_of(handle));
+					live.push_back({ handle, fill });
+				}
+			}
+			else if (choice < 9 && !live.empty())
+			{
+				size_t index = rng() % live.size();
+				churn.deallocate(live[index].handle);
+				live[index] = live.back();
+				live.pop_back();
+			}
+			else
+			{
+				churn.compact(static_cast<uint32_t>(rng() % 3));
+			}
+		}
+
+		for (const live_block& block : live)
+		{
+			const unsigned char* data = static_cast<const unsigned char*>(churn.resolve(block.handle));
+			for (size_t i = 0; i < churn.size_of(block.handle); i++)
+			{
+				if (data[i] != block.fill)
+				{
+					corrupt++;
+					break;
+				}
+			}
+			churn.deallocate(block.handle);
+		}
+		bench::report("handle_heap", "churn", "operations", churn_operations / timer.elapsed_ns() * 1000.0, "Mops/s");
+		bench::report("handle_heap", "churn", "corrupt_blocks", static_cast<double>(corrupt), "blocks");
+	}
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#include "bench/bench.h"
+#include "core/temp_allocator.h"
+#include <random>
+#include <string.h>
+#include <vector>
+
+namespace {
+
+	using namespace ares;
+
+	constexpr size_t arena_size = 256ull * 1024 * 1024;
+	constexpr size_t access_count = 20000000;
+
+	// Random 8 byte reads across the whole arena; with 4 KiB pages nearly every
+	// access misses the TLB, which is what large pages are meant to cut down.
+	void run_arena(const char* variant, core::internal::page_flags flags, const std::vector<uint32_t>& offsets)
+	{
+		core::temp_allocator arena(arena_size, 0, flags);
+		char* data = static_cast<char*>(arena.allocate(arena_size, 64));
+		if (!data)
+		{
+			bench::report("large_page_random_access", variant, "skipped", 0.0, "");
+			return;
+		}
+
+		bench::timer fill;
+		memset(data, 1, arena_size);
+		bench::report("large_page_random_access", variant, "first_touch", arena_size / fill.elapsed_ns(), "GB/s");
+		bench::report("large_page_random_access", variant, "page_size", static_cast<double>(arena.page_size()) / 1024.0, "KiB");
+
+		bench::cache_miss_counter misses;
+		misses.start();
+		bench::timer timer;
+		uint64_t sum = 0;
+		for (uint32_t offset : offsets)
+		{
+			sum += *reinterpret_cast<const uint64_t*>(data + static_cast<size_t>(offset) * 8);
+		}
+		double total_ns = timer.elapsed_ns();
+		uint64_t miss_count = misses.stop();
+		bench::do_not_optimize(sum);
+
+		bench::report("large_page_random_access", variant, "throughput", offsets.size() / total_ns * 1000.0, "Maccess/s");
+		bench::report("large_page_random_access", variant, "latency", total_ns / offsets.size(), "ns/access");
+		if (misses.available())
+		{
+			bench::report("large_page_random_access", variant, "cache_misses", static_cast<double>(miss_count) / offsets.size(), "per access");
+		}
+	}
+
+}
+
+ARES_BENCHMARK(large_page_random_access)
+{
+	std::mt19937 rng(0x1A29E);
+	std::vector<uint32_t> offsets(access_count);
+	for (uint32_t& offset : offsets)
+	{
+		offset = static_cast<uint32_t>(rng() % (arena_size / 8));
+	}
+
+	run_arena("small_pages", core::internal::page_flags::none, offsets);
+	run_arena("large_pages", core::internal::page_flags::large_pages, offsets);
+}
\ No newline at end of file
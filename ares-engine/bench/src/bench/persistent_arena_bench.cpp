@@ -0,0 +1,148 @@
+#include "bench/bench.h"
+#include "core/avl_tree.h"
+#include "core/offset_ptr.h"
+#include "core/persistent_arena.h"
+#include "core/pool_allocator.h"
+#include "core/sys_allocator.h"
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+	using namespace ares;
+
+	constexpr size_t key_count = 10000000;
+	constexpr size_t lookup_count = 1000000;
+	constexpr uint64_t index_schema = 0x1D3E0001;
+
+	using tree_type = core::avl_tree<uint64_t, uint64_t, core::pool_allocator>;
+
+	// Same shape as the avl_tree it is saved from, with links that survive being
+	// mapped somewhere else.
+	struct index_node
+	{
+		uint64_t key;
+		uint64_t value;
+		core::offset_ptr<index_node> left;
+		core::offset_ptr<index_node> right;
+	};
+
+	struct index_root
+	{
+		uint64_t count;
+		core::offset_ptr<index_node> root;
+	};
+
+	index_node* link(index_node* nodes, size_t begin, size_t end)
+	{
+		if (begin == end) return nullptr;
+
+		size_t middle = begin + (end - begin) / 2;
+		nodes[middle].left = link(nodes, begin, middle);
+		nodes[middle].right = link(nodes, middle + 1, end);
+		return &nodes[middle];
+	}
+
+	const index_node* find(const index_root* index, uint64_t key)
+	{
+		const index_node* node = index->root.get();
+		while (node && node->key != key)
+		{
+			node = key < node->key ? node->left.get() : node->right.get();
+		}
+		return node;
+	}
+
+	template <typename find_function>
+	double run_lookups(const std::vector<uint64_t>& lookups, find_function&& find_key)
+	{
+		bench::timer timer;
+		uint64_t found = 0;
+		for (size_t i = 0; i < lookup_count; i++)
+		{
+			found += find_key(lookups[i]) ? 1 : 0;
+		}
+		double ns = timer.elapsed_ns();
+		bench::do_not_optimize(found);
+		return ns;
+	}
+
+}
+
+ARES_BENCHMARK(persistent_arena)
+{
+	std::mt19937_64 rng(0xF11E);
+	std::vector<uint64_t> keys(key_count);
+	for (uint64_t& key : keys)
+	{
+		key = rng();
+	}
+	std::vector<uint64_t> lookups = keys;
+	std::shuffle(lookups.begin(), lookups.end(), rng);
+
+	std::string path = (std::filesystem::temp_directory_path() / "ares_persistent_arena_bench.bin").string();
+	size_t capacity = sizeof(index_root) + key_count * sizeof(index_node) + 1024 * 1024;
+
+	{
+		core::pool_allocator pool(sizeof(tree_type::node), alignof(tree_type::node));
+		tree_type::allocator_type tree_alloc(&pool);
+		tree_type tree(tree_alloc);
+
+		bench::timer timer;
+		for (uint64_t key : keys)
+		{
+			tree.insert({ key, key });
+		}
+		bench::report("persistent_arena", "cold_rebuild", "build", timer.elapsed_ms(), "ms");
+
+		double ns = run_lookups(lookups, [&](uint64_t key) { return tree.find(key) != tree.end(); });
+		bench::report("persistent_arena", "cold_rebuild", "find", lookup_count / ns * 1000.0, "Mops/s");
+
+		// Saving is a copy into the arena in key order; the links are made after.
+		timer.restart();
+		core::persistent_arena arena(path.c_str(), index_schema, capacity, core::internal::file_open_mode::create);
+		index_root* index = arena.create<index_root>();
+		index_node* nodes = static_cast<index_node*>(arena.allocate(tree.size() * sizeof(index_node), alignof(index_node)));
+		if (!index || !nodes)
+		{
+			bench::report("persistent_arena", "save", "failed", 0.0, "");
+			return;
+		}
+
+		size_t count = 0;
+		for (const auto& entry : tree)
+		{
+			new (&nodes[count++]) index_node{ entry.first, entry.second, nullptr, nullptr };
+		}
+		index->count = count;
+		index->root = link(nodes, 0, count);
+		arena.set_root(index);
+		arena.close();
+		bench::report("persistent_arena", "save", "write", timer.elapsed_ms(), "ms");
+	}
+
+	{
+		bench::timer timer;
+		core::persistent_arena arena(path.c_str(), index_schema, 0, core::internal::file_open_mode::open_existing);
+		const index_root* index = arena.root<index_root>();
+		double open_ms = timer.elapsed_ms();
+		if (!arena.loaded() || !index || index->count != key_count)
+		{
+			bench::report("persistent_arena", "mmap_reload", "failed", 0.0, "");
+			return;
+		}
+		bench::report("persistent_arena", "mmap_reload", "open", open_ms, "ms");
+
+		// The first pass pays for faulting the file in; the second doesn't.
+		double ns = run_lookups(lookups, [&](uint64_t key) { return find(index, key) != nullptr; });
+		bench::report("persistent_arena", "mmap_reload", "first_find", lookup_count / ns * 1000.0, "Mops/s");
+		ns = run_lookups(lookups, [&](uint64_t key) { return find(index, key) != nullptr; });
+		bench::report("persistent_arena", "mmap_reload", "find", lookup_count / ns * 1000.0, "Mops/s");
+	}
+
+	std::error_code error;
+	std::filesystem::remove(path, error);
+}
\ No newline at end of file
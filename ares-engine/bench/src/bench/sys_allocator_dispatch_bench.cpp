@@ -0,0 +1,62 @@
+#include "bench/bench.h"
+#include "core/avl_tree.h"
+#include "core/pool_allocator.h"
+#include "core/sys_allocator.h"
+#include <random>
+#include <vector>
+
+namespace {
+
+	using namespace ares;
+
+	constexpr size_t key_count = 1000000;
+	constexpr int repetitions = 5;
+
+	// The same pool behind both trees: avl_tree<..., allocator> can only reach it
+	// through the vtable, avl_tree<..., pool_allocator> dispatches statically.
+	template <typename allocator_type>
+	double best_insert_ns(const std::vector<uint64_t>& keys)
+	{
+		using tree_type = core::avl_tree<uint64_t, uint64_t, allocator_type>;
+		double best = 0.0;
+		for (int repetition = 0; repetition < repetitions; repetition++)
+		{
+			core::pool_allocator pool(sizeof(typename tree_type::node), alignof(typename tree_type::node));
+			typename tree_type::allocator_type tree_alloc(&pool);
+			tree_type tree(tree_alloc);
+
+			bench::timer timer;
+			for (uint64_t key : keys)
+			{
+				tree.insert({ key, key });
+			}
+			double ns = timer.elapsed_ns();
+			bench::do_not_optimize(tree.size());
+
+			if (repetition == 0 || ns < best)
+			{
+				best = ns;
+			}
+		}
+		return best;
+	}
+
+}
+
+ARES_BENCHMARK(sys_allocator_dispatch)
+{
+	std::mt19937_64 rng(0xD15B);
+	std::vector<uint64_t> sequential(key_count);
+	std::vector<uint64_t> random(key_count);
+	for (size_t i = 0; i < key_count; i++)
+	{
+		sequential[i] = i;
+		random[i] = rng();
+	}
+
+	const double ops = static_cast<double>(key_count);
+	bench::report("sys_allocator_dispatch", "virtual", "insert_sequential", ops / best_insert_ns<core::allocator>(sequential) * 1000.0, "Mops/s");
+	bench::report("sys_allocator_dispatch", "static", "insert_sequential", ops / best_insert_ns<core::pool_allocator>(sequential) * 1000.0, "Mops/s");
+	bench::report("sys_allocator_dispatch", "virtual", "insert_random", ops / best_insert_ns<core::allocator>(random) * 1000.0, "Mops/s");
+	bench::report("sys_allocator_dispatch", "static", "insert_random", ops / best_insert_ns<core::pool_allocator>(random) * 1000.0, "Mops/s");
+}
\ No newline at end of file
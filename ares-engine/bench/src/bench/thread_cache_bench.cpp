@@ -0,0 +1,146 @@
+#include "bench/bench.h"
+#include "core/default_allocator.h"
+#include "core/thread_cache_allocator.h"
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <random>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+namespace {
+
+	using namespace ares;
+
+	constexpr size_t ops_per_thread = 2000000;
+	constexpr size_t working_set = 4096;
+	constexpr size_t max_block_size = 1024;
+	constexpr size_t queue_capacity = 1024;
+
+	// Each thread keeps a ring of live blocks and replaces a random one per step.
+	void local_churn(core::allocator& alloc, uint64_t seed)
+	{
+		std::mt19937_64 rng(seed);
+		std::vector<void*> live(working_set, nullptr);
+		for (size_t i = 0; i < ops_per_thread; i++)
+		{
+			void*& slot = live[rng() % working_set];
+			alloc.deallocate(slot);
+			slot = alloc.allocate(16 + rng() % max_block_size);
+			static_cast<char*>(slot)[0] = 1;
+		}
+		for (void* ptr : live)
+		{
+			alloc.deallocate(ptr);
+		}
+	}
+
+	// Single producer, single consumer ring. Blocks are freed on the consumer thread.
+	class handoff_queue
+	{
+	public:
+		void push(void* ptr)
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			not_full_.wait(lock, [this] { return items_.size() < queue_capacity; });
+			items_.push_back(ptr);
+			not_empty_.notify_one();
+		}
+
+		size_t pop_all(std::vector<void*>& out)
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			not_empty_.wait(lock, [this] { return !items_.empty(); });
+			out.swap(items_);
+			items_.clear();
+			not_full_.notify_one();
+			return out.size();
+		}
+
+	private:
+		std::mutex mutex_;
+		std::condition_variable not_full_;
+		std::condition_variable not_empty_;
+		std::vector<void*> items_;
+	};
+
+	void producer(core::allocator& alloc, handoff_queue& queue, uint64_t seed)
+	{
+		std::mt19937_64 rng(seed);
+		for (size_t i = 0; i < ops_per_thread; i++)
+		{
+			void* ptr = alloc.allocate(16 + rng() % max_block_size);
+			static_cast<char*>(ptr)[0] = 1;
+			queue.push(ptr);
+		}
+		queue.push(nullptr);
+	}
+
+	void consumer(core::allocator& alloc, handoff_queue& queue)
+	{
+		std::vector<void*> batch;
+		for (;;)
+		{
+			queue.pop_all(batch);
+			for (void* ptr : batch)
+			{
+				if (!ptr) return;
+				alloc.deallocate(ptr);
+			}
+		}
+	}
+
+	template <typename function_type>
+	double run_threads(size_t thread_count, function_type&& function)
+	{
+		std::vector<std::thread> threads;
+		bench::timer timer;
+		for (size_t i = 0; i < thread_count; i++)
+		{
+			threads.emplace_back(function, i);
+		}
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+		return timer.elapsed_ns();
+	}
+
+	void run_allocator(const char* variant, core::allocator& alloc)
+	{
+		size_t hardware = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+		for (size_t thread_count = 1; thread_count <= hardware; thread_count *= 2)
+		{
+			double ns = run_threads(thread_count, [&alloc](size_t index) { local_churn(alloc, 0xC0FFEE + index); });
+			char metric[32];
+			snprintf(metric, sizeof(metric), "local_t%zu", thread_count);
+			bench::report("thread_cache", variant, metric, thread_count * ops_per_thread / ns * 1000.0, "Mops/s");
+		}
+
+		size_t pairs = std::max<size_t>(hardware / 2, 1);
+		std::vector<handoff_queue> queues(pairs);
+		double ns = run_threads(pairs * 2, [&alloc, &queues](size_t index) {
+			handoff_queue& queue = queues[index / 2];
+			if (index % 2 == 0) producer(alloc, queue, 0xBEEF + index);
+			else consumer(alloc, queue);
+		});
+		char metric[32];
+		snprintf(metric, sizeof(metric), "remote_p%zu", pairs);
+		bench::report("thread_cache", variant, metric, pairs * ops_per_thread / ns * 1000.0, "Mops/s");
+	}
+
+}
+
+ARES_BENCHMARK(thread_cache)
+{
+	{
+		core::default_allocator heap;
+		run_allocator("malloc", heap);
+	}
+
+	{
+		core::thread_cache_allocator cache;
+		run_allocator("thread_cache", cache);
+	}
+}
\ No newline at end of file
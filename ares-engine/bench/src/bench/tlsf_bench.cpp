@@ -0,0 +1,88 @@
+#include "bench/bench.h"
+#include "core/default_allocator.h"
+#include "core/tlsf_allocator.h"
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+	using namespace ares;
+
+	constexpr size_t op_count = 2000000;
+	constexpr size_t working_set = 16384;
+
+	struct request
+	{
+		size_t slot;
+		size_t size;
+		size_t alignment;
+	};
+
+	// Sizes are log-uniform between 16 bytes and 64 KiB; one request in eight asks
+	// for cache line alignment and one in sixty-four for page alignment.
+	std::vector<request> make_requests()
+	{
+		std::mt19937_64 rng(0x715F);
+		std::vector<request> result(op_count);
+		for (request& entry : result)
+		{
+			entry.slot = rng() % working_set;
+			size_t log = 4 + rng() % 13;
+			entry.size = (size_t(1) << log) + rng() % (size_t(1) << log);
+			uint64_t kind = rng() % 64;
+			entry.alignment = kind == 0 ? 4096 : kind < 8 ? 64 : 16;
+		}
+		return result;
+	}
+
+	void run_allocator(const char* variant, core::allocator& alloc, const std::vector<request>& requests)
+	{
+		std::vector<void*> live(working_set, nullptr);
+		bench::latency_histogram allocate_latency;
+		bench::latency_histogram deallocate_latency;
+
+		bench::timer total;
+		for (const request& entry : requests)
+		{
+			void*& slot = live[entry.slot];
+			if (slot)
+			{
+				bench::timer timer;
+				alloc.deallocate(slot);
+				deallocate_latency.record(timer.elapsed_ns());
+			}
+
+			bench::timer timer;
+			slot = alloc.allocate(entry.size, entry.alignment);
+			allocate_latency.record(timer.elapsed_ns());
+			static_cast<char*>(slot)[0] = 1;
+		}
+		double total_ns = total.elapsed_ns();
+
+		for (void* ptr : live)
+		{
+			alloc.deallocate(ptr);
+		}
+
+		bench::report("tlsf_latency", variant, "throughput", requests.size() / total_ns * 1000.0, "Mops/s");
+		allocate_latency.report("tlsf_latency", (std::string(variant) + ".allocate").c_str());
+		deallocate_latency.report("tlsf_latency", (std::string(variant) + ".deallocate").c_str());
+	}
+
+}
+
+ARES_BENCHMARK(tlsf_latency)
+{
+	std::vector<request> requests = make_requests();
+
+	{
+		core::default_allocator heap;
+		run_allocator("malloc", heap, requests);
+	}
+
+	{
+		core::tlsf_allocator tlsf;
+		run_allocator("tlsf", tlsf, requests);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+#include "bench/bench.h"
+#include <stdio.h>
+#include <string.h>
+
+// Usage: ares_bench [--list] [--json path] [--label text] [name-filter...]
+int main(int argc, char** argv)
+{
+	size_t count = 0;
+	const ares::bench::benchmark_entry* benchmarks = ares::bench::get_benchmarks(count);
+
+	if (argc > 1 && strcmp(argv[1], "--list") == 0)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			printf("%s\n", benchmarks[i].name);
+		}
+		return 0;
+	}
+
+	const char* json_path = nullptr;
+	const char* label = nullptr;
+	const char* filters[64] = {};
+	int filter_count = 0;
+	for (int arg = 1; arg < argc; arg++)
+	{
+		if (strcmp(argv[arg], "--json") == 0 && arg + 1 < argc)
+		{
+			json_path = argv[++arg];
+		}
+		else if (strcmp(argv[arg], "--label") == 0 && arg + 1 < argc)
+		{
+			label = argv[++arg];
+		}
+		else if (filter_count < 64)
+		{
+			filters[filter_count++] = argv[arg];
+		}
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		bool selected = filter_count == 0;
+		for (int filter = 0; filter < filter_count && !selected; filter++)
+		{
+			selected = strstr(benchmarks[i].name, filters[filter]) != nullptr;
+		}
+
+		if (selected)
+		{
+			benchmarks[i].function();
+		}
+	}
+
+	if (json_path && !ares::bench::write_json(json_path, label))
+	{
+		fprintf(stderr, "Failed to write %s\n", json_path);
+		return 1;
+	}
+
+	return 0;
+}
\ No newline at end of file
@@ -8,11 +8,33 @@
 #include "core/avl_node.h"
 #include "core/avl_tree.h"
 #include "core/avl_tree_iterator.h"
+#include "core/btree.h"
+#include "core/btree_iterator.h"
+#include "core/eytzinger_index.h"
+#include "core/eytzinger_index_iterator.h"
 
 // Memory
+#include "core/allocation_tags.h"
+#include "core/allocation_telemetry.h"
 #include "core/allocator.h"
 #include "core/allocator_manager.h"
+#include "core/buddy_allocator.h"
+#include "core/concurrent_bump_allocator.h"
+#include "core/default_allocator.h"
+#include "core/frame_allocator.h"
+#include "core/guarded_allocator.h"
+#include "core/handle_heap.h"
+#include "core/memory_budget.h"
+#include "core/memory_warmup.h"
+#include "core/offset_ptr.h"
+#include "core/page_scavenger.h"
+#include "core/persistent_arena.h"
 #include "core/sys_allocator.h"
+#include "core/pool_allocator.h"
+#include "core/stack_allocator.h"
+#include "core/temp_allocator.h"
+#include "core/thread_cache_allocator.h"
+#include "core/tlsf_allocator.h"
 
 #include "core/type_traits.h"
 #include "core/test.h"
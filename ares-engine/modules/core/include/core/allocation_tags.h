@@ -0,0 +1,41 @@
+#ifndef ARES_CORE_ALLOCATION_TAGS_H
+#define ARES_CORE_ALLOCATION_TAGS_H
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include "core/core_api.h"
+#include "core/atomic.h"
+
+namespace ares::core {
+
+	// Interned allocator names. Telemetry counters and guard sampling rates are
+	// both indexed by tag, so a sys_allocator looks its name up once for both.
+	class ARES_CORE_API allocation_tags
+	{
+	public:
+		using tag = uint32_t;
+
+		static constexpr size_t max_tags = 256;
+		static constexpr size_t max_name_length = 64;
+		// Null names and names past max_tags share this tag.
+		static constexpr tag other_tag = 0;
+
+		allocation_tags();
+		allocation_tags(const allocation_tags&) = delete;
+		allocation_tags& operator=(const allocation_tags&) = delete;
+
+		tag intern(const char* name);
+		const char* name_of(tag value) const noexcept;
+		inline size_t count() const noexcept { return count_.load(memory_order_acquire); }
+
+	private:
+		std::mutex mutex_;
+		char names_[max_tags][max_name_length] = {};
+		atomic<size_t> count_;
+	};
+
+	ARES_CORE_API allocation_tags& get_allocation_tags();
+
+}
+
+#endif // ARES_CORE_ALLOCATION_TAGS_H
\ No newline at end of file
@@ -0,0 +1,120 @@
+#ifndef ARES_CORE_ALLOCATION_TELEMETRY_H
+#define ARES_CORE_ALLOCATION_TELEMETRY_H
+#include <stddef.h>
+#include <stdint.h>
+
+// Telemetry is on in every build except release, where it has to be requested
+// with ARES_ENABLE_ALLOCATION_TELEMETRY. When off, none of it is compiled.
+#ifndef ARES_ALLOCATION_TELEMETRY
+	#if defined(ARES_ENABLE_ALLOCATION_TELEMETRY) || !defined(ARES_BUILD_RELEASE)
+		#define ARES_ALLOCATION_TELEMETRY 1
+	#else
+		#define ARES_ALLOCATION_TELEMETRY 0
+	#endif
+#endif
+
+#if ARES_ALLOCATION_TELEMETRY
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "core/core_api.h"
+#include "core/allocation_tags.h"
+#include "core/atomic.h"
+#include "core/internal/os_page_interface.h"
+
+namespace ares::core {
+
+	struct allocation_stats
+	{
+		static constexpr size_t size_bucket_count = 16;
+
+		const char* name = nullptr;
+		uint64_t live_bytes = 0;
+		// Sum of each thread's own high-water of live bytes, so it bounds the true
+		// peak even between queries. Exact when blocks are freed on the thread
+		// that allocated them; cross-thread frees make it an over-estimate.
+		uint64_t peak_bytes = 0;
+		uint64_t allocations = 0;
+		uint64_t deallocations = 0;
+		uint64_t unsized_deallocations = 0;   // frees that could not update live_bytes
+		uint64_t allocated_bytes = 0;
+		double allocations_per_second = 0.0;  // since the previous query of this tag
+		double bytes_per_second = 0.0;
+		// Allocation counts by size. Bucket 0 holds sizes up to 16 bytes, bucket i
+		// sizes up to 16 << i, and the last bucket everything larger.
+		uint64_t size_histogram[size_bucket_count] = {};
+	};
+
+	// Per-tag allocation counters. Tags come from get_allocation_tags(); each
+	// thread counts into its own block without read-modify-write atomics and
+	// queries add the blocks up.
+	class ARES_CORE_API allocation_telemetry
+	{
+	public:
+		using tag = allocation_tags::tag;
+		using dump_function = void(*)(const allocation_stats* stats, size_t count, void* user_data);
+
+		static constexpr size_t max_tags = allocation_tags::max_tags;
+		static constexpr size_t max_instances = 8;
+		// Null names and names past max_tags are counted here.
+		static constexpr tag other_tag = allocation_tags::other_tag;
+
+		allocation_telemetry(internal::os_page_interface& pages = internal::get_os_page_interface());
+		~allocation_telemetry();
+		allocation_telemetry(const allocation_telemetry&) = delete;
+		allocation_telemetry& operator=(const allocation_telemetry&) = delete;
+
+		inline tag intern(const char* name) { return get_allocation_tags().intern(name); }
+		inline const char* name_of(tag value) const noexcept { return get_allocation_tags().name_of(value); }
+		inline size_t tag_count() const noexcept { return get_allocation_tags().count(); }
+
+		void record_allocate(tag value, size_t size) noexcept;
+		// size is 0 for frees that don't know their size.
+		void record_deallocate(tag value, size_t size) noexcept;
+
+		bool query(tag value, allocation_stats& out);
+		// Fills up to capacity entries, one per tag, and returns the number written.
+		size_t snapshot(allocation_stats* out, size_t capacity);
+
+		// Calls function with a snapshot every interval_ms on a background thread.
+		// Without a function the snapshot is printed with print_stats.
+		void start_periodic_dump(uint32_t interval_ms, dump_function function = nullptr, void* user_data = nullptr);
+		void stop_periodic_dump();
+
+		static void print_stats(const allocation_stats* stats, size_t count, void* user_data);
+
+	private:
+		struct tag_counters;
+		struct thread_counters;
+		struct thread_counters_table;
+		struct tag_sample;
+
+		static thread_counters_table& local_counters();
+		thread_counters* get_thread_counters() noexcept;
+		void release_thread_counters(thread_counters* counters);
+		void aggregate(tag value, allocation_stats& out);
+
+	private:
+		internal::os_page_interface* pages_ = nullptr;
+		uint32_t instance_ = max_instances;
+		uint64_t generation_ = 0;
+
+		tag_sample* samples_ = nullptr;
+
+		std::mutex mutex_;
+		thread_counters* all_counters_ = nullptr;
+		thread_counters* free_counters_ = nullptr;
+
+		std::mutex dump_mutex_;
+		std::condition_variable dump_signal_;
+		std::thread dump_thread_;
+		bool dump_stop_ = false;
+	};
+
+	allocation_telemetry& get_allocation_telemetry();
+
+}
+
+#endif // ARES_ALLOCATION_TELEMETRY
+
+#endif // ARES_CORE_ALLOCATION_TELEMETRY_H
\ No newline at end of file
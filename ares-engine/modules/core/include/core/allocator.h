@@ -1,5 +1,7 @@
 #ifndef ARES_CORE_ALLOCATOR_BASE_H
 #define ARES_CORE_ALLOCATOR_BASE_H
+#include <assert.h>
+#include <stddef.h>
 
 namespace ares::core {
 
@@ -10,7 +12,20 @@ namespace ares::core {
 
 		virtual void* allocate(size_t size) = 0;
 		virtual void* allocate(size_t size, size_t alignment) = 0;
+		// Aligns ptr + offset rather than ptr itself. Backends that cannot place a
+		// block at an arbitrary offset only accept offsets that keep it aligned.
+		virtual void* allocate(size_t size, size_t alignment, size_t offset)
+		{
+			bool aligned = (offset & (alignment - 1)) == 0;
+			assert(aligned && "Allocator does not support misaligned offsets!");
+			return aligned ? allocate(size, alignment) : nullptr;
+		}
+
 		virtual void deallocate(void* ptr) = 0;
+		// Sized frees. size and alignment must be the values passed to allocate, so
+		// backends can find the block without a per-block header.
+		virtual void deallocate(void* ptr, size_t size) { deallocate(ptr); }
+		virtual void deallocate(void* ptr, size_t size, size_t alignment) { deallocate(ptr, size); }
 	};
 
 }
@@ -1,15 +1,71 @@
 #ifndef ARES_CORE_ALLOCATOR_MANAGER_H
 #define ARES_CORE_ALLOCATOR_MANAGER_H
+#include <stddef.h>
+#include <stdint.h>
+#include <EASTL/type_traits.h>
+#include "core/atomic.h"
 
 namespace ares::core {
 
 	class allocator;
 
+	// Registry slots. Every allocator type that can be looked up through
+	// get_allocator<T>() names its slot with a static 'slot' member.
+	// Project allocators take slots from user_begin onwards.
+	enum class allocator_slot : uint32_t
+	{
+		default_heap = 0,
+		temp,
+		thread_cache,
+		frame,
+
+		user_begin = 32,
+		count = 64
+	};
+
+	namespace internal {
+
+		// The slot table is defined in the launcher so every module in the process
+		// shares a single instance.
+		extern atomic<allocator*> allocator_slots[static_cast<size_t>(allocator_slot::count)];
+
+		allocator* resolve_allocator_slot(allocator_slot slot);
+
+	}
+
+	template <typename T, typename = void>
+	struct has_allocator_slot : eastl::false_type {};
+
+	template <typename T>
+	struct has_allocator_slot<T, eastl::void_t<decltype(T::slot)>> : eastl::true_type {};
+
+	template <typename T>
+	inline constexpr bool has_allocator_slot_v = has_allocator_slot<T>::value;
+
+	// Replaces the instance returned for a slot. Existing sys_allocators keep the
+	// instance they were constructed with.
+	void register_allocator(allocator_slot slot, allocator* alloc);
+
 	template <typename allocator_type>
-	allocator* get_allocator()
+	inline void register_allocator(allocator_type* alloc)
 	{
-		assert(false && "This has not been implemented!");
-		return nullptr;
+		static_assert(has_allocator_slot_v<allocator_type>, "Allocator type has no registry slot!");
+		register_allocator(allocator_type::slot, alloc);
+	}
+
+	template <typename allocator_type>
+	inline allocator* get_allocator()
+	{
+		static_assert(has_allocator_slot_v<allocator_type>, "Allocator type has no registry slot!");
+		constexpr size_t index = static_cast<size_t>(allocator_type::slot);
+		static_assert(index < static_cast<size_t>(allocator_slot::count), "Allocator slot is out of range!");
+
+		if (allocator* result = internal::allocator_slots[index].load(memory_order_acquire))
+		{
+			return result;
+		}
+
+		return internal::resolve_allocator_slot(allocator_type::slot);
 	}
 
 }
@@ -10,7 +10,8 @@ namespace ares::core {
 	using atomic_flag = eastl::atomic_flag;
 
 	constexpr auto memory_order_relaxed = eastl::internal::memory_order_relaxed_s{};
-	constexpr auto memory_order_aquire = eastl::internal::memory_order_acquire_s{};
+	constexpr auto memory_order_acquire = eastl::internal::memory_order_acquire_s{};
+	constexpr auto memory_order_aquire = memory_order_acquire;
 	constexpr auto memory_order_acq_rel = eastl::internal::memory_order_acq_rel_s{};
 	constexpr auto memory_order_release = eastl::internal::memory_order_release_s{};
 	constexpr auto memory_order_read_depends = eastl::internal::memory_order_read_depends_s{};
@@ -1,18 +1,34 @@
 #ifndef ARES_CORE_AVL_NODE_H
 #define ARES_CORE_AVL_NODE_H
+#include <stddef.h>
 #include <EASTL/type_traits.h>
 #include <EASTL/utility.h>
 
 namespace ares::core {
 
-	template <typename key, typename value, typename allocator>
+	template <typename key, typename value, typename allocator, bool order_statistics>
 	class avl_tree;
 
-	template <typename key, typename value = void>
-	struct avl_node
+	namespace internal {
+
+		template <bool counted>
+		struct avl_node_size {};
+
+		template <>
+		struct avl_node_size<true>
+		{
+			size_t subtree_size = 1;
+		};
+
+	}
+
+	// counted adds the subtree size used by order-statistic trees; without it
+	// the empty base takes no space.
+	template <typename key, typename value = void, bool counted = false>
+	struct avl_node : internal::avl_node_size<counted>
 	{
 	private:
-		template <typename k, typename v, typename a>
+		template <typename k, typename v, typename a, bool o>
 		friend class avl_tree;
 		struct empty_value {};
 
@@ -37,6 +53,9 @@ namespace ares::core {
 		int32_t height = 0;
 
 	protected:
+		// 1 + the node's index in an avl_tree::assign_sorted batch, or 0 when it
+		// was allocated on its own. Fills the padding after height.
+		uint32_t batch_slot = 0;
 		void* parent_tree = nullptr;;
 	};
 
@@ -1,27 +1,45 @@
 #ifndef ARES_CORE_AVL_TREE_H
 #define ARES_CORE_AVL_TREE_H
+#include <assert.h>
+#include <EASTL/algorithm.h>
 #include <EASTL/functional.h>
+#include <EASTL/sort.h>
 #include <EASTL/variant.h>
 #include <EASTL/utility.h>
+#include <atomic>
+#include <system_error>
+#include <thread>
 #include "core/avl_node.h"
 #include "core/avl_tree_iterator.h"
+#include "core/default_allocator.h"
+#include "core/internal/alignment.h"
+#include "core/sys_allocator.h"
 #include "core/type_traits.h"
 
 namespace ares::core {
 
-	class default_allocator;
+	namespace internal {
 
-	template <typename T>
-	class sys_allocator;
+		// Nodes carry their tree's tag rather than its address, so a set operation
+		// can hand the larger tree's tag to the result along with its nodes.
+		inline void* next_avl_tree_tag() noexcept
+		{
+			static std::atomic<uintptr_t> next{ 1 };
+			return reinterpret_cast<void*>(next.fetch_add(1, std::memory_order_relaxed));
+		}
+
+	}
 
-	template <typename key, typename value = void, typename allocator = default_allocator>
+	// order_statistics keeps a subtree size in every node, for nth, rank and
+	// count_range in O(log n). Trees without it pay nothing for it.
+	template <typename key, typename value = void, typename allocator = default_allocator, bool order_statistics = false>
 	class avl_tree
 	{
 	private:
 		static_assert(eastl::is_void_v<allocator> || is_ares_allocator_v<allocator>, "Invalid allocator type!");
 		static constexpr bool is_allocator_void = eastl::is_void_v<allocator>;
 	public:
-		using node = avl_node<key, value>;
+		using node = avl_node<key, value, order_statistics>;
 
 		using key_type = key;
 		using key_compare = eastl::less<key>;
@@ -46,7 +64,7 @@ namespace ares::core {
 		using const_iterator_pair_type = eastl::pair<const_iterator, const_iterator>;
 
 		avl_tree() {}
-		template <typename = eastl::enable_if_t<!is_allocator_void>> avl_tree(allocator_type& alloc) : allocator_(alloc) {}
+		template <bool enabled = !is_allocator_void, typename = eastl::enable_if_t<enabled>> avl_tree(allocator_type& alloc) : allocator_(alloc) {}
 		~avl_tree() { clear(); }
 		avl_tree(const avl_tree&) = delete;
 		avl_tree& operator=(const avl_tree&) = delete;
@@ -77,48 +95,147 @@ namespace ares::core {
 
 		// Modifiers
 		void clear() { destroy_node(root_); }
-		template <typename = eastl::enable_if_t<!is_allocator_void>> pair_type insert(const value_type& key);
-		template <typename = eastl::enable_if_t<!is_allocator_void>> pair_type insert(value_type&& key);
-		template <typename = eastl::enable_if_t<is_allocator_void>> pair_type insert(node* node_arg);
+		template <bool enabled = !is_allocator_void, typename = eastl::enable_if_t<enabled>> pair_type insert(const value_type& key_value);
+		template <bool enabled = !is_allocator_void, typename = eastl::enable_if_t<enabled>> pair_type insert(value_type&& key_value);
+		template <bool enabled = is_allocator_void, typename = eastl::enable_if_t<enabled>> pair_type insert(node* node_arg);
 		iterator erase(iterator pos);
 		iterator erase(iterator first, iterator last);
-		size_type erase(const key_type& key) { return delete_internal(root_, key) ? 1 : 0; }
-		size_type erase(key_type&& key) { return delete_internal(root_, eastl::move(key)) ? 1 : 0; }
-		template <typename = eastl::enable_if_t<is_allocator_void>> size_type erase(node* node_arg);
+		size_type erase(const key_type& key_arg) { return delete_internal(root_, key_arg) ? 1 : 0; }
+		size_type erase(key_type&& key_arg) { return delete_internal(root_, eastl::move(key_arg)) ? 1 : 0; }
+		template <bool enabled = is_allocator_void, typename = eastl::enable_if_t<enabled>> size_type erase(node* node_arg);
+		// Replaces the contents with [first, last) in O(n), building a perfectly
+		// balanced tree whose nodes come from one allocation. The range should be
+		// sorted by key; keys equal to the previous one are dropped, and unsorted
+		// input falls back to inserting one at a time. Returns false and leaves the
+		// tree empty when allocation fails.
+		template <typename forward_iterator, bool enabled = !is_allocator_void, typename = eastl::enable_if_t<enabled>> bool assign_sorted(forward_iterator first, forward_iterator last);
+		// Sorts [first, last) in place, then assign_sorted.
+		template <typename random_iterator, bool enabled = !is_allocator_void, typename = eastl::enable_if_t<enabled>> bool sort_and_assign(random_iterator first, random_iterator last);
+		// Join-based set operations, O(m log(n/m + 1)) for sizes m <= n. They take
+		// other's nodes, so other must share this tree's allocator and is left
+		// empty. Nodes that drop out are freed, or unlinked in intrusive trees, and
+		// on equal keys this tree's node is kept. Large subtrees are processed on
+		// worker threads.
+		void unite(avl_tree&& other);
+		void intersect(avl_tree&& other);
+		void subtract(avl_tree&& other);
+		// Builds the range with assign_sorted and unites it with the tree; keys
+		// already present are kept, as with insert.
+		template <typename forward_iterator, bool enabled = !is_allocator_void, typename = eastl::enable_if_t<enabled>> bool insert_sorted(forward_iterator first, forward_iterator last);
+		// Erases every key in the sorted range; returns how many were found.
+		template <typename random_iterator> size_type erase_sorted(random_iterator first, random_iterator last);
 
 		// Lookup
-		iterator find(const key_type& key);
-		const_iterator find(const key_type& key) const;
-		iterator_pair_type equal_range(const key_type& key) { return { lower_bound(key), upper_bound(key) }; }
-		const_iterator_pair_type equal_range(const key_type& key) const { return { lower_bound(key), upper_bound(key) }; }
-		iterator lower_bound(const key_type& key) { return iterator(lower_bound_internal(key)); }
-		const_iterator lower_bound(const key_type& key) const { return const_iterator(lower_bound_internal(key)); }
-		iterator upper_bound(const key_type& key) { return iterator(upper_bound_internal(key)); }
-		const_iterator upper_bound(const key_type& key) const { return const_iterator(upper_bound_internal(key)); }
+		iterator find(const key_type& key_arg);
+		const_iterator find(const key_type& key_arg) const;
+		iterator_pair_type equal_range(const key_type& key_arg) { return { lower_bound(key_arg), upper_bound(key_arg) }; }
+		const_iterator_pair_type equal_range(const key_type& key_arg) const { return { lower_bound(key_arg), upper_bound(key_arg) }; }
+		iterator lower_bound(const key_type& key_arg) { return iterator(lower_bound_internal(key_arg)); }
+		const_iterator lower_bound(const key_type& key_arg) const { return const_iterator(lower_bound_internal(key_arg)); }
+		iterator upper_bound(const key_type& key_arg) { return iterator(upper_bound_internal(key_arg)); }
+		const_iterator upper_bound(const key_type& key_arg) const { return const_iterator(upper_bound_internal(key_arg)); }
+
+		// Order statistics
+		// The index-th smallest element, or end() when index >= size().
+		template <bool enabled = order_statistics, typename = eastl::enable_if_t<enabled>> iterator nth(size_type index) { return iterator(nth_internal(index)); }
+		template <bool enabled = order_statistics, typename = eastl::enable_if_t<enabled>> const_iterator nth(size_type index) const { return const_iterator(nth_internal(index)); }
+		// Number of keys less than key_arg.
+		template <bool enabled = order_statistics, typename = eastl::enable_if_t<enabled>> size_type rank(const key_type& key_arg) const;
+		// Number of keys in [low, high).
+		template <bool enabled = order_statistics, typename = eastl::enable_if_t<enabled>> size_type count_range(const key_type& low, const key_type& high) const;
 
 		// Other
-		template <typename = eastl::enable_if_t<!is_allocator_void>> allocator_type& get_allocator() const { return allocator_; }
+		template <bool enabled = !is_allocator_void, typename = eastl::enable_if_t<enabled>> allocator_type& get_allocator() const { return allocator_; }
 
 	private:
-		template <typename = eastl::enable_if_t<!is_allocator_void>> node* allocate_node();
-		template <typename = eastl::enable_if_t<!is_allocator_void>> node* allocate_node(const value_type& key_value);
-		template <typename = eastl::enable_if_t<!is_allocator_void>> node* allocate_node(value_type&& key_value);
-		template <typename = eastl::enable_if_t<!is_allocator_void>> void deallocate_node(node* node_arg);
+		// Header of a block of nodes from assign_sorted; the nodes follow it. Each
+		// node finds it from its batch_slot, and the last one out frees it.
+		struct node_batch
+		{
+			size_type count;
+			size_type live;
+		};
+
+		static constexpr size_type batch_offset = internal::align_up(sizeof(node_batch), alignof(node));
+		static constexpr size_type batch_alignment = alignof(node) > alignof(node_batch) ? alignof(node) : alignof(node_batch);
+		static constexpr size_type max_batch_nodes = 0xffffffffu;
+		static node* batch_nodes(node_batch* batch) noexcept { return reinterpret_cast<node*>(reinterpret_cast<char*>(batch) + batch_offset); }
+		static node_batch* batch_of(node* node_arg) noexcept { return reinterpret_cast<node_batch*>(reinterpret_cast<char*>(node_arg - (node_arg->batch_slot - 1)) - batch_offset); }
+
+		// Subtrees dropped by a set operation, chained through their root's parent
+		// and freed once the workers are done.
+		struct discarded_nodes
+		{
+			node* head = nullptr;
+			node* tail = nullptr;
+		};
+
+		// Subtrees lower than this are not worth a thread.
+		static constexpr int32_t parallel_min_height = 14;
+
+		template <bool enabled = !is_allocator_void, typename = eastl::enable_if_t<enabled>> node* allocate_node();
+		template <bool enabled = !is_allocator_void, typename = eastl::enable_if_t<enabled>> node* allocate_node(const value_type& key_value);
+		template <bool enabled = !is_allocator_void, typename = eastl::enable_if_t<enabled>> node* allocate_node(value_type&& key_value);
+		template <bool enabled = !is_allocator_void, typename = eastl::enable_if_t<enabled>> void deallocate_node(node* node_arg);
+		template <typename forward_iterator> node* build_sorted(forward_iterator& it, forward_iterator last, size_type count, node_batch* batch, bool& failed);
+		node* adopt(avl_tree& other);
+
+		// Set operations hand back detached subtrees, with a null parent.
+		void detach_children(node* node_arg, node*& left, node*& right) noexcept;
+		node* rebalance_to_root(node* node_arg) noexcept;
+		node* join(node* left, node* middle, node* right) noexcept;
+		node* join_right(node* left, node* middle, node* right) noexcept;
+		node* join_left(node* left, node* middle, node* right) noexcept;
+		node* join2(node* left, node* right) noexcept;
+		node* extract_maximum(node*& root) noexcept;
+		node* split(node* root, const key_type& key_arg, node*& left, node*& right) noexcept;
+		node* unite_internal(node* tree_a, node* tree_b, uint32_t depth, discarded_nodes& discarded);
+		node* intersect_internal(node* tree_a, node* tree_b, uint32_t depth, discarded_nodes& discarded);
+		node* subtract_internal(node* tree_a, node* tree_b, uint32_t depth, discarded_nodes& discarded);
+		template <typename random_iterator> node* erase_sorted_internal(node* root, random_iterator first, random_iterator last, uint32_t depth, discarded_nodes& discarded);
+		void discard(discarded_nodes& discarded, node* subtree) noexcept;
+		void splice(discarded_nodes& discarded, discarded_nodes& other) noexcept;
+		size_type release_discarded(discarded_nodes& discarded);
+
+		static uint32_t parallel_depth() noexcept;
+		template <typename left_task, typename right_task> static void fork(bool parallel, left_task&& left, right_task&& right);
+
+		template <typename data_type>
+		static const key_type& key_of(const data_type& data) noexcept
+		{
+			if constexpr (eastl::is_void_v<value>)
+			{
+				return data;
+			}
+			else
+			{
+				return data.first;
+			}
+		}
 
 		int32_t height(node* node_arg) const noexcept { return node_arg ? node_arg->height : -1; }
 		int32_t balance_factor(node* node_arg) const noexcept { return height(node_arg->left) - height(node_arg->right); }
-		void update_height(node* node_arg) noexcept { node_arg->height = 1 + eastl::max(height(node_arg->left), height(node_arg->right)); }
+		size_type subtree_size(node* node_arg) const noexcept { return node_arg ? node_arg->subtree_size : 0; }
+		void update_height(node* node_arg) noexcept
+		{
+			node_arg->height = 1 + eastl::max(height(node_arg->left), height(node_arg->right));
+			if constexpr (order_statistics)
+			{
+				node_arg->subtree_size = 1 + subtree_size(node_arg->left) + subtree_size(node_arg->right);
+			}
+		}
 		node* rotate_left(node* node_arg) noexcept;
 		node* rotate_right(node* node_arg) noexcept;
 		node* balance(node* node_arg) noexcept;
 		node* insert_internal(node*& root, node* node_arg, bool& inserted) noexcept;
-		bool delete_internal(node*& root, const key_type& key);
+		bool delete_internal(node*& root, const key_type& key_arg);
 		bool delete_node_internal(node*& root, node* node_arg);
 		void destroy_node(node* node_arg);
 		void swap_nodes(node* node_a, node* node_b);
-		node* find_node_internal(node* root, const key_type& key) const;
-		node* lower_bound_internal(const key_type& key) const;
-		node* upper_bound_internal(const key_type& key) const;
+		node* find_node_internal(node* root, const key_type& key_arg) const;
+		node* lower_bound_internal(const key_type& key_arg) const;
+		node* upper_bound_internal(const key_type& key_arg) const;
+		node* nth_internal(size_type index) const;
 		node* maximum(node* node_arg) const;
 		node* minimum(node* node_arg) const;
 		node* prev_node(node* node_arg) const;
@@ -138,15 +255,16 @@ namespace ares::core {
 		size_type size_ = 0;
 		key_compare compare_;
 		allocator_type allocator_;
+		void* tag_ = internal::next_avl_tree_tag();
 	};
 
 	//
 	// Constructors
 	//
-	template <typename key, typename value, typename allocator>
-	inline avl_tree<key, value, allocator>::avl_tree(avl_tree<key, value, allocator>&& other) noexcept
-		: root_(eastl::exchange(other.root_, nullptr))
-		size_(eastl::exchange(other.size_, 0))
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline avl_tree<key, value, allocator, order_statistics>::avl_tree(avl_tree<key, value, allocator, order_statistics>&& other) noexcept
+		: root_(eastl::exchange(other.root_, nullptr)),
+		size_(eastl::exchange(other.size_, 0)),
 		compare_(eastl::move(other.compare_)),
 		allocator_()
 	{
@@ -154,10 +272,11 @@ namespace ares::core {
 			{
 				allocator_ = other.allocator_;
 			}
+			eastl::swap(tag_, other.tag_);
 	}
 
-	template <typename key, typename value, typename allocator>
-	inline avl_tree<key, value, allocator>& avl_tree<key, value, allocator>::operator=(avl_tree<key, value, allocator>&& other) noexcept
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline avl_tree<key, value, allocator, order_statistics>& avl_tree<key, value, allocator, order_statistics>::operator=(avl_tree<key, value, allocator, order_statistics>&& other) noexcept
 	{
 		if (this != &other)
 		{
@@ -166,6 +285,7 @@ namespace ares::core {
 			root_ = eastl::exchange(other.root_, nullptr);
 			size_ = eastl::exchange(other.size_, 0);
 			compare_ = eastl::move(other.compare_);
+			eastl::swap(tag_, other.tag_);
 
 			if constexpr (!is_allocator_void)
 			{
@@ -177,11 +297,11 @@ namespace ares::core {
 
 	//
 	// STL/EASTL - MODIFIERS
-	template <typename key, typename value, typename allocator>
-	template <typename>
-	inline typename avl_tree<key, value, allocator>::pair_type avl_tree<key, value, allocator>::insert(const value_type& key)
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	template <bool enabled, typename>
+	inline typename avl_tree<key, value, allocator, order_statistics>::pair_type avl_tree<key, value, allocator, order_statistics>::insert(const value_type& key_value)
 	{
-		node* node_insert = allocate_node(key);
+		node* node_insert = allocate_node(key_value);
 
 		if (!node_insert)
 		{
@@ -199,11 +319,11 @@ namespace ares::core {
 		return { iterator(result), inserted };
 	}
 
-	template <typename key, typename value, typename allocator>
-	template <typename>
-	inline typename avl_tree<key, value, allocator>::pair_type avl_tree<key, value, allocator>::insert(value_type&& key)
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	template <bool enabled, typename>
+	inline typename avl_tree<key, value, allocator, order_statistics>::pair_type avl_tree<key, value, allocator, order_statistics>::insert(value_type&& key_value)
 	{
-		node* node_insert = allocate_node(eastl::move(key));
+		node* node_insert = allocate_node(eastl::move(key_value));
 
 		if (!node_insert)
 		{
@@ -221,9 +341,9 @@ namespace ares::core {
 		return { iterator(result), inserted };
 	}
 
-	template <typename key, typename value, typename allocator>
-	template <typename>
-	inline typename avl_tree<key, value, allocator>::pair_type avl_tree<key, value, allocator>::insert(node* node_arg)
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	template <bool enabled, typename>
+	inline typename avl_tree<key, value, allocator, order_statistics>::pair_type avl_tree<key, value, allocator, order_statistics>::insert(node* node_arg)
 	{
 		if (!node_arg)
 		{
@@ -231,23 +351,23 @@ namespace ares::core {
 			throw std::invalid_argument("Tried to insert a non-existent node.");
 		}
 
-		if (node_arg->parent_tree && node_arg->parent_tree != static_cast<void*>(this))
+		if (node_arg->parent_tree && node_arg->parent_tree != tag_)
 		{
 			throw std::invalid_argument("Tried to insert a node that doesn't belong to this tree.");
 		}
 
-		node_arg->parent_tree = static_cast<void*>(this);
+		node_arg->parent_tree = tag_;
 		bool inserted = false;
 		node* result = insert_internal(root_, node_arg, inserted);
 
 		return { iterator(result), inserted };
 	}
 
-	template <typename key, typename value, typename allocator>
-	inline typename avl_tree<key, value, allocator>::iterator avl_tree<key, value, allocator>::erase(iterator pos)
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline typename avl_tree<key, value, allocator, order_statistics>::iterator avl_tree<key, value, allocator, order_statistics>::erase(iterator pos)
 	{
 		node* node_erase = pos.get_node();
-		if (node_erase && (!node_erase->parent_tree || node_erase->parent_tree != static_cast<void*>(this)))
+		if (node_erase && (!node_erase->parent_tree || node_erase->parent_tree != tag_))
 		{
 			throw std::invalid_argument("Tried to erase an iterator that doesn't belong to this tree.");
 		}
@@ -262,8 +382,8 @@ namespace ares::core {
 		return pos;
 	}
 
-	template <typename key, typename value, typename allocator>
-	inline typename avl_tree<key, value, allocator>::iterator avl_tree<key, value, allocator>::erase(iterator first, iterator last)
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline typename avl_tree<key, value, allocator, order_statistics>::iterator avl_tree<key, value, allocator, order_statistics>::erase(iterator first, iterator last)
 	{
 		while (first != last)
 		{
@@ -272,11 +392,11 @@ namespace ares::core {
 		return last;
 	}
 
-	template <typename key, typename value, typename allocator>
-	template <typename>
-	inline typename avl_tree<key, value, allocator>::size_type avl_tree<key, value, allocator>::erase(node* node_arg)
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	template <bool enabled, typename>
+	inline typename avl_tree<key, value, allocator, order_statistics>::size_type avl_tree<key, value, allocator, order_statistics>::erase(node* node_arg)
 	{
-		if (node_arg && (!node_arg->parent_tree || node_arg->parent_tree != static_cast<void*>(this)))
+		if (node_arg && (!node_arg->parent_tree || node_arg->parent_tree != tag_))
 		{
 			throw std::invalid_argument("Tried to erase a node that doesn't belong to this tree.");
 		}
@@ -284,13 +404,150 @@ namespace ares::core {
 		return delete_node_internal(root_, node_arg) ? 1 : 0;
 	}
 
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	template <typename forward_iterator, bool enabled, typename>
+	inline bool avl_tree<key, value, allocator, order_statistics>::assign_sorted(forward_iterator first, forward_iterator last)
+	{
+		clear();
+
+		size_type count = 0;
+		bool sorted = true;
+		for (forward_iterator it = first, prev = first; it != last; prev = it, ++it)
+		{
+			if (it == first || compare_(key_of(*prev), key_of(*it)))
+			{
+				count++;
+			}
+			else if (compare_(key_of(*it), key_of(*prev)))
+			{
+				sorted = false;
+				break;
+			}
+		}
+
+		if (!sorted)
+		{
+			for (; first != last; ++first)
+			{
+				if (!insert(*first).second && find(key_of(*first)) == end())
+				{
+					clear();
+					return false;
+				}
+			}
+			return true;
+		}
+
+		if (count == 0)
+		{
+			return true;
+		}
+
+		// A fixed-size allocator cannot serve the batch, so it gets a node at a time.
+		node_batch* batch = nullptr;
+		if constexpr (!is_fixed_size_allocator_v<allocator>)
+		{
+			if (count < max_batch_nodes)
+			{
+				if (void* mem = allocator_.allocate(batch_offset + count * sizeof(node), batch_alignment))
+				{
+					batch = new (mem) node_batch{ count, 0 };
+				}
+			}
+		}
+
+		bool failed = false;
+		root_ = build_sorted(first, last, count, batch, failed);
+		if (failed)
+		{
+			clear();
+			return false;
+		}
+		return true;
+	}
+
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	template <typename random_iterator, bool enabled, typename>
+	inline bool avl_tree<key, value, allocator, order_statistics>::sort_and_assign(random_iterator first, random_iterator last)
+	{
+		eastl::sort(first, last, [this](const auto& a, const auto& b) { return compare_(key_of(a), key_of(b)); });
+		return assign_sorted(first, last);
+	}
+
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline void avl_tree<key, value, allocator, order_statistics>::unite(avl_tree&& other)
+	{
+		if (&other == this) return;
+
+		size_type total = size_ + other.size_;
+		node* other_root = adopt(other);
+		discarded_nodes discarded;
+		root_ = unite_internal(root_, other_root, parallel_depth(), discarded);
+		size_ = total - release_discarded(discarded);
+	}
+
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline void avl_tree<key, value, allocator, order_statistics>::intersect(avl_tree&& other)
+	{
+		if (&other == this) return;
+
+		size_type total = size_ + other.size_;
+		node* other_root = adopt(other);
+		discarded_nodes discarded;
+		root_ = intersect_internal(root_, other_root, parallel_depth(), discarded);
+		size_ = total - release_discarded(discarded);
+	}
+
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline void avl_tree<key, value, allocator, order_statistics>::subtract(avl_tree&& other)
+	{
+		if (&other == this)
+		{
+			clear();
+			return;
+		}
+
+		size_type total = size_ + other.size_;
+		node* other_root = adopt(other);
+		discarded_nodes discarded;
+		root_ = subtract_internal(root_, other_root, parallel_depth(), discarded);
+		size_ = total - release_discarded(discarded);
+	}
+
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	template <typename forward_iterator, bool enabled, typename>
+	inline bool avl_tree<key, value, allocator, order_statistics>::insert_sorted(forward_iterator first, forward_iterator last)
+	{
+		avl_tree batch(allocator_);
+		if (!batch.assign_sorted(first, last))
+		{
+			return false;
+		}
+
+		unite(eastl::move(batch));
+		return true;
+	}
+
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	template <typename random_iterator>
+	inline typename avl_tree<key, value, allocator, order_statistics>::size_type avl_tree<key, value, allocator, order_statistics>::erase_sorted(random_iterator first, random_iterator last)
+	{
+		assert(eastl::is_sorted(first, last, compare_) && "Keys must be sorted!");
+
+		discarded_nodes discarded;
+		root_ = erase_sorted_internal(root_, first, last, parallel_depth(), discarded);
+		size_type erased = release_discarded(discarded);
+		size_ -= erased;
+		return erased;
+	}
+
 	//
 	// STL/EASTL - LOOKUP
 	//
-	template <typename key, typename value, typename allocator>
-	inline typename avl_tree<key, value, allocator>::iterator avl_tree<key, value, allocator>::find(const key_type& key)
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline typename avl_tree<key, value, allocator, order_statistics>::iterator avl_tree<key, value, allocator, order_statistics>::find(const key_type& key_arg)
 	{
-		if (node* node_find = find_node_internal(root_, key))
+		if (node* node_find = find_node_internal(root_, key_arg))
 		{
 			return iterator(node_find);
 		}
@@ -298,10 +555,10 @@ namespace ares::core {
 		return end();
 	}
 
-	template <typename key, typename value, typename allocator>
-	inline typename avl_tree<key, value, allocator>::const_iterator avl_tree<key, value, allocator>::find(const key_type& key) const
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline typename avl_tree<key, value, allocator, order_statistics>::const_iterator avl_tree<key, value, allocator, order_statistics>::find(const key_type& key_arg) const
 	{
-		if (node* node_find = find_node_internal(root_, key))
+		if (node* node_find = find_node_internal(root_, key_arg))
 		{
 			return const_iterator(node_find);
 		}
@@ -309,55 +566,645 @@ namespace ares::core {
 		return cend();
 	}
 
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	template <bool enabled, typename>
+	inline typename avl_tree<key, value, allocator, order_statistics>::size_type avl_tree<key, value, allocator, order_statistics>::rank(const key_type& key_arg) const
+	{
+		size_type result = 0;
+		node* current = root_;
+		while (current)
+		{
+			if (compare_(key_of(current->data), key_arg))
+			{
+				result += subtree_size(current->left) + 1;
+				current = current->right;
+			}
+			else
+			{
+				current = current->left;
+			}
+		}
+		return result;
+	}
+
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	template <bool enabled, typename>
+	inline typename avl_tree<key, value, allocator, order_statistics>::size_type avl_tree<key, value, allocator, order_statistics>::count_range(const key_type& low, const key_type& high) const
+	{
+		if (!compare_(low, high))
+		{
+			return 0;
+		}
+		return rank(high) - rank(low);
+	}
+
 	//
 	// PRIVATE METHODS
 	//
-	template <typename key, typename value, typename allocator>
-	template <typename>
-	inline typename avl_tree<key, value, allocator>::node* avl_tree<key, value, allocator>::allocate_node()
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	template <bool enabled, typename>
+	inline typename avl_tree<key, value, allocator, order_statistics>::node* avl_tree<key, value, allocator, order_statistics>::allocate_node()
 	{
 		void* mem = allocator_.allocate(sizeof(node), alignof(node));
 		if (!mem) return nullptr;
 		node* result = new (mem) node();
-		result->parent_tree = static_cast<void*>(this);
+		result->parent_tree = tag_;
 		return result;
 	}
 
-	template <typename key, typename value, typename allocator>
-	template <typename>
-	inline typename avl_tree<key, value, allocator>::node* avl_tree<key, value, allocator>::allocate_node(const value_type& key_value)
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	template <bool enabled, typename>
+	inline typename avl_tree<key, value, allocator, order_statistics>::node* avl_tree<key, value, allocator, order_statistics>::allocate_node(const value_type& key_value)
 	{
 		void* mem = allocator_.allocate(sizeof(node), alignof(node));
 		if (!mem) return nullptr;
 		node* result = new (mem) node(key_value);
-		result->parent_tree = static_cast<void*>(this);
+		result->parent_tree = tag_;
 		return result;
 	}
 
-	template <typename key, typename value, typename allocator>
-	template <typename>
-	inline typename avl_tree<key, value, allocator>::node* avl_tree<key, value, allocator>::allocate_node(value_type&& key_value)
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	template <bool enabled, typename>
+	inline typename avl_tree<key, value, allocator, order_statistics>::node* avl_tree<key, value, allocator, order_statistics>::allocate_node(value_type&& key_value)
 	{
 		void* mem = allocator_.allocate(sizeof(node), alignof(node));
 		if (!mem) return nullptr;
 		node* result = new (mem) node(eastl::move(key_value));
-		result->parent_tree = static_cast<void*>(this);
+		result->parent_tree = tag_;
 		return result;
 	}
 
-	template <typename key, typename value, typename allocator>
-	template <typename>
-	inline void avl_tree<key, value, allocator>::deallocate_node(node* node_arg)
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	template <bool enabled, typename>
+	inline void avl_tree<key, value, allocator, order_statistics>::deallocate_node(node* node_arg)
 	{
 		if (node_arg)
 		{
+			if (node_arg->batch_slot == 0)
+			{
+				node_arg->~node();
+				allocator_.deallocate(node_arg, sizeof(node), alignof(node));
+				return;
+			}
+
+			node_batch* batch = batch_of(node_arg);
 			node_arg->~node();
-			allocator_.deallocate(node_arg, sizeof(node));
+			if (--batch->live == 0)
+			{
+				allocator_.deallocate(batch, batch_offset + batch->count * sizeof(node), batch_alignment);
+			}
+		}
+	}
+
+	// Builds the subtree of the next count unique keys at it, in order, so batch
+	// nodes end up in key order in memory. On failure, frees what it built.
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	template <typename forward_iterator>
+	inline typename avl_tree<key, value, allocator, order_statistics>::node* avl_tree<key, value, allocator, order_statistics>::build_sorted(forward_iterator& it, forward_iterator last, size_type count, node_batch* batch, bool& failed)
+	{
+		node* left = count > 1 ? build_sorted(it, last, count / 2, batch, failed) : nullptr;
+		if (failed)
+		{
+			return nullptr;
+		}
+
+		node* current = nullptr;
+		if (batch)
+		{
+			current = new (batch_nodes(batch) + size_) node(*it);
+			current->batch_slot = static_cast<uint32_t>(size_ + 1);
+			current->parent_tree = tag_;
+			batch->live++;
+		}
+		else
+		{
+			current = allocate_node(*it);
+		}
+
+		if (!current)
+		{
+			destroy_node(left);
+			failed = true;
+			return nullptr;
+		}
+		size_++;
+
+		do
+		{
+			++it;
+		}
+		while (it != last && !compare_(key_of(current->data), key_of(*it)));
+
+		current->left = left;
+		if (left)
+		{
+			left->parent = current;
+		}
+
+		size_type right_count = count - count / 2 - 1;
+		node* right = right_count ? build_sorted(it, last, right_count, batch, failed) : nullptr;
+		if (failed)
+		{
+			destroy_node(current);
+			return nullptr;
+		}
+
+		current->right = right;
+		if (right)
+		{
+			right->parent = current;
+		}
+		update_height(current);
+		return current;
+	}
+
+	// Takes other's nodes, leaving it empty; returns its old root. Only the
+	// smaller side is retagged: when other is larger, its tag comes over with it.
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline typename avl_tree<key, value, allocator, order_statistics>::node* avl_tree<key, value, allocator, order_statistics>::adopt(avl_tree& other)
+	{
+		if constexpr (!is_allocator_void)
+		{
+			assert(allocator_ == other.allocator_ && "Trees must share an allocator!");
+		}
+
+		node* retag = other.root_;
+		if (other.size_ > size_)
+		{
+			eastl::swap(tag_, other.tag_);
+			retag = root_;
+		}
+
+		for (node* current = minimum(retag); current; current = next_node(current))
+		{
+			current->parent_tree = tag_;
+		}
+
+		other.size_ = 0;
+		return eastl::exchange(other.root_, nullptr);
+	}
+
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline void avl_tree<key, value, allocator, order_statistics>::detach_children(node* node_arg, node*& left, node*& right) noexcept
+	{
+		left = eastl::exchange(node_arg->left, nullptr);
+		right = eastl::exchange(node_arg->right, nullptr);
+		if (left)
+		{
+			left->parent = nullptr;
+		}
+		if (right)
+		{
+			right->parent = nullptr;
+		}
+	}
+
+	// Rebalances from node_arg up to the top of its subtree; returns the new top.
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline typename avl_tree<key, value, allocator, order_statistics>::node* avl_tree<key, value, allocator, order_statistics>::rebalance_to_root(node* node_arg) noexcept
+	{
+		node* top = node_arg;
+		while (node_arg)
+		{
+			node* parent = node_arg->parent;
+			node* balanced_root = balance(node_arg);
+			if (parent)
+			{
+				if (parent->left == node_arg)
+				{
+					parent->left = balanced_root;
+				}
+				else
+				{
+					parent->right = balanced_root;
+				}
+			}
+			top = balanced_root;
+			node_arg = parent;
+		}
+		return top;
+	}
+
+	// Joins two trees and a middle node with left < middle < right. Walks down
+	// the taller tree to the height of the other, so it costs O(|height difference|).
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline typename avl_tree<key, value, allocator, order_statistics>::node* avl_tree<key, value, allocator, order_statistics>::join(node* left, node* middle, node* right) noexcept
+	{
+		if (height(left) > height(right) + 1)
+		{
+			return join_right(left, middle, right);
+		}
+
+		if (height(right) > height(left) + 1)
+		{
+			return join_left(left, middle, right);
+		}
+
+		middle->left = left;
+		middle->right = right;
+		middle->parent = nullptr;
+		if (left)
+		{
+			left->parent = middle;
+		}
+		if (right)
+		{
+			right->parent = middle;
+		}
+		update_height(middle);
+		return middle;
+	}
+
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline typename avl_tree<key, value, allocator, order_statistics>::node* avl_tree<key, value, allocator, order_statistics>::join_right(node* left, node* middle, node* right) noexcept
+	{
+		node* parent = nullptr;
+		node* current = left;
+		while (height(current) > height(right) + 1)
+		{
+			parent = current;
+			current = current->right;
+		}
+
+		middle->left = current;
+		middle->right = right;
+		if (current)
+		{
+			current->parent = middle;
+		}
+		if (right)
+		{
+			right->parent = middle;
+		}
+		update_height(middle);
+
+		middle->parent = parent;
+		parent->right = middle;
+		return rebalance_to_root(parent);
+	}
+
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline typename avl_tree<key, value, allocator, order_statistics>::node* avl_tree<key, value, allocator, order_statistics>::join_left(node* left, node* middle, node* right) noexcept
+	{
+		node* parent = nullptr;
+		node* current = right;
+		while (height(current) > height(left) + 1)
+		{
+			parent = current;
+			current = current->left;
+		}
+
+		middle->left = left;
+		middle->right = current;
+		if (left)
+		{
+			left->parent = middle;
+		}
+		if (current)
+		{
+			current->parent = middle;
+		}
+		update_height(middle);
+
+		middle->parent = parent;
+		parent->left = middle;
+		return rebalance_to_root(parent);
+	}
+
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline typename avl_tree<key, value, allocator, order_statistics>::node* avl_tree<key, value, allocator, order_statistics>::join2(node* left, node* right) noexcept
+	{
+		if (!left) return right;
+		if (!right) return left;
+
+		node* middle = extract_maximum(left);
+		return join(left, middle, right);
+	}
+
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline typename avl_tree<key, value, allocator, order_statistics>::node* avl_tree<key, value, allocator, order_statistics>::extract_maximum(node*& root) noexcept
+	{
+		node* result = maximum(root);
+		node* parent = result->parent;
+		node* child = result->left;
+		if (child)
+		{
+			child->parent = parent;
+		}
+
+		if (parent)
+		{
+			parent->right = child;
+			root = rebalance_to_root(parent);
+		}
+		else
+		{
+			root = child;
+		}
+
+		result->left = nullptr;
+		result->parent = nullptr;
+		return result;
+	}
+
+	// Splits root into the keys below and above key_arg; returns the node holding
+	// key_arg, detached, or nullptr. O(log n).
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline typename avl_tree<key, value, allocator, order_statistics>::node* avl_tree<key, value, allocator, order_statistics>::split(node* root, const key_type& key_arg, node*& left, node*& right) noexcept
+	{
+		if (!root)
+		{
+			left = nullptr;
+			right = nullptr;
+			return nullptr;
+		}
+
+		node* root_left = nullptr;
+		node* root_right = nullptr;
+		detach_children(root, root_left, root_right);
+
+		const key_type& root_key = key_of(root->data);
+		if (compare_(key_arg, root_key))
+		{
+			node* found = split(root_left, key_arg, left, right);
+			right = join(right, root, root_right);
+			return found;
+		}
+
+		if (compare_(root_key, key_arg))
+		{
+			node* found = split(root_right, key_arg, left, right);
+			left = join(root_left, root, left);
+			return found;
 		}
+
+		left = root_left;
+		right = root_right;
+		update_height(root);
+		return root;
+	}
+
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline typename avl_tree<key, value, allocator, order_statistics>::node* avl_tree<key, value, allocator, order_statistics>::unite_internal(node* tree_a, node* tree_b, uint32_t depth, discarded_nodes& discarded)
+	{
+		if (!tree_a) return tree_b;
+		if (!tree_b) return tree_a;
+
+		bool parallel = depth > 0 && eastl::max(tree_a->height, tree_b->height) >= parallel_min_height;
+
+		node* left_b = nullptr;
+		node* right_b = nullptr;
+		discard(discarded, split(tree_b, key_of(tree_a->data), left_b, right_b));
+
+		node* left_a = nullptr;
+		node* right_a = nullptr;
+		detach_children(tree_a, left_a, right_a);
+
+		node* left = nullptr;
+		node* right = nullptr;
+		discarded_nodes right_discarded;
+		fork(parallel,
+			[&]() { left = unite_internal(left_a, left_b, depth - parallel, discarded); },
+			[&]() { right = unite_internal(right_a, right_b, depth - parallel, right_discarded); });
+		splice(discarded, right_discarded);
+
+		return join(left, tree_a, right);
+	}
+
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline typename avl_tree<key, value, allocator, order_statistics>::node* avl_tree<key, value, allocator, order_statistics>::intersect_internal(node* tree_a, node* tree_b, uint32_t depth, discarded_nodes& discarded)
+	{
+		if (!tree_a || !tree_b)
+		{
+			discard(discarded, tree_a);
+			discard(discarded, tree_b);
+			return nullptr;
+		}
+
+		bool parallel = depth > 0 && eastl::max(tree_a->height, tree_b->height) >= parallel_min_height;
+
+		node* left_b = nullptr;
+		node* right_b = nullptr;
+		node* found = split(tree_b, key_of(tree_a->data), left_b, right_b);
+
+		node* left_a = nullptr;
+		node* right_a = nullptr;
+		detach_children(tree_a, left_a, right_a);
+
+		node* left = nullptr;
+		node* right = nullptr;
+		discarded_nodes right_discarded;
+		fork(parallel,
+			[&]() { left = intersect_internal(left_a, left_b, depth - parallel, discarded); },
+			[&]() { right = intersect_internal(right_a, right_b, depth - parallel, right_discarded); });
+		splice(discarded, right_discarded);
+
+		if (found)
+		{
+			discard(discarded, found);
+			return join(left, tree_a, right);
+		}
+
+		discard(discarded, tree_a);
+		return join2(left, right);
 	}
 
-	template <typename key, typename value, typename allocator>
-	inline typename avl_tree<key, value, allocator>::node* avl_tree<key, value, allocator>::rotate_left(node* node_arg) noexcept
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline typename avl_tree<key, value, allocator, order_statistics>::node* avl_tree<key, value, allocator, order_statistics>::subtract_internal(node* tree_a, node* tree_b, uint32_t depth, discarded_nodes& discarded)
+	{
+		if (!tree_a || !tree_b)
+		{
+			discard(discarded, tree_b);
+			return tree_a;
+		}
+
+		bool parallel = depth > 0 && eastl::max(tree_a->height, tree_b->height) >= parallel_min_height;
+
+		node* left_b = nullptr;
+		node* right_b = nullptr;
+		node* found = split(tree_b, key_of(tree_a->data), left_b, right_b);
+
+		node* left_a = nullptr;
+		node* right_a = nullptr;
+		detach_children(tree_a, left_a, right_a);
+
+		node* left = nullptr;
+		node* right = nullptr;
+		discarded_nodes right_discarded;
+		fork(parallel,
+			[&]() { left = subtract_internal(left_a, left_b, depth - parallel, discarded); },
+			[&]() { right = subtract_internal(right_a, right_b, depth - parallel, right_discarded); });
+		splice(discarded, right_discarded);
+
+		if (found)
+		{
+			discard(discarded, found);
+			discard(discarded, tree_a);
+			return join2(left, right);
+		}
+
+		return join(left, tree_a, right);
+	}
+
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	template <typename random_iterator>
+	inline typename avl_tree<key, value, allocator, order_statistics>::node* avl_tree<key, value, allocator, order_statistics>::erase_sorted_internal(node* root, random_iterator first, random_iterator last, uint32_t depth, discarded_nodes& discarded)
+	{
+		if (!root || first == last) return root;
+
+		bool parallel = depth > 0 && root->height >= parallel_min_height && last - first > 1;
+		random_iterator middle = first + (last - first) / 2;
+
+		node* left_root = nullptr;
+		node* right_root = nullptr;
+		discard(discarded, split(root, *middle, left_root, right_root));
+
+		node* left = nullptr;
+		node* right = nullptr;
+		discarded_nodes right_discarded;
+		fork(parallel,
+			[&]() { left = erase_sorted_internal(left_root, first, middle, depth - parallel, discarded); },
+			[&]() { right = erase_sorted_internal(right_root, middle + 1, last, depth - parallel, right_discarded); });
+		splice(discarded, right_discarded);
+
+		return join2(left, right);
+	}
+
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline void avl_tree<key, value, allocator, order_statistics>::discard(discarded_nodes& discarded, node* subtree) noexcept
+	{
+		if (!subtree) return;
+
+		subtree->parent = nullptr;
+		if (discarded.tail)
+		{
+			discarded.tail->parent = subtree;
+		}
+		else
+		{
+			discarded.head = subtree;
+		}
+		discarded.tail = subtree;
+	}
+
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline void avl_tree<key, value, allocator, order_statistics>::splice(discarded_nodes& discarded, discarded_nodes& other) noexcept
+	{
+		if (!other.head) return;
+
+		if (discarded.tail)
+		{
+			discarded.tail->parent = other.head;
+		}
+		else
+		{
+			discarded.head = other.head;
+		}
+		discarded.tail = other.tail;
+	}
+
+	// Frees every discarded subtree, or unlinks it in intrusive trees; returns the
+	// node count.
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline typename avl_tree<key, value, allocator, order_statistics>::size_type avl_tree<key, value, allocator, order_statistics>::release_discarded(discarded_nodes& discarded)
+	{
+		size_type count = 0;
+		node* subtree = discarded.head;
+		while (subtree)
+		{
+			node* next = eastl::exchange(subtree->parent, nullptr);
+			node* current = subtree;
+			while (current)
+			{
+				if (current->left)
+				{
+					current = current->left;
+				}
+				else if (current->right)
+				{
+					current = current->right;
+				}
+				else
+				{
+					node* parent = current->parent;
+					if (parent)
+					{
+						if (parent->left == current)
+						{
+							parent->left = nullptr;
+						}
+						else
+						{
+							parent->right = nullptr;
+						}
+					}
+
+					current->parent = nullptr;
+					update_height(current);
+					if constexpr (!is_allocator_void)
+					{
+						deallocate_node(current);
+					}
+					else
+					{
+						current->parent_tree = nullptr;
+					}
+
+					count++;
+					current = parent;
+				}
+			}
+			subtree = next;
+		}
+
+		discarded = {};
+		return count;
+	}
+
+	// Levels of the recursion that fork, enough to give every hardware thread a
+	// subtree.
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline uint32_t avl_tree<key, value, allocator, order_statistics>::parallel_depth() noexcept
+	{
+		uint32_t depth = 0;
+		for (uint32_t threads = std::thread::hardware_concurrency(); threads > 1; threads >>= 1)
+		{
+			depth++;
+		}
+		return depth;
+	}
+
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	template <typename left_task, typename right_task>
+	inline void avl_tree<key, value, allocator, order_statistics>::fork(bool parallel, left_task&& left, right_task&& right)
+	{
+		std::thread worker;
+		if (parallel)
+		{
+			try
+			{
+				worker = std::thread(left);
+			}
+			catch (const std::system_error&)
+			{
+				parallel = false;
+			}
+		}
+
+		if (!parallel)
+		{
+			left();
+		}
+		right();
+
+		if (worker.joinable())
+		{
+			worker.join();
+		}
+	}
+
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline typename avl_tree<key, value, allocator, order_statistics>::node* avl_tree<key, value, allocator, order_statistics>::rotate_left(node* node_arg) noexcept
 	{
 		node* r = node_arg->right;
 		node_arg->right = r->left;
@@ -376,8 +1223,8 @@ namespace ares::core {
 		return r;
 	}
 
-	template <typename key, typename value, typename allocator>
-	inline typename avl_tree<key, value, allocator>::node* avl_tree<key, value, allocator>::rotate_right(node* node_arg) noexcept
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline typename avl_tree<key, value, allocator, order_statistics>::node* avl_tree<key, value, allocator, order_statistics>::rotate_right(node* node_arg) noexcept
 	{
 		node* l = node_arg->left;
 		node_arg->left = l->right;
@@ -397,8 +1244,8 @@ namespace ares::core {
 		return l;
 	}
 
-	template <typename key, typename value, typename allocator>
-	inline typename avl_tree<key, value, allocator>::node* avl_tree<key, value, allocator>::balance(node* node_arg) noexcept
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline typename avl_tree<key, value, allocator, order_statistics>::node* avl_tree<key, value, allocator, order_statistics>::balance(node* node_arg) noexcept
 	{
 		if (!node_arg) return nullptr;
 
@@ -435,8 +1282,8 @@ namespace ares::core {
 		return new_root;
 	}
 
-	template <typename key, typename value, typename allocator>
-	inline typename avl_tree<key, value, allocator>::node* avl_tree<key, value, allocator>::insert_internal(node*& root, node* node_arg, bool& inserted) noexcept
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline typename avl_tree<key, value, allocator, order_statistics>::node* avl_tree<key, value, allocator, order_statistics>::insert_internal(node*& root, node* node_arg, bool& inserted) noexcept
 	{
 		if (!root)
 		{
@@ -544,10 +1391,10 @@ namespace ares::core {
 		return node_arg;
 	}
 
-	template <typename key, typename value, typename allocator>
-	inline bool avl_tree<key, value, allocator>::delete_internal(node*& root, const key_type& key)
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline bool avl_tree<key, value, allocator, order_statistics>::delete_internal(node*& root, const key_type& key_arg)
 	{
-		if (node* to_delete = find_node_internal(root, key))
+		if (node* to_delete = find_node_internal(root, key_arg))
 		{
 			return delete_node_internal(root, to_delete);
 		}
@@ -557,18 +1404,20 @@ namespace ares::core {
 		}
 	}
 
-	template <typename key, typename value, typename allocator>
-	inline bool avl_tree<key, value, allocator>::delete_node_internal(node*& root, node* node_arg)
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline bool avl_tree<key, value, allocator, order_statistics>::delete_node_internal(node*& root, node* node_arg)
 	{
 		if (!node_arg) return false;
 
 		node* to_delete = node_arg;
+		node* rebalance_from = node_arg->parent;
 
 		if (node_arg->left && node_arg->right)
 		{
 			node* successor = minimum(node_arg->right);
 
 			to_delete = successor;
+			rebalance_from = successor->parent == node_arg ? successor : successor->parent;
 
 			node* child = to_delete->right;
 			if (child)
@@ -641,33 +1490,45 @@ namespace ares::core {
 			}
 		}
 
-		node* current = to_delete->parent;
+		node* current = rebalance_from;
 		while (current)
 		{
+			node* parent = current->parent;
 			node* balanced_root = balance(current);
-			if (!balanced_root->parent)
+			if (!parent)
 			{
 				root = balanced_root;
 			}
-			current = balanced_root->parent;
+			else if (parent->left == current)
+			{
+				parent->left = balanced_root;
+			}
+			else
+			{
+				parent->right = balanced_root;
+			}
+			current = parent;
 		}
 
+		size_--;
+
 		if constexpr (!is_allocator_void)
 		{
 			deallocate_node(node_arg);
 		}
-
-		node_arg->left = nullptr;
-		node_arg->right = nullptr;
-		node_arg->parent = nullptr;
-		node_arg->height = 0;
-		node_arg->parent_tree = nullptr;
-		size_--;
+		else
+		{
+			node_arg->left = nullptr;
+			node_arg->right = nullptr;
+			node_arg->parent = nullptr;
+			update_height(node_arg);
+			node_arg->parent_tree = nullptr;
+		}
 		return true;
 	}
 
-	template <typename key, typename value, typename allocator>
-	inline void avl_tree<key, value, allocator>::destroy_node(node* node_arg)
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline void avl_tree<key, value, allocator, order_statistics>::destroy_node(node* node_arg)
 	{
 		if (!node_arg) return;
 
@@ -692,7 +1553,7 @@ namespace ares::core {
 				to_delete->left = nullptr;
 				to_delete->right = nullptr;
 				to_delete->parent = nullptr;
-				to_delete->height = 0;
+				update_height(to_delete);
 
 				if constexpr (!is_allocator_void)
 				{
@@ -732,8 +1593,8 @@ namespace ares::core {
 		}
 	}
 
-	template <typename key, typename value, typename allocator>
-	inline void avl_tree<key, value, allocator>::swap_nodes(node* node_a, node* node_b)
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline void avl_tree<key, value, allocator, order_statistics>::swap_nodes(node* node_a, node* node_b)
 	{
 		if (node_a == node_b || !node_a || !node_b) return;
 
@@ -813,10 +1674,15 @@ namespace ares::core {
 
 		node_a->height = b_height;
 		node_b->height = a_height;
+
+		if constexpr (order_statistics)
+		{
+			eastl::swap(node_a->subtree_size, node_b->subtree_size);
+		}
 	}
 
-	template <typename key, typename value, typename allocator>
-	inline typename avl_tree<key, value, allocator>::node* avl_tree<key, value, allocator>::find_node_internal(node* root, const key_type& key) const
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline typename avl_tree<key, value, allocator, order_statistics>::node* avl_tree<key, value, allocator, order_statistics>::find_node_internal(node* root, const key_type& key_arg) const
 	{
 		while (root)
 		{
@@ -832,9 +1698,9 @@ namespace ares::core {
 				}
 			}();
 
-			if (key == current_key) return root;
+			if (key_arg == current_key) return root;
 
-			if (compare_(key, current_key))
+			if (compare_(key_arg, current_key))
 			{
 				root = root->left;
 			}
@@ -846,8 +1712,8 @@ namespace ares::core {
 		return nullptr;
 	}
 
-	template <typename key, typename value, typename allocator>
-	inline typename avl_tree<key, value, allocator>::node* avl_tree<key, value, allocator>::lower_bound_internal(const key_type& key) const
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline typename avl_tree<key, value, allocator, order_statistics>::node* avl_tree<key, value, allocator, order_statistics>::lower_bound_internal(const key_type& key_arg) const
 	{
 		node* current = root_;
 		node* result = nullptr;
@@ -866,12 +1732,12 @@ namespace ares::core {
 				}
 			}();
 
-			if (key == current_key)
+			if (key_arg == current_key)
 			{
 				return current;
 			}
 
-			if (compare_(key, current_key))
+			if (compare_(key_arg, current_key))
 			{
 				result = current;
 				current = current->left;
@@ -884,15 +1750,15 @@ namespace ares::core {
 		return result;
 	}
 
-	template <typename key, typename value, typename allocator>
-	inline typename avl_tree<key, value, allocator>::node* avl_tree<key, value, allocator>::upper_bound_internal(const key_type& key) const
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline typename avl_tree<key, value, allocator, order_statistics>::node* avl_tree<key, value, allocator, order_statistics>::upper_bound_internal(const key_type& key_arg) const
 	{
 		node* current = root_;
 		node* result = nullptr;
 
 		while (current)
 		{
-			const key_type& current_key = []() -> const key_type&
+			const key_type& current_key = [current]() -> const key_type&
 			{
 				if constexpr (eastl::is_void_v<value>)
 				{
@@ -904,7 +1770,7 @@ namespace ares::core {
 				}
 			}();
 
-			if (compare_(key, current_key))
+			if (compare_(key_arg, current_key))
 			{
 				result = current;
 				current = current->left;
@@ -917,24 +1783,48 @@ namespace ares::core {
 		return result;
 	}
 
-	template <typename key, typename value, typename allocator>
-	inline typename avl_tree<key, value, allocator>::node* avl_tree<key, value, allocator>::maximum(node* node_arg) const
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline typename avl_tree<key, value, allocator, order_statistics>::node* avl_tree<key, value, allocator, order_statistics>::nth_internal(size_type index) const
 	{
-		if (!node_arg) return nulltpr;
+		node* current = root_;
+		while (current)
+		{
+			size_type left_size = subtree_size(current->left);
+			if (index < left_size)
+			{
+				current = current->left;
+			}
+			else if (index == left_size)
+			{
+				return current;
+			}
+			else
+			{
+				index -= left_size + 1;
+				current = current->right;
+			}
+		}
+		return nullptr;
+	}
+
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline typename avl_tree<key, value, allocator, order_statistics>::node* avl_tree<key, value, allocator, order_statistics>::maximum(node* node_arg) const
+	{
+		if (!node_arg) return nullptr;
 		while (node_arg->right) node_arg = node_arg->right;
 		return node_arg;
 	}
 
-	template <typename key, typename value, typename allocator>
-	inline typename avl_tree<key, value, allocator>::node* avl_tree<key, value, allocator>::minimum(node* node_arg) const
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline typename avl_tree<key, value, allocator, order_statistics>::node* avl_tree<key, value, allocator, order_statistics>::minimum(node* node_arg) const
 	{
 		if (!node_arg) return nullptr;
 		while (node_arg->left) node_arg = node_arg->left;
 		return node_arg;
 	}
 
-	template <typename key, typename value, typename allocator>
-	inline typename avl_tree<key, value, allocator>::node* avl_tree<key, value, allocator>::prev_node(node* node_arg) const
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline typename avl_tree<key, value, allocator, order_statistics>::node* avl_tree<key, value, allocator, order_statistics>::prev_node(node* node_arg) const
 	{
 		if (!node_arg) return nullptr;
 
@@ -950,8 +1840,8 @@ namespace ares::core {
 		return parent;
 	}
 
-	template <typename key, typename value, typename allocator>
-	inline typename avl_tree<key, value, allocator>::node* avl_tree<key, value, allocator>::next_node(node* node_arg) const
+	template <typename key, typename value, typename allocator, bool order_statistics>
+	inline typename avl_tree<key, value, allocator, order_statistics>::node* avl_tree<key, value, allocator, order_statistics>::next_node(node* node_arg) const
 	{
 		if (!node_arg) return nullptr;
 
@@ -961,7 +1851,7 @@ namespace ares::core {
 		while (parent && node_arg == parent->right)
 		{
 			node_arg = parent;
-			parent = parent->parent
+			parent = parent->parent;
 		}
 
 		return parent;
@@ -9,15 +9,15 @@ namespace ares::core {
 	class avl_tree_iterator
 	{
 	private:
-		template <typename T>
+		template <typename T, typename = void>
 		struct avl_tree_iterator_traits_helper
 		{
 			using pointer = T*;
 			using reference = T&;
 		};
 
-		template <>
-		struct avl_tree_iterator_traits_helper<void>
+		template <typename dummy>
+		struct avl_tree_iterator_traits_helper<void, dummy>
 		{
 			using pointer = void;
 			using reference = void;
@@ -0,0 +1,870 @@
+#ifndef ARES_CORE_BTREE_H
+#define ARES_CORE_BTREE_H
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include <EASTL/functional.h>
+#include <EASTL/utility.h>
+#include "core/btree_iterator.h"
+#include "core/default_allocator.h"
+#include "core/internal/alignment.h"
+#include "core/platform.h"
+#include "core/sys_allocator.h"
+#include "core/type_traits.h"
+
+namespace ares::core {
+
+	namespace internal {
+
+		// Four cache lines, or enough lines for 16 elements when they are large.
+		template <typename key, typename value>
+		constexpr size_t btree_node_size() noexcept
+		{
+			using element_type = eastl::conditional_t<eastl::is_void_v<value>, key, eastl::pair<const key, value>>;
+			constexpr size_t wanted = 16 * sizeof(element_type) + 32;
+			return wanted > 4 * ARES_CACHE_LINE_SIZE ? align_up(wanted, ARES_CACHE_LINE_SIZE) : 4 * ARES_CACHE_LINE_SIZE;
+		}
+
+	}
+
+	// B+-tree with the avl_tree interface. Elements live in leaves of node_size
+	// bytes, linked in key order, and inner nodes hold only separator keys, so a
+	// lookup costs one node per level instead of one per key. Unlike avl_tree,
+	// insert and erase move elements between slots, which invalidates iterators
+	// and references into the tree.
+	template <typename key, typename value = void, typename allocator = default_allocator, size_t node_size = internal::btree_node_size<key, value>()>
+	class btree
+	{
+	private:
+		static_assert(is_ares_allocator_v<allocator>, "Invalid allocator type!");
+		static_assert(node_size >= 64 && node_size % ARES_CACHE_LINE_SIZE == 0, "Nodes must be whole cache lines!");
+		struct leaf_node;
+	public:
+		using key_type = key;
+		using key_compare = eastl::less<key>;
+		using mapped_type = value;
+		using value_type = eastl::conditional_t<eastl::is_void_v<value>, key, eastl::pair<const key, value>>;
+		using allocator_type = sys_allocator<allocator>;
+		using size_type = std::size_t;
+		using difference_type = std::ptrdiff_t;
+
+		using reference = value_type&;
+		using const_reference = const value_type&;
+		using pointer = value_type*;
+		using const_pointer = const value_type*;
+
+		using iterator = btree_iterator<leaf_node, value_type>;
+		using const_iterator = btree_iterator<const leaf_node, const value_type>;
+		using reverse_iterator = eastl::reverse_iterator<iterator>;
+		using const_reverse_iterator = eastl::reverse_iterator<const_iterator>;
+
+		using pair_type = eastl::pair<iterator, bool>;
+		using iterator_pair_type = eastl::pair<iterator, iterator>;
+		using const_iterator_pair_type = eastl::pair<const_iterator, const_iterator>;
+
+		btree() {}
+		btree(allocator_type& alloc) : allocator_(alloc) {}
+		~btree() { clear(); }
+		btree(const btree&) = delete;
+		btree& operator=(const btree&) = delete;
+
+		btree(btree&& other) noexcept;
+		btree& operator=(btree&& other) noexcept;
+
+		// STL/EASTL methods
+		// Iterators
+		iterator begin() noexcept { return iterator(head_, 0); }
+		iterator end() noexcept { return iterator(tail_, tail_ ? tail_->count : 0); }
+		const_iterator begin() const noexcept { return const_iterator(head_, 0); }
+		const_iterator end() const noexcept { return const_iterator(tail_, tail_ ? tail_->count : 0); }
+		const_iterator cbegin() const noexcept { return begin(); }
+		const_iterator cend() const noexcept { return end(); }
+		reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+		reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+		const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+		const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+		const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(cend()); }
+		const_reverse_iterator crend() const noexcept { return const_reverse_iterator(cbegin()); }
+
+		// Capacity
+		size_type size() const noexcept { return size_; }
+		bool empty() const noexcept { return size_ == 0; }
+
+		// Modifiers
+		void clear();
+		pair_type insert(const value_type& key_value) { return insert_internal(key_value); }
+		pair_type insert(value_type&& key_value) { return insert_internal(eastl::move(key_value)); }
+		iterator erase(iterator pos);
+		iterator erase(iterator first, iterator last);
+		size_type erase(const key_type& key_arg) { return erase_internal(key_arg) ? 1 : 0; }
+
+		// Lookup
+		iterator find(const key_type& key_arg);
+		const_iterator find(const key_type& key_arg) const;
+		iterator_pair_type equal_range(const key_type& key_arg) { return { lower_bound(key_arg), upper_bound(key_arg) }; }
+		const_iterator_pair_type equal_range(const key_type& key_arg) const { return { lower_bound(key_arg), upper_bound(key_arg) }; }
+		iterator lower_bound(const key_type& key_arg) { return bound_internal<false>(key_arg); }
+		const_iterator lower_bound(const key_type& key_arg) const { return const_cast<btree*>(this)->template bound_internal<false>(key_arg); }
+		iterator upper_bound(const key_type& key_arg) { return bound_internal<true>(key_arg); }
+		const_iterator upper_bound(const key_type& key_arg) const { return const_cast<btree*>(this)->template bound_internal<true>(key_arg); }
+
+		// Other
+		allocator_type& get_allocator() const { return allocator_; }
+
+	private:
+		struct node_header
+		{
+			uint32_t count = 0;
+			bool leaf = true;
+		};
+
+		static constexpr size_type capacity_for(size_type space, size_type slot_size) noexcept { return space / slot_size > 4 ? space / slot_size : 4; }
+
+		static constexpr size_type leaf_capacity = capacity_for(node_size - sizeof(node_header) - 2 * sizeof(void*), sizeof(value_type));
+		static constexpr size_type inner_capacity = capacity_for(node_size - sizeof(node_header) - sizeof(void*), sizeof(key) + sizeof(void*));
+		static constexpr size_type leaf_minimum = leaf_capacity / 2;
+		static constexpr size_type inner_minimum = inner_capacity / 2;
+		// Inner nodes have at least three children, so 2^64 keys fit well within this.
+		static constexpr size_type max_height = 64;
+
+		struct leaf_node : node_header
+		{
+			leaf_node* prev = nullptr;
+			leaf_node* next = nullptr;
+			alignas(value_type) unsigned char storage[leaf_capacity * sizeof(value_type)];
+
+			value_type* slots() noexcept { return reinterpret_cast<value_type*>(storage); }
+			const value_type* slots() const noexcept { return reinterpret_cast<const value_type*>(storage); }
+		};
+
+		// children[i] holds the keys in [keys[i - 1], keys[i]).
+		struct inner_node : node_header
+		{
+			inner_node() { this->leaf = false; }
+
+			alignas(key) unsigned char storage[inner_capacity * sizeof(key)];
+			node_header* children[inner_capacity + 1];
+
+			key* keys() noexcept { return reinterpret_cast<key*>(storage); }
+			const key* keys() const noexcept { return reinterpret_cast<const key*>(storage); }
+		};
+
+		static constexpr size_type node_alignment = alignof(leaf_node) > ARES_CACHE_LINE_SIZE || alignof(inner_node) > ARES_CACHE_LINE_SIZE
+			? (alignof(leaf_node) > alignof(inner_node) ? alignof(leaf_node) : alignof(inner_node))
+			: ARES_CACHE_LINE_SIZE;
+
+		// The root-to-leaf route taken by insert and erase.
+		struct node_path
+		{
+			inner_node* nodes[max_height];
+			uint32_t positions[max_height];
+			size_type depth = 0;
+		};
+
+		template <typename data_type>
+		static const key_type& key_of(const data_type& data) noexcept
+		{
+			if constexpr (eastl::is_void_v<value> || eastl::is_same_v<data_type, key_type>)
+			{
+				return data;
+			}
+			else
+			{
+				return data.first;
+			}
+		}
+
+		template <bool upper, typename item_type> size_type search(const item_type* items, size_type count, const key_type& key_arg) const noexcept;
+		leaf_node* descend(const key_type& key_arg, node_path* path) const noexcept;
+		template <bool upper> iterator bound_internal(const key_type& key_arg) noexcept;
+		iterator make_iterator(leaf_node* leaf, size_type index) noexcept;
+
+		template <typename data_type> pair_type insert_internal(data_type&& key_value);
+		bool erase_internal(const key_type& key_arg);
+		void split_inner(inner_node* node_arg, inner_node* sibling, size_type position, key_type& separator, node_header*& child);
+		// Restore the minimum fill of the child at position; true when two children
+		// were merged and the parent lost a key.
+		bool fix_leaf(inner_node* parent, size_type position);
+		bool fix_inner(inner_node* parent, size_type position);
+		void merge_leaves(inner_node* parent, size_type index);
+		void merge_inner(inner_node* parent, size_type index);
+		void remove_separator(inner_node* parent, size_type index);
+		void destroy_subtree(node_header* node_arg);
+
+		leaf_node* allocate_leaf();
+		inner_node* allocate_inner();
+		void deallocate_leaf(leaf_node* leaf);
+		void deallocate_inner(inner_node* inner);
+
+		// Moves count items from src to dst, which may overlap, leaving src unconstructed.
+		template <typename T> static void relocate(T* dst, T* src, size_type count) noexcept;
+		template <typename T> static void relocate_one(T* dst, T* src) noexcept;
+
+	private:
+		node_header* root_ = nullptr;
+		leaf_node* head_ = nullptr;
+		leaf_node* tail_ = nullptr;
+		size_type size_ = 0;
+		key_compare compare_;
+		mutable allocator_type allocator_;
+	};
+
+	//
+	// Constructors
+	//
+	template <typename key, typename value, typename allocator, size_t node_size>
+	inline btree<key, value, allocator, node_size>::btree(btree&& other) noexcept
+		: root_(eastl::exchange(other.root_, nullptr)),
+		head_(eastl::exchange(other.head_, nullptr)),
+		tail_(eastl::exchange(other.tail_, nullptr)),
+		size_(eastl::exchange(other.size_, 0)),
+		compare_(eastl::move(other.compare_)),
+		allocator_(other.allocator_)
+	{
+	}
+
+	template <typename key, typename value, typename allocator, size_t node_size>
+	inline btree<key, value, allocator, node_size>& btree<key, value, allocator, node_size>::operator=(btree&& other) noexcept
+	{
+		if (this != &other)
+		{
+			clear();
+
+			root_ = eastl::exchange(other.root_, nullptr);
+			head_ = eastl::exchange(other.head_, nullptr);
+			tail_ = eastl::exchange(other.tail_, nullptr);
+			size_ = eastl::exchange(other.size_, 0);
+			compare_ = eastl::move(other.compare_);
+			allocator_ = other.allocator_;
+		}
+		return *this;
+	}
+
+	//
+	// STL/EASTL - MODIFIERS
+	//
+	template <typename key, typename value, typename allocator, size_t node_size>
+	inline void btree<key, value, allocator, node_size>::clear()
+	{
+		destroy_subtree(root_);
+		root_ = nullptr;
+		head_ = nullptr;
+		tail_ = nullptr;
+		size_ = 0;
+	}
+
+	template <typename key, typename value, typename allocator, size_t node_size>
+	inline typename btree<key, value, allocator, node_size>::iterator btree<key, value, allocator, node_size>::erase(iterator pos)
+	{
+		if (pos == end())
+		{
+			return end();
+		}
+
+		// Erasing can move the following elements to another leaf, so look the
+		// successor up again by key.
+		key_type key_erase = key_of(*pos);
+		erase_internal(key_erase);
+		return lower_bound(key_erase);
+	}
+
+	template <typename key, typename value, typename allocator, size_t node_size>
+	inline typename btree<key, value, allocator, node_size>::iterator btree<key, value, allocator, node_size>::erase(iterator first, iterator last)
+	{
+		if (first == begin() && last == end())
+		{
+			clear();
+			return end();
+		}
+
+		if (last == end())
+		{
+			while (first != end())
+			{
+				first = erase(first);
+			}
+			return end();
+		}
+
+		key_type key_last = key_of(*last);
+		while (first != end() && compare_(key_of(*first), key_last))
+		{
+			first = erase(first);
+		}
+		return first;
+	}
+
+	//
+	// STL/EASTL - LOOKUP
+	//
+	template <typename key, typename value, typename allocator, size_t node_size>
+	inline typename btree<key, value, allocator, node_size>::iterator btree<key, value, allocator, node_size>::find(const key_type& key_arg)
+	{
+		iterator result = lower_bound(key_arg);
+		if (result != end() && !compare_(key_arg, key_of(*result)))
+		{
+			return result;
+		}
+		return end();
+	}
+
+	template <typename key, typename value, typename allocator, size_t node_size>
+	inline typename btree<key, value, allocator, node_size>::const_iterator btree<key, value, allocator, node_size>::find(const key_type& key_arg) const
+	{
+		return const_cast<btree*>(this)->find(key_arg);
+	}
+
+	//
+	// PRIVATE METHODS
+	//
+	// Number of items below key_arg, or not above it when upper is set. Nodes are
+	// small, so arithmetic keys are counted without branches rather than bisected.
+	template <typename key, typename value, typename allocator, size_t node_size>
+	template <bool upper, typename item_type>
+	inline typename btree<key, value, allocator, node_size>::size_type btree<key, value, allocator, node_size>::search(const item_type* items, size_type count, const key_type& key_arg) const noexcept
+	{
+		if constexpr (eastl::is_arithmetic_v<key_type>)
+		{
+			size_type result = 0;
+			for (size_type i = 0; i < count; i++)
+			{
+				if constexpr (upper)
+				{
+					result += !compare_(key_arg, key_of(items[i]));
+				}
+				else
+				{
+					result += compare_(key_of(items[i]), key_arg);
+				}
+			}
+			return result;
+		}
+		else
+		{
+			size_type low = 0;
+			size_type high = count;
+			while (low < high)
+			{
+				size_type middle = (low + high) / 2;
+				bool right = upper ? !compare_(key_arg, key_of(items[middle])) : compare_(key_of(items[middle]), key_arg);
+				if (right)
+				{
+					low = middle + 1;
+				}
+				else
+				{
+					high = middle;
+				}
+			}
+			return low;
+		}
+	}
+
+	template <typename key, typename value, typename allocator, size_t node_size>
+	inline typename btree<key, value, allocator, node_size>::leaf_node* btree<key, value, allocator, node_size>::descend(const key_type& key_arg, node_path* path) const noexcept
+	{
+		node_header* current = root_;
+		while (current && !current->leaf)
+		{
+			inner_node* inner = static_cast<inner_node*>(current);
+			size_type position = search<true>(inner->keys(), inner->count, key_arg);
+			if (path)
+			{
+				assert(path->depth < max_height && "B-tree is too deep!");
+				path->nodes[path->depth] = inner;
+				path->positions[path->depth] = static_cast<uint32_t>(position);
+				path->depth++;
+			}
+			current = inner->children[position];
+		}
+		return static_cast<leaf_node*>(current);
+	}
+
+	// Separators can be stale after an erase, but every key right of a separator
+	// is still at least as large, so a bound past the end of the leaf reached is
+	// the first element of the next one.
+	template <typename key, typename value, typename allocator, size_t node_size>
+	template <bool upper>
+	inline typename btree<key, value, allocator, node_size>::iterator btree<key, value, allocator, node_size>::bound_internal(const key_type& key_arg) noexcept
+	{
+		leaf_node* leaf = descend(key_arg, nullptr);
+		if (!leaf)
+		{
+			return end();
+		}
+		return make_iterator(leaf, search<upper>(leaf->slots(), leaf->count, key_arg));
+	}
+
+	template <typename key, typename value, typename allocator, size_t node_size>
+	inline typename btree<key, value, allocator, node_size>::iterator btree<key, value, allocator, node_size>::make_iterator(leaf_node* leaf, size_type index) noexcept
+	{
+		if (index == leaf->count && leaf->next)
+		{
+			return iterator(leaf->next, 0);
+		}
+		return iterator(leaf, index);
+	}
+
+	template <typename key, typename value, typename allocator, size_t node_size>
+	template <typename data_type>
+	inline typename btree<key, value, allocator, node_size>::pair_type btree<key, value, allocator, node_size>::insert_internal(data_type&& key_value)
+	{
+		if (!root_)
+		{
+			leaf_node* leaf = allocate_leaf();
+			if (!leaf)
+			{
+				return { end(), false };
+			}
+			root_ = head_ = tail_ = leaf;
+		}
+
+		const key_type& key_insert = key_of(key_value);
+		node_path path;
+		leaf_node* leaf = descend(key_insert, &path);
+		size_type index = search<false>(leaf->slots(), leaf->count, key_insert);
+		if (index < leaf->count && !compare_(key_insert, key_of(leaf->slots()[index])))
+		{
+			return { iterator(leaf, index), false };
+		}
+
+		if (leaf->count < leaf_capacity)
+		{
+			relocate(leaf->slots() + index + 1, leaf->slots() + index, leaf->count - index);
+			new (leaf->slots() + index) value_type(eastl::forward<data_type>(key_value));
+			leaf->count++;
+			size_++;
+			return { iterator(leaf, index), true };
+		}
+
+		// Allocate every node the splits will need up front, so running out of
+		// memory leaves the tree as it was.
+		size_type full_inner = 0;
+		while (full_inner < path.depth && path.nodes[path.depth - 1 - full_inner]->count == inner_capacity)
+		{
+			full_inner++;
+		}
+		size_type inner_needed = full_inner + (full_inner == path.depth ? 1 : 0);
+
+		leaf_node* sibling = allocate_leaf();
+		inner_node* spare[max_height + 1] = {};
+		bool allocated = sibling != nullptr;
+		for (size_type i = 0; i < inner_needed && allocated; i++)
+		{
+			spare[i] = allocate_inner();
+			allocated = spare[i] != nullptr;
+		}
+
+		if (!allocated)
+		{
+			deallocate_leaf(sibling);
+			for (size_type i = 0; i < inner_needed; i++)
+			{
+				deallocate_inner(spare[i]);
+			}
+			return { end(), false };
+		}
+
+		// Appending to the last leaf keeps it full, so ascending loads pack leaves.
+		size_type left_count = index == leaf_capacity && !leaf->next ? leaf_capacity : (leaf_capacity + 1) / 2;
+		relocate(sibling->slots(), leaf->slots() + left_count, leaf_capacity - left_count);
+		sibling->count = static_cast<uint32_t>(leaf_capacity - left_count);
+		leaf->count = static_cast<uint32_t>(left_count);
+
+		sibling->prev = leaf;
+		sibling->next = leaf->next;
+		if (leaf->next)
+		{
+			leaf->next->prev = sibling;
+		}
+		else
+		{
+			tail_ = sibling;
+		}
+		leaf->next = sibling;
+
+		leaf_node* target = index < left_count ? leaf : sibling;
+		size_type target_index = index < left_count ? index : index - left_count;
+		relocate(target->slots() + target_index + 1, target->slots() + target_index, target->count - target_index);
+		new (target->slots() + target_index) value_type(eastl::forward<data_type>(key_value));
+		target->count++;
+		size_++;
+
+		key_type separator = key_of(sibling->slots()[0]);
+		node_header* child = sibling;
+		size_type spare_index = 0;
+		for (size_type level = path.depth; level-- > 0;)
+		{
+			inner_node* parent = path.nodes[level];
+			size_type position = path.positions[level];
+			if (parent->count < inner_capacity)
+			{
+				relocate(parent->keys() + position + 1, parent->keys() + position, parent->count - position);
+				memmove(parent->children + position + 2, parent->children + position + 1, (parent->count - position) * sizeof(node_header*));
+				new (parent->keys() + position) key_type(eastl::move(separator));
+				parent->children[position + 1] = child;
+				parent->count++;
+				return { iterator(target, target_index), true };
+			}
+
+			split_inner(parent, spare[spare_index++], position, separator, child);
+		}
+
+		inner_node* root = spare[spare_index];
+		new (root->keys()) key_type(eastl::move(separator));
+		root->children[0] = root_;
+		root->children[1] = child;
+		root->count = 1;
+		root_ = root;
+		return { iterator(target, target_index), true };
+	}
+
+	// Splits a full inner node while adding separator and child at position. On
+	// return, separator is the key to push up and child the new right node.
+	template <typename key, typename value, typename allocator, size_t node_size>
+	inline void btree<key, value, allocator, node_size>::split_inner(inner_node* node_arg, inner_node* sibling, size_type position, key_type& separator, node_header*& child)
+	{
+		const size_type count = inner_capacity;
+		const size_type middle = (count + 1) / 2;
+		key_type* keys = node_arg->keys();
+		node_header** children = node_arg->children;
+
+		if (position < middle)
+		{
+			relocate(sibling->keys(), keys + middle, count - middle);
+			memcpy(sibling->children, children + middle, (count - middle + 1) * sizeof(node_header*));
+			sibling->count = static_cast<uint32_t>(count - middle);
+
+			key_type promoted(eastl::move(keys[middle - 1]));
+			keys[middle - 1].~key_type();
+			relocate(keys + position + 1, keys + position, middle - 1 - position);
+			memmove(children + position + 2, children + position + 1, (middle - 1 - position) * sizeof(node_header*));
+			new (keys + position) key_type(eastl::move(separator));
+			children[position + 1] = child;
+			separator = eastl::move(promoted);
+		}
+		else if (position == middle)
+		{
+			relocate(sibling->keys(), keys + middle, count - middle);
+			sibling->children[0] = child;
+			memcpy(sibling->children + 1, children + middle + 1, (count - middle) * sizeof(node_header*));
+			sibling->count = static_cast<uint32_t>(count - middle);
+		}
+		else
+		{
+			size_type sibling_position = position - middle - 1;
+			relocate(sibling->keys(), keys + middle + 1, sibling_position);
+			new (sibling->keys() + sibling_position) key_type(eastl::move(separator));
+			relocate(sibling->keys() + sibling_position + 1, keys + position, count - position);
+			memcpy(sibling->children, children + middle + 1, (sibling_position + 1) * sizeof(node_header*));
+			sibling->children[sibling_position + 1] = child;
+			memcpy(sibling->children + sibling_position + 2, children + position + 1, (count - position) * sizeof(node_header*));
+			sibling->count = static_cast<uint32_t>(count - middle);
+
+			separator = eastl::move(keys[middle]);
+			keys[middle].~key_type();
+		}
+
+		node_arg->count = static_cast<uint32_t>(middle);
+		child = sibling;
+	}
+
+	template <typename key, typename value, typename allocator, size_t node_size>
+	inline bool btree<key, value, allocator, node_size>::erase_internal(const key_type& key_arg)
+	{
+		if (!root_)
+		{
+			return false;
+		}
+
+		node_path path;
+		leaf_node* leaf = descend(key_arg, &path);
+		size_type index = search<false>(leaf->slots(), leaf->count, key_arg);
+		if (index == leaf->count || compare_(key_arg, key_of(leaf->slots()[index])))
+		{
+			return false;
+		}
+
+		leaf->slots()[index].~value_type();
+		relocate(leaf->slots() + index, leaf->slots() + index + 1, leaf->count - index - 1);
+		leaf->count--;
+		size_--;
+
+		node_header* current = leaf;
+		for (size_type level = path.depth; level > 0; level--)
+		{
+			if (current->count >= (current->leaf ? leaf_minimum : inner_minimum))
+			{
+				return true;
+			}
+
+			inner_node* parent = path.nodes[level - 1];
+			size_type position = path.positions[level - 1];
+			bool merged = current->leaf ? fix_leaf(parent, position) : fix_inner(parent, position);
+			if (!merged)
+			{
+				return true;
+			}
+			current = parent;
+		}
+
+		if (current->count == 0)
+		{
+			if (current->leaf)
+			{
+				deallocate_leaf(static_cast<leaf_node*>(current));
+				root_ = nullptr;
+				head_ = nullptr;
+				tail_ = nullptr;
+			}
+			else
+			{
+				inner_node* root = static_cast<inner_node*>(current);
+				root_ = root->children[0];
+				deallocate_inner(root);
+			}
+		}
+		return true;
+	}
+
+	template <typename key, typename value, typename allocator, size_t node_size>
+	inline bool btree<key, value, allocator, node_size>::fix_leaf(inner_node* parent, size_type position)
+	{
+		leaf_node* node_fix = static_cast<leaf_node*>(parent->children[position]);
+
+		if (position > 0)
+		{
+			leaf_node* left = static_cast<leaf_node*>(parent->children[position - 1]);
+			if (left->count > leaf_minimum)
+			{
+				relocate(node_fix->slots() + 1, node_fix->slots(), node_fix->count);
+				relocate_one(node_fix->slots(), left->slots() + left->count - 1);
+				left->count--;
+				node_fix->count++;
+				parent->keys()[position - 1] = key_of(node_fix->slots()[0]);
+				return false;
+			}
+		}
+
+		if (position < parent->count)
+		{
+			leaf_node* right = static_cast<leaf_node*>(parent->children[position + 1]);
+			if (right->count > leaf_minimum)
+			{
+				relocate_one(node_fix->slots() + node_fix->count, right->slots());
+				relocate(right->slots(), right->slots() + 1, right->count - 1);
+				right->count--;
+				node_fix->count++;
+				parent->keys()[position] = key_of(right->slots()[0]);
+				return false;
+			}
+		}
+
+		merge_leaves(parent, position > 0 ? position - 1 : position);
+		return true;
+	}
+
+	template <typename key, typename value, typename allocator, size_t node_size>
+	inline bool btree<key, value, allocator, node_size>::fix_inner(inner_node* parent, size_type position)
+	{
+		inner_node* node_fix = static_cast<inner_node*>(parent->children[position]);
+
+		if (position > 0)
+		{
+			inner_node* left = static_cast<inner_node*>(parent->children[position - 1]);
+			if (left->count > inner_minimum)
+			{
+				relocate(node_fix->keys() + 1, node_fix->keys(), node_fix->count);
+				memmove(node_fix->children + 1, node_fix->children, (node_fix->count + 1) * sizeof(node_header*));
+				new (node_fix->keys()) key_type(eastl::move(parent->keys()[position - 1]));
+				node_fix->children[0] = left->children[left->count];
+				parent->keys()[position - 1] = eastl::move(left->keys()[left->count - 1]);
+				left->keys()[left->count - 1].~key_type();
+				left->count--;
+				node_fix->count++;
+				return false;
+			}
+		}
+
+		if (position < parent->count)
+		{
+			inner_node* right = static_cast<inner_node*>(parent->children[position + 1]);
+			if (right->count > inner_minimum)
+			{
+				new (node_fix->keys() + node_fix->count) key_type(eastl::move(parent->keys()[position]));
+				node_fix->children[node_fix->count + 1] = right->children[0];
+				parent->keys()[position] = eastl::move(right->keys()[0]);
+				right->keys()[0].~key_type();
+				relocate(right->keys(), right->keys() + 1, right->count - 1);
+				memmove(right->children, right->children + 1, right->count * sizeof(node_header*));
+				right->count--;
+				node_fix->count++;
+				return false;
+			}
+		}
+
+		merge_inner(parent, position > 0 ? position - 1 : position);
+		return true;
+	}
+
+	template <typename key, typename value, typename allocator, size_t node_size>
+	inline void btree<key, value, allocator, node_size>::merge_leaves(inner_node* parent, size_type index)
+	{
+		leaf_node* left = static_cast<leaf_node*>(parent->children[index]);
+		leaf_node* right = static_cast<leaf_node*>(parent->children[index + 1]);
+
+		relocate(left->slots() + left->count, right->slots(), right->count);
+		left->count += right->count;
+		right->count = 0;
+
+		left->next = right->next;
+		if (right->next)
+		{
+			right->next->prev = left;
+		}
+		else
+		{
+			tail_ = left;
+		}
+
+		deallocate_leaf(right);
+		remove_separator(parent, index);
+	}
+
+	template <typename key, typename value, typename allocator, size_t node_size>
+	inline void btree<key, value, allocator, node_size>::merge_inner(inner_node* parent, size_type index)
+	{
+		inner_node* left = static_cast<inner_node*>(parent->children[index]);
+		inner_node* right = static_cast<inner_node*>(parent->children[index + 1]);
+
+		new (left->keys() + left->count) key_type(eastl::move(parent->keys()[index]));
+		relocate(left->keys() + left->count + 1, right->keys(), right->count);
+		memcpy(left->children + left->count + 1, right->children, (right->count + 1) * sizeof(node_header*));
+		left->count += right->count + 1;
+		right->count = 0;
+
+		deallocate_inner(right);
+		remove_separator(parent, index);
+	}
+
+	// Drops keys[index] and the child to its right after a merge.
+	template <typename key, typename value, typename allocator, size_t node_size>
+	inline void btree<key, value, allocator, node_size>::remove_separator(inner_node* parent, size_type index)
+	{
+		parent->keys()[index].~key_type();
+		relocate(parent->keys() + index, parent->keys() + index + 1, parent->count - index - 1);
+		memmove(parent->children + index + 1, parent->children + index + 2, (parent->count - index - 1) * sizeof(node_header*));
+		parent->count--;
+	}
+
+	template <typename key, typename value, typename allocator, size_t node_size>
+	inline void btree<key, value, allocator, node_size>::destroy_subtree(node_header* node_arg)
+	{
+		if (!node_arg) return;
+
+		if (node_arg->leaf)
+		{
+			leaf_node* leaf = static_cast<leaf_node*>(node_arg);
+			for (size_type i = 0; i < leaf->count; i++)
+			{
+				leaf->slots()[i].~value_type();
+			}
+			leaf->count = 0;
+			deallocate_leaf(leaf);
+			return;
+		}
+
+		inner_node* inner = static_cast<inner_node*>(node_arg);
+		for (size_type i = 0; i <= inner->count; i++)
+		{
+			destroy_subtree(inner->children[i]);
+		}
+		for (size_type i = 0; i < inner->count; i++)
+		{
+			inner->keys()[i].~key_type();
+		}
+		inner->count = 0;
+		deallocate_inner(inner);
+	}
+
+	template <typename key, typename value, typename allocator, size_t node_size>
+	inline typename btree<key, value, allocator, node_size>::leaf_node* btree<key, value, allocator, node_size>::allocate_leaf()
+	{
+		void* mem = allocator_.allocate(sizeof(leaf_node), node_alignment);
+		if (!mem) return nullptr;
+		return new (mem) leaf_node;
+	}
+
+	template <typename key, typename value, typename allocator, size_t node_size>
+	inline typename btree<key, value, allocator, node_size>::inner_node* btree<key, value, allocator, node_size>::allocate_inner()
+	{
+		void* mem = allocator_.allocate(sizeof(inner_node), node_alignment);
+		if (!mem) return nullptr;
+		return new (mem) inner_node();
+	}
+
+	template <typename key, typename value, typename allocator, size_t node_size>
+	inline void btree<key, value, allocator, node_size>::deallocate_leaf(leaf_node* leaf)
+	{
+		if (leaf)
+		{
+			leaf->~leaf_node();
+			allocator_.deallocate(leaf, sizeof(leaf_node), node_alignment);
+		}
+	}
+
+	template <typename key, typename value, typename allocator, size_t node_size>
+	inline void btree<key, value, allocator, node_size>::deallocate_inner(inner_node* inner)
+	{
+		if (inner)
+		{
+			inner->~inner_node();
+			allocator_.deallocate(inner, sizeof(inner_node), node_alignment);
+		}
+	}
+
+	template <typename key, typename value, typename allocator, size_t node_size>
+	template <typename T>
+	inline void btree<key, value, allocator, node_size>::relocate(T* dst, T* src, size_type count) noexcept
+	{
+		if (count == 0 || dst == src) return;
+
+		if constexpr (eastl::is_trivially_copyable_v<key> && (eastl::is_void_v<value> || eastl::is_same_v<T, key> || eastl::is_trivially_copyable_v<value>))
+		{
+			memmove(static_cast<void*>(dst), static_cast<const void*>(src), count * sizeof(T));
+		}
+		else if (dst < src)
+		{
+			for (size_type i = 0; i < count; i++)
+			{
+				relocate_one(dst + i, src + i);
+			}
+		}
+		else
+		{
+			for (size_type i = count; i-- > 0;)
+			{
+				relocate_one(dst + i, src + i);
+			}
+		}
+	}
+
+	template <typename key, typename value, typename allocator, size_t node_size>
+	template <typename T>
+	inline void btree<key, value, allocator, node_size>::relocate_one(T* dst, T* src) noexcept
+	{
+		if constexpr (!eastl::is_void_v<value> && eastl::is_same_v<T, value_type>)
+		{
+			// The slot is destroyed right after, so its const key can be moved from.
+			new (dst) T(eastl::move(const_cast<key_type&>(src->first)), eastl::move(src->second));
+		}
+		else
+		{
+			new (dst) T(eastl::move(*src));
+		}
+		src->~T();
+	}
+
+}
+
+#endif // ARES_CORE_BTREE_H
\ No newline at end of file
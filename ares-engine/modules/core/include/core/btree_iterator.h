@@ -0,0 +1,129 @@
+#ifndef ARES_CORE_BTREE_ITERATOR_H
+#define ARES_CORE_BTREE_ITERATOR_H
+#include <EASTL/iterator.h>
+#include <EASTL/type_traits.h>
+
+namespace ares::core {
+
+	// Position in a btree leaf. Leaves are linked in key order, and end() sits one
+	// past the last element of the last leaf so it can be decremented.
+	template <typename leaf_node, typename value>
+	class btree_iterator
+	{
+	public:
+		using value_type = value;
+		using pointer = value*;
+		using reference = value&;
+		using iterator_category = eastl::bidirectional_iterator_tag;
+		using difference_type = std::ptrdiff_t;
+		using size_type = std::size_t;
+
+		btree_iterator() = default;
+		btree_iterator(leaf_node* leaf, size_type index);
+
+		template <typename other_leaf, typename other_value, typename = eastl::enable_if_t<
+			eastl::is_convertible_v<other_leaf*, leaf_node*>&&
+			eastl::is_convertible_v<other_value*, value*>
+		>>
+		btree_iterator(const btree_iterator<other_leaf, other_value>& other);
+
+		pointer operator->() const;
+		reference operator*() const;
+
+		btree_iterator& operator++();
+		btree_iterator operator++(int);
+		btree_iterator& operator--();
+		btree_iterator operator--(int);
+
+		bool operator==(const btree_iterator& other) const;
+		bool operator!=(const btree_iterator& other) const;
+
+		leaf_node* get_leaf() const { return leaf_; }
+		size_type get_index() const { return index_; }
+
+	private:
+		leaf_node* leaf_ = nullptr;
+		size_type index_ = 0;
+		template <typename, typename> friend class btree_iterator;
+	};
+
+	template <typename leaf_node, typename value>
+	inline btree_iterator<leaf_node, value>::btree_iterator(leaf_node* leaf, size_type index)
+		: leaf_(leaf),
+		index_(index)
+	{
+	}
+
+	template <typename leaf_node, typename value>
+	template <typename other_leaf, typename other_value, typename>
+	inline btree_iterator<leaf_node, value>::btree_iterator(const btree_iterator<other_leaf, other_value>& other)
+		: leaf_(other.leaf_),
+		index_(other.index_)
+	{
+	}
+
+	template <typename leaf_node, typename value>
+	inline typename btree_iterator<leaf_node, value>::pointer btree_iterator<leaf_node, value>::operator->() const
+	{
+		return leaf_->slots() + index_;
+	}
+
+	template <typename leaf_node, typename value>
+	inline typename btree_iterator<leaf_node, value>::reference btree_iterator<leaf_node, value>::operator*() const
+	{
+		return leaf_->slots()[index_];
+	}
+
+	template <typename leaf_node, typename value>
+	inline btree_iterator<leaf_node, value>& btree_iterator<leaf_node, value>::operator++()
+	{
+		if (++index_ == leaf_->count && leaf_->next)
+		{
+			leaf_ = leaf_->next;
+			index_ = 0;
+		}
+		return *this;
+	}
+
+	template <typename leaf_node, typename value>
+	inline btree_iterator<leaf_node, value> btree_iterator<leaf_node, value>::operator++(int)
+	{
+		btree_iterator temp = *this;
+		++(*this);
+		return temp;
+	}
+
+	template <typename leaf_node, typename value>
+	inline btree_iterator<leaf_node, value>& btree_iterator<leaf_node, value>::operator--()
+	{
+		if (index_ == 0)
+		{
+			leaf_ = leaf_->prev;
+			index_ = leaf_->count;
+		}
+		index_--;
+		return *this;
+	}
+
+	template <typename leaf_node, typename value>
+	inline btree_iterator<leaf_node, value> btree_iterator<leaf_node, value>::operator--(int)
+	{
+		btree_iterator temp = *this;
+		--(*this);
+		return temp;
+	}
+
+	template <typename leaf_node, typename value>
+	inline bool btree_iterator<leaf_node, value>::operator==(const btree_iterator& other) const
+	{
+		return leaf_ == other.leaf_ && index_ == other.index_;
+	}
+
+	template <typename leaf_node, typename value>
+	inline bool btree_iterator<leaf_node, value>::operator!=(const btree_iterator& other) const
+	{
+		return !(*this == other);
+	}
+}
+
+#endif // ARES_CORE_BTREE_ITERATOR_H
\ No newline at end of file
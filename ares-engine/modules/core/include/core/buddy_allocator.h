@@ -0,0 +1,112 @@
+#ifndef ARES_CORE_BUDDY_ALLOCATOR_H
+#define ARES_CORE_BUDDY_ALLOCATOR_H
+#include <stddef.h>
+#include <stdint.h>
+#include "core/core_api.h"
+#include "core/allocator.h"
+#include "core/internal/os_page_interface.h"
+
+namespace ares::core {
+
+	struct buddy_stats
+	{
+		static constexpr size_t order_count = 11;
+
+		size_t allocated_bytes = 0;     // block sizes of live allocations
+		size_t requested_bytes = 0;     // sizes asked for by live allocations
+		size_t free_bytes = 0;
+		size_t committed_bytes = 0;
+		size_t largest_free_block = 0;
+		size_t free_blocks[order_count] = {};   // free block count per order
+		// 1 - requested / allocated: space lost to rounding up to a power of two.
+		double internal_fragmentation = 0.0;
+		// 1 - largest free block / free bytes: how scattered the free space is.
+		double external_fragmentation = 0.0;
+	};
+
+	// Binary buddy allocator for power of two blocks from 64 KiB to 64 MiB.
+	// Block state lives in a separate table so free blocks don't have to stay
+	// committed: pages are committed when a block is handed out and decommitted
+	// when freeing merges it into a block of at least decommit_size. Blocks are
+	// aligned to their size. Not thread-safe.
+	class ARES_CORE_API buddy_allocator final : public allocator
+	{
+	public:
+		static constexpr size_t min_block_size = 64 * 1024;
+		static constexpr size_t max_block_size = 64ull * 1024 * 1024;
+		static constexpr uint32_t max_order = buddy_stats::order_count - 1;
+		static constexpr size_t default_reserve_size = 1024ull * 1024 * 1024;
+		// Decommitting smaller merged blocks returns memory sooner, but blocks
+		// that split and merge again keep paying for commit and first touch.
+		static constexpr size_t default_decommit_size = max_block_size;
+
+		buddy_allocator(
+			size_t reserve_size = default_reserve_size,
+			size_t decommit_size = default_decommit_size,
+			internal::os_page_interface& pages = internal::get_os_page_interface()
+		);
+		~buddy_allocator() override;
+		buddy_allocator(const buddy_allocator&) = delete;
+		buddy_allocator& operator=(const buddy_allocator&) = delete;
+
+		using allocator::allocate;
+		using allocator::deallocate;
+
+		void* allocate(size_t size) override;
+		void* allocate(size_t size, size_t alignment) override;
+		void deallocate(void* ptr) override;
+
+		bool owns(const void* ptr) const noexcept;
+		// Usable size of a live allocation.
+		size_t block_size(const void* ptr) const noexcept;
+
+		buddy_stats get_stats() const noexcept;
+		inline size_t committed() const noexcept { return committed_units_ * min_block_size; }
+		inline size_t reserved() const noexcept { return unit_count_ * min_block_size; }
+
+	private:
+		static constexpr uint32_t no_unit = ~uint32_t(0);
+
+		// One entry per min_block_size unit. Only the first unit of a block
+		// carries its order, state and list links.
+		struct unit
+		{
+			uint32_t next;
+			uint32_t prev;
+			uint32_t requested;
+			uint8_t order;
+			uint8_t block_start : 1;
+			uint8_t free : 1;
+			uint8_t committed : 1;
+		};
+
+		static uint32_t order_of(size_t size) noexcept;
+
+		void release_block(uint32_t index, uint32_t order) noexcept;
+		void push_free(uint32_t index, uint32_t order) noexcept;
+		void remove_free(uint32_t index, uint32_t order) noexcept;
+		bool commit_units(uint32_t index, uint32_t count) noexcept;
+		void decommit_units(uint32_t index, uint32_t count) noexcept;
+		inline char* unit_address(uint32_t index) const noexcept { return base_ + static_cast<size_t>(index) * min_block_size; }
+
+	private:
+		internal::os_page_interface* pages_ = nullptr;
+		char* reservation_ = nullptr;
+		size_t reservation_size_ = 0;
+		char* base_ = nullptr;   // reservation_ rounded up to max_block_size
+		unit* units_ = nullptr;
+		size_t units_size_ = 0;
+		uint32_t unit_count_ = 0;
+		uint32_t decommit_order_ = 0;
+
+		uint32_t free_heads_[buddy_stats::order_count] = {};
+		size_t free_counts_[buddy_stats::order_count] = {};
+		uint32_t free_mask_ = 0;
+		size_t committed_units_ = 0;
+		size_t allocated_bytes_ = 0;
+		size_t requested_bytes_ = 0;
+	};
+
+}
+
+#endif // ARES_CORE_BUDDY_ALLOCATOR_H
\ No newline at end of file
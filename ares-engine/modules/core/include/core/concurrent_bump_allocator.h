@@ -0,0 +1,107 @@
+#ifndef ARES_CORE_CONCURRENT_BUMP_ALLOCATOR_H
+#define ARES_CORE_CONCURRENT_BUMP_ALLOCATOR_H
+#include <stddef.h>
+#include <stdint.h>
+#include "core/core_api.h"
+#include "core/allocator.h"
+#include "core/atomic.h"
+#include "core/platform.h"
+#include "core/internal/os_page_interface.h"
+
+namespace ares::core {
+
+	// Lock-free bump arena for transient allocations from parallel jobs. Threads
+	// claim chunks from a shared cursor with a single fetch_add and bump through
+	// them privately; allocations too big for a chunk are claimed from the cursor
+	// directly. Nothing is freed individually: reset() starts a new epoch and
+	// drops everything at once, and must not run concurrently with allocate().
+	class ARES_CORE_API concurrent_bump_allocator final : public allocator
+	{
+	public:
+		static constexpr size_t default_reserve_size = 1ull * 1024 * 1024 * 1024;
+		static constexpr size_t default_chunk_size = 64 * 1024;
+
+		concurrent_bump_allocator(
+			size_t reserve_size = default_reserve_size,
+			size_t chunk_size = default_chunk_size,
+			internal::os_page_interface& pages = internal::get_os_page_interface()
+		);
+		~concurrent_bump_allocator() override;
+		concurrent_bump_allocator(const concurrent_bump_allocator&) = delete;
+		concurrent_bump_allocator& operator=(const concurrent_bump_allocator&) = delete;
+
+		using allocator::allocate;
+		using allocator::deallocate;
+
+		void* allocate(size_t size) override;
+		void* allocate(size_t size, size_t alignment) override;
+		void* allocate(size_t size, size_t alignment, size_t offset) override;
+		void deallocate(void* ptr) override {}
+
+		void reset() noexcept;
+
+		inline uint64_t epoch() const noexcept { return epoch_.load(memory_order_relaxed); }
+		inline size_t chunk_size() const noexcept { return chunk_size_; }
+		inline size_t reserved() const noexcept { return reserved_; }
+		// Bytes claimed from the shared cursor this epoch, including the unused
+		// tails of thread chunks.
+		size_t used() const noexcept;
+		inline size_t committed() const noexcept { return committed_; }
+
+	private:
+		// A thread's current chunk. Entries are matched by the allocator's serial
+		// so an entry left behind by a destroyed allocator is never reused. Serials
+		// are handed out in order, so allocators alive at the same time rarely
+		// share a slot.
+		struct thread_chunk
+		{
+			uint64_t serial;
+			uint64_t epoch;
+			char* cursor;
+			char* end;
+		};
+
+		static constexpr size_t thread_chunk_slots = 16;
+
+		static thread_chunk& local_chunk(uint64_t serial) noexcept;
+		void* allocate_slow(thread_chunk& chunk, uint64_t epoch, size_t size, size_t alignment, size_t offset) noexcept;
+		char* claim(size_t size) noexcept;
+
+	private:
+		internal::os_page_interface* pages_ = nullptr;
+		char* base_ = nullptr;
+		size_t reserved_ = 0;
+		size_t chunk_size_ = 0;
+		size_t page_size_ = 0;
+		uint64_t serial_ = 0;
+		// Everything below committed_ was committed in an earlier epoch. Claims
+		// above it commit their own range.
+		size_t committed_ = 0;
+
+		alignas(ARES_CACHE_LINE_SIZE) atomic<size_t> cursor_;
+		atomic<uint64_t> epoch_;
+		atomic<bool> commit_failed_;
+	};
+
+	inline void* concurrent_bump_allocator::allocate(size_t size, size_t alignment, size_t offset)
+	{
+		uint64_t epoch = epoch_.load(memory_order_relaxed);
+		thread_chunk& chunk = local_chunk(serial_);
+		if (chunk.serial == serial_ && chunk.epoch == epoch)
+		{
+			uintptr_t cursor = reinterpret_cast<uintptr_t>(chunk.cursor);
+			uintptr_t start = ((cursor + offset + alignment - 1) & ~(uintptr_t(alignment) - 1)) - offset;
+			uintptr_t end = reinterpret_cast<uintptr_t>(chunk.end);
+			// Compared as distances so huge sizes or offsets cannot wrap past end.
+			if (start >= cursor && start <= end && size <= end - start)
+			{
+				chunk.cursor = reinterpret_cast<char*>(start + size);
+				return reinterpret_cast<void*>(start);
+			}
+		}
+		return allocate_slow(chunk, epoch, size, alignment, offset);
+	}
+
+}
+
+#endif // ARES_CORE_CONCURRENT_BUMP_ALLOCATOR_H
\ No newline at end of file
@@ -2,11 +2,13 @@
 #define ARES_CORE_API_H
 #ifdef ARES_STATIC_BUILD
 	#define ARES_CORE_API
-#else
+#elif defined(_WIN32)
 	#ifdef ARES_CORE_EXPORTS
 		#define ARES_CORE_API __declspec(dllexport)
 	#else
 		#define ARES_CORE_API __declspec(dllimport)
 	#endif
+#else
+	#define ARES_CORE_API __attribute__((visibility("default")))
 #endif
 #endif // ARES_CORE_API_H
\ No newline at end of file
@@ -0,0 +1,52 @@
+#ifndef ARES_CORE_DEFAULT_ALLOCATOR_H
+#define ARES_CORE_DEFAULT_ALLOCATOR_H
+#include <stdlib.h>
+#include "core/allocator.h"
+#include "core/allocator_manager.h"
+#include "core/platform.h"
+
+#if ARES_PLATFORM_WINDOWS
+#include <malloc.h>
+#endif
+
+namespace ares::core {
+
+	// General purpose heap allocator backed by the C runtime.
+	class default_allocator final : public allocator
+	{
+	public:
+		static constexpr allocator_slot slot = allocator_slot::default_heap;
+
+		default_allocator() {}
+
+		using allocator::allocate;
+		using allocator::deallocate;
+
+		void* allocate(size_t size) override { return allocate(size, ARES_PLATFORM_MIN_MALLOC_ALIGNMENT); }
+		void* allocate(size_t size, size_t alignment) override
+		{
+		#if ARES_PLATFORM_WINDOWS
+			return _aligned_malloc(size, alignment);
+		#else
+			if (alignment <= ARES_PLATFORM_MIN_MALLOC_ALIGNMENT)
+			{
+				return malloc(size);
+			}
+
+			void* result = nullptr;
+			return posix_memalign(&result, alignment, size) == 0 ? result : nullptr;
+		#endif
+		}
+		void deallocate(void* ptr) override
+		{
+		#if ARES_PLATFORM_WINDOWS
+			_aligned_free(ptr);
+		#else
+			free(ptr);
+		#endif
+		}
+	};
+
+}
+
+#endif // ARES_CORE_DEFAULT_ALLOCATOR_H
\ No newline at end of file
@@ -0,0 +1,283 @@
+#ifndef ARES_CORE_EYTZINGER_INDEX_H
+#define ARES_CORE_EYTZINGER_INDEX_H
+#include <assert.h>
+#include <EASTL/functional.h>
+#include <EASTL/iterator.h>
+#include <EASTL/utility.h>
+#include "core/default_allocator.h"
+#include "core/eytzinger_index_iterator.h"
+#include "core/internal/bits.h"
+#include "core/internal/prefetch.h"
+#include "core/platform.h"
+#include "core/sys_allocator.h"
+#include "core/type_traits.h"
+
+namespace ares::core {
+
+	// Immutable sorted index for data that is built once and then only read.
+	// Keys are stored in Eytzinger order, the breadth-first layout of a balanced
+	// tree, in one cache-line aligned array. A lookup descends it with one
+	// branch-free comparison per level and prefetches the line holding the
+	// descendants a few levels down, so there is no pointer chasing. Maps keep
+	// their elements in a second array in the same order, so searches only touch
+	// keys.
+	template <typename key, typename value = void, typename allocator = default_allocator>
+	class eytzinger_index
+	{
+	private:
+		static_assert(is_ares_allocator_v<allocator>, "Invalid allocator type!");
+		static constexpr bool is_set = eastl::is_void_v<value>;
+	public:
+		using key_type = key;
+		using key_compare = eastl::less<key>;
+		using mapped_type = value;
+		using value_type = eastl::conditional_t<is_set, key, eastl::pair<const key, value>>;
+		using allocator_type = sys_allocator<allocator>;
+		using size_type = std::size_t;
+		using difference_type = std::ptrdiff_t;
+
+		using reference = const value_type&;
+		using const_reference = const value_type&;
+		using pointer = const value_type*;
+		using const_pointer = const value_type*;
+
+		using const_iterator = eytzinger_index_iterator<value_type>;
+		using iterator = const_iterator;
+		using const_reverse_iterator = eastl::reverse_iterator<const_iterator>;
+		using reverse_iterator = const_reverse_iterator;
+		using const_iterator_pair_type = eastl::pair<const_iterator, const_iterator>;
+
+		eytzinger_index() {}
+		eytzinger_index(allocator_type& alloc) : allocator_(alloc) {}
+		~eytzinger_index() { clear(); }
+		eytzinger_index(const eytzinger_index&) = delete;
+		eytzinger_index& operator=(const eytzinger_index&) = delete;
+
+		eytzinger_index(eytzinger_index&& other) noexcept;
+		eytzinger_index& operator=(eytzinger_index&& other) noexcept;
+
+		// Replaces the contents with [first, last), which must be sorted by key
+		// with no duplicates. Returns false and leaves the index empty when
+		// allocation fails.
+		template <typename forward_iterator> bool assign_sorted(forward_iterator first, forward_iterator last);
+		// Snapshots an ordered container such as avl_tree or btree.
+		template <typename container_type> bool freeze(const container_type& container) { return assign_sorted(container.begin(), container.end()); }
+		void clear();
+
+		// Iterators
+		const_iterator begin() const noexcept { return ++const_iterator(data(), size_, 0); }
+		const_iterator end() const noexcept { return const_iterator(data(), size_, 0); }
+		const_iterator cbegin() const noexcept { return begin(); }
+		const_iterator cend() const noexcept { return end(); }
+		const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+		const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+		const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+		const_reverse_iterator crend() const noexcept { return rend(); }
+
+		// Capacity
+		size_type size() const noexcept { return size_; }
+		bool empty() const noexcept { return size_ == 0; }
+
+		// Lookup
+		const_iterator find(const key_type& key_arg) const noexcept;
+		const_iterator lower_bound(const key_type& key_arg) const noexcept { return const_iterator(data(), size_, search<false>(key_arg)); }
+		const_iterator upper_bound(const key_type& key_arg) const noexcept { return const_iterator(data(), size_, search<true>(key_arg)); }
+		const_iterator_pair_type equal_range(const key_type& key_arg) const noexcept { return { lower_bound(key_arg), upper_bound(key_arg) }; }
+
+		// Other
+		allocator_type& get_allocator() const { return allocator_; }
+
+	private:
+		// Positions whose descendants this many levels down share one cache line.
+		static constexpr size_type keys_per_line = ARES_CACHE_LINE_SIZE / sizeof(key) > 0 ? ARES_CACHE_LINE_SIZE / sizeof(key) : 1;
+		static constexpr size_type array_alignment = alignof(key) > ARES_CACHE_LINE_SIZE ? alignof(key) : ARES_CACHE_LINE_SIZE;
+
+		const value_type* data() const noexcept
+		{
+			if constexpr (is_set)
+			{
+				return keys_;
+			}
+			else
+			{
+				return elements_;
+			}
+		}
+
+		template <typename data_type>
+		static const key_type& key_of(const data_type& data) noexcept
+		{
+			if constexpr (is_set)
+			{
+				return data;
+			}
+			else
+			{
+				return data.first;
+			}
+		}
+
+		template <bool upper> size_type search(const key_type& key_arg) const noexcept;
+
+	private:
+		key_type* keys_ = nullptr;           // positions 1..size_, position 0 unused
+		value_type* elements_ = nullptr;     // maps only, same layout as keys_
+		size_type size_ = 0;
+		key_compare compare_;
+		mutable allocator_type allocator_;
+	};
+
+	//
+	// Constructors
+	//
+	template <typename key, typename value, typename allocator>
+	inline eytzinger_index<key, value, allocator>::eytzinger_index(eytzinger_index&& other) noexcept
+		: keys_(eastl::exchange(other.keys_, nullptr)),
+		elements_(eastl::exchange(other.elements_, nullptr)),
+		size_(eastl::exchange(other.size_, 0)),
+		compare_(eastl::move(other.compare_)),
+		allocator_(other.allocator_)
+	{
+	}
+
+	template <typename key, typename value, typename allocator>
+	inline eytzinger_index<key, value, allocator>& eytzinger_index<key, value, allocator>::operator=(eytzinger_index&& other) noexcept
+	{
+		if (this != &other)
+		{
+			clear();
+
+			keys_ = eastl::exchange(other.keys_, nullptr);
+			elements_ = eastl::exchange(other.elements_, nullptr);
+			size_ = eastl::exchange(other.size_, 0);
+			compare_ = eastl::move(other.compare_);
+			allocator_ = other.allocator_;
+		}
+		return *this;
+	}
+
+	//
+	// MODIFIERS
+	//
+	template <typename key, typename value, typename allocator>
+	template <typename forward_iterator>
+	inline bool eytzinger_index<key, value, allocator>::assign_sorted(forward_iterator first, forward_iterator last)
+	{
+		clear();
+
+		size_type count = static_cast<size_type>(eastl::distance(first, last));
+		if (count == 0)
+		{
+			return true;
+		}
+
+		keys_ = static_cast<key_type*>(allocator_.allocate((count + 1) * sizeof(key_type), array_alignment));
+		if constexpr (!is_set)
+		{
+			elements_ = static_cast<value_type*>(allocator_.allocate((count + 1) * sizeof(value_type), alignof(value_type)));
+		}
+
+		if (!keys_ || (!is_set && !elements_))
+		{
+			// size_ is still 0, so clear() would free the arrays with the wrong size.
+			if (keys_)
+			{
+				allocator_.deallocate(keys_, (count + 1) * sizeof(key_type), array_alignment);
+			}
+			if (elements_)
+			{
+				allocator_.deallocate(elements_, (count + 1) * sizeof(value_type), alignof(value_type));
+			}
+			keys_ = nullptr;
+			elements_ = nullptr;
+			return false;
+		}
+
+		// An in-order walk of the implicit tree visits positions in key order.
+		size_ = count;
+		const_iterator position = end();
+		const key_type* previous = nullptr;
+		for (++position; first != last; ++first, ++position)
+		{
+			size_type index = position.get_position();
+			new (keys_ + index) key_type(key_of(*first));
+			if constexpr (!is_set)
+			{
+				new (elements_ + index) value_type(*first);
+			}
+
+			assert((!previous || compare_(*previous, keys_[index])) && "Keys must be sorted and unique!");
+			previous = keys_ + index;
+		}
+		return true;
+	}
+
+	template <typename key, typename value, typename allocator>
+	inline void eytzinger_index<key, value, allocator>::clear()
+	{
+		for (size_type i = 1; i <= size_; i++)
+		{
+			keys_[i].~key_type();
+			if constexpr (!is_set)
+			{
+				elements_[i].~value_type();
+			}
+		}
+
+		if (keys_)
+		{
+			allocator_.deallocate(keys_, (size_ + 1) * sizeof(key_type), array_alignment);
+		}
+		if (elements_)
+		{
+			allocator_.deallocate(elements_, (size_ + 1) * sizeof(value_type), alignof(value_type));
+		}
+
+		keys_ = nullptr;
+		elements_ = nullptr;
+		size_ = 0;
+	}
+
+	//
+	// LOOKUP
+	//
+	template <typename key, typename value, typename allocator>
+	inline typename eytzinger_index<key, value, allocator>::const_iterator eytzinger_index<key, value, allocator>::find(const key_type& key_arg) const noexcept
+	{
+		size_type position = search<false>(key_arg);
+		if (position != 0 && compare_(key_arg, keys_[position]))
+		{
+			position = 0;
+		}
+		return const_iterator(data(), size_, position);
+	}
+
+	//
+	// PRIVATE METHODS
+	//
+	// Goes right wherever the key is below key_arg (not above it for upper), then
+	// undoes the trailing right turns: the answer is where the descent last went
+	// left, or 0 when it never did.
+	template <typename key, typename value, typename allocator>
+	template <bool upper>
+	inline typename eytzinger_index<key, value, allocator>::size_type eytzinger_index<key, value, allocator>::search(const key_type& key_arg) const noexcept
+	{
+		size_type position = 1;
+		while (position <= size_)
+		{
+			internal::prefetch(keys_ + position * keys_per_line);
+			if constexpr (upper)
+			{
+				position = 2 * position + !compare_(key_arg, keys_[position]);
+			}
+			else
+			{
+				position = 2 * position + compare_(keys_[position], key_arg);
+			}
+		}
+		return position >> (internal::find_first_set(~static_cast<uint64_t>(position)) + 1);
+	}
+
+}
+
+#endif // ARES_CORE_EYTZINGER_INDEX_H
\ No newline at end of file
@@ -0,0 +1,105 @@
+#ifndef ARES_CORE_EYTZINGER_INDEX_ITERATOR_H
+#define ARES_CORE_EYTZINGER_INDEX_ITERATOR_H
+#include <EASTL/iterator.h>
+#include "core/internal/bits.h"
+
+namespace ares::core {
+
+	// Walks an Eytzinger array in key order. Elements sit at positions 1..count
+	// with the children of k at 2k and 2k + 1; position 0 is end().
+	template <typename value>
+	class eytzinger_index_iterator
+	{
+	public:
+		using value_type = value;
+		using pointer = const value*;
+		using reference = const value&;
+		using iterator_category = eastl::bidirectional_iterator_tag;
+		using difference_type = std::ptrdiff_t;
+		using size_type = std::size_t;
+
+		eytzinger_index_iterator() = default;
+		eytzinger_index_iterator(const value* data, size_type count, size_type position) : data_(data), count_(count), position_(position) {}
+
+		pointer operator->() const { return data_ + position_; }
+		reference operator*() const { return data_[position_]; }
+
+		eytzinger_index_iterator& operator++();
+		eytzinger_index_iterator operator++(int);
+		eytzinger_index_iterator& operator--();
+		eytzinger_index_iterator operator--(int);
+
+		bool operator==(const eytzinger_index_iterator& other) const { return position_ == other.position_ && data_ == other.data_; }
+		bool operator!=(const eytzinger_index_iterator& other) const { return !(*this == other); }
+
+		size_type get_position() const { return position_; }
+
+	private:
+		const value* data_ = nullptr;
+		size_type count_ = 0;
+		size_type position_ = 0;
+	};
+
+	template <typename value>
+	inline eytzinger_index_iterator<value>& eytzinger_index_iterator<value>::operator++()
+	{
+		if (2 * position_ + 1 <= count_)
+		{
+			position_ = 2 * position_ + 1;
+			while (2 * position_ <= count_)
+			{
+				position_ *= 2;
+			}
+		}
+		else
+		{
+			// Climb past every ancestor this subtree is the right child of.
+			position_ >>= internal::find_first_set(~static_cast<uint64_t>(position_)) + 1;
+		}
+		return *this;
+	}
+
+	template <typename value>
+	inline eytzinger_index_iterator<value> eytzinger_index_iterator<value>::operator++(int)
+	{
+		eytzinger_index_iterator temp = *this;
+		++(*this);
+		return temp;
+	}
+
+	template <typename value>
+	inline eytzinger_index_iterator<value>& eytzinger_index_iterator<value>::operator--()
+	{
+		if (position_ == 0)
+		{
+			position_ = 1;
+			while (2 * position_ + 1 <= count_)
+			{
+				position_ = 2 * position_ + 1;
+			}
+		}
+		else if (2 * position_ <= count_)
+		{
+			position_ *= 2;
+			while (2 * position_ + 1 <= count_)
+			{
+				position_ = 2 * position_ + 1;
+			}
+		}
+		else
+		{
+			position_ >>= internal::find_first_set(static_cast<uint64_t>(position_)) + 1;
+		}
+		return *this;
+	}
+
+	template <typename value>
+	inline eytzinger_index_iterator<value> eytzinger_index_iterator<value>::operator--(int)
+	{
+		eytzinger_index_iterator temp = *this;
+		--(*this);
+		return temp;
+	}
+}
+
+#endif // ARES_CORE_EYTZINGER_INDEX_ITERATOR_H
\ No newline at end of file
@@ -0,0 +1,83 @@
+#ifndef ARES_CORE_FRAME_ALLOCATOR_H
+#define ARES_CORE_FRAME_ALLOCATOR_H
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include "core/core_api.h"
+#include "core/allocator.h"
+#include "core/allocator_manager.h"
+#include "core/atomic.h"
+#include "core/platform.h"
+#include "core/internal/os_page_interface.h"
+
+namespace ares::core {
+
+	// N-buffered frame arena for data handed from one frame to the next. Each
+	// frame allocates into its own buffer; flip() moves on to the next one and
+	// drops whatever it held, so memory allocated in frame N stays valid until
+	// frame N + buffer_count. allocate() is thread-safe, flip() must not run
+	// concurrently with it.
+	class ARES_CORE_API frame_allocator final : public allocator
+	{
+	public:
+		static constexpr allocator_slot slot = allocator_slot::frame;
+		static constexpr uint32_t max_buffers = 4;
+		static constexpr size_t default_reserve_size = 64ull * 1024 * 1024;
+		static constexpr size_t default_commit_size = 64 * 1024;
+
+		// reserve_size is per buffer.
+		frame_allocator(
+			uint32_t buffer_count = 2,
+			size_t reserve_size = default_reserve_size,
+			internal::os_page_interface& pages = internal::get_os_page_interface()
+		);
+		~frame_allocator() override;
+		frame_allocator(const frame_allocator&) = delete;
+		frame_allocator& operator=(const frame_allocator&) = delete;
+
+		using allocator::allocate;
+		using allocator::deallocate;
+
+		void* allocate(size_t size) override;
+		void* allocate(size_t size, size_t alignment) override;
+		void* allocate(size_t size, size_t alignment, size_t offset) override;
+		// Memory goes back when its buffer comes around again.
+		void deallocate(void* ptr) override {}
+
+		void flip() noexcept;
+
+		inline uint64_t frame() const noexcept { return frame_; }
+		inline uint32_t buffer_count() const noexcept { return buffer_count_; }
+		inline size_t reserved() const noexcept { return buffer_size_; }
+		// Bytes allocated in the current frame.
+		inline size_t used() const noexcept { return buffers_[current_].offset.load(memory_order_relaxed); }
+		size_t committed() const noexcept;
+		inline size_t high_water() const noexcept { return high_water_; }
+
+	private:
+		struct alignas(ARES_CACHE_LINE_SIZE) buffer
+		{
+			atomic<size_t> offset;
+			atomic<size_t> committed;
+			char* base;
+		};
+
+		bool grow(buffer& target, size_t required) noexcept;
+
+	private:
+		internal::os_page_interface* pages_ = nullptr;
+		char* base_ = nullptr;
+		size_t buffer_size_ = 0;
+		uint32_t buffer_count_ = 0;
+		uint32_t current_ = 0;
+		uint64_t frame_ = 0;
+		size_t high_water_ = 0;
+		std::mutex grow_mutex_;
+		buffer buffers_[max_buffers];
+	};
+
+	frame_allocator& get_frame_allocator();
+
+}
+
+#endif // ARES_CORE_FRAME_ALLOCATOR_H
\ No newline at end of file
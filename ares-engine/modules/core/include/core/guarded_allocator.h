@@ -0,0 +1,148 @@
+#ifndef ARES_CORE_GUARDED_ALLOCATOR_H
+#define ARES_CORE_GUARDED_ALLOCATOR_H
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include "core/core_api.h"
+#include "core/allocation_tags.h"
+#include "core/allocator.h"
+#include "core/atomic.h"
+#include "core/internal/os_page_interface.h"
+
+// sys_allocator routes sampled allocations through the process guarded
+// allocator in every build except release, where it has to be requested with
+// ARES_ENABLE_GUARDED_ALLOCATIONS. Every tag starts with sampling off.
+#ifndef ARES_GUARDED_ALLOCATIONS
+	#if defined(ARES_ENABLE_GUARDED_ALLOCATIONS) || !defined(ARES_BUILD_RELEASE)
+		#define ARES_GUARDED_ALLOCATIONS 1
+	#else
+		#define ARES_GUARDED_ALLOCATIONS 0
+	#endif
+#endif
+
+namespace ares::core {
+
+	// Debug allocator that ends every allocation against an inaccessible guard
+	// page, so an overflow faults at the offending write; overflows that stay
+	// within the alignment padding are caught when the block is freed. Freed allocations are
+	// decommitted and held in a quarantine before their pages are reused, so
+	// use-after-free faults too. With a backing allocator only one allocation in
+	// sample_rate is guarded and the rest go to the backing allocator, which keeps
+	// the cost low enough for production builds. Thread-safe if the backing
+	// allocator is.
+	class ARES_CORE_API guarded_allocator final : public allocator
+	{
+	public:
+		static constexpr size_t default_reserve_size = 1024ull * 1024 * 1024;
+		static constexpr size_t default_quarantine_size = 16 * 1024 * 1024;
+
+		// Without a backing allocator every allocation is guarded and allocations
+		// fail once the reservation is used up.
+		guarded_allocator(
+			allocator* backing = nullptr,
+			uint32_t sample_rate = 1,
+			size_t quarantine_size = default_quarantine_size,
+			size_t reserve_size = default_reserve_size,
+			internal::os_page_interface& pages = internal::get_os_page_interface()
+		);
+		~guarded_allocator() override;
+		guarded_allocator(const guarded_allocator&) = delete;
+		guarded_allocator& operator=(const guarded_allocator&) = delete;
+
+		using allocator::allocate;
+		using allocator::deallocate;
+
+		void* allocate(size_t size) override;
+		void* allocate(size_t size, size_t alignment) override;
+		void* allocate(size_t size, size_t alignment, size_t offset) override;
+		void deallocate(void* ptr) override;
+
+		// Always guards. Returns nullptr when the reservation is full.
+		void* allocate_guarded(size_t size, size_t alignment, size_t offset = 0);
+		void deallocate_guarded(void* ptr);
+
+		inline bool owns(const void* ptr) const noexcept
+		{
+			const char* p = static_cast<const char*>(ptr);
+			return p >= base_ && p < base_ + reserved_;
+		}
+
+		// True for about one call in rate. A rate of 0 never samples.
+		static bool should_sample(uint32_t rate) noexcept;
+
+		inline uint32_t sample_rate() const noexcept { return sample_rate_.load(memory_order_relaxed); }
+		inline void set_sample_rate(uint32_t rate) noexcept { sample_rate_.store(rate, memory_order_relaxed); }
+		inline allocator* get_backing_allocator() const noexcept { return backing_; }
+		size_t live_allocations();
+		size_t quarantined_bytes();
+
+	private:
+		struct header;
+
+		static constexpr uint32_t max_order = 24;
+		static constexpr uint32_t no_slot = ~uint32_t(0);
+
+		uint32_t take_slot(uint32_t order) noexcept;
+		void release_quarantine() noexcept;
+
+	private:
+		internal::os_page_interface* pages_ = nullptr;
+		allocator* backing_ = nullptr;
+		atomic<uint32_t> sample_rate_;
+
+		char* base_ = nullptr;
+		size_t reserved_ = 0;
+		size_t page_size_ = 0;
+		uint32_t page_count_ = 0;
+
+		// Slots are 2^order pages with the last one left as the guard, and sit at
+		// an index aligned to their size. links_ and orders_ are indexed by a
+		// slot's first page and chain the free lists and the quarantine queue.
+		uint32_t* links_ = nullptr;
+		uint8_t* orders_ = nullptr;
+		size_t metadata_size_ = 0;
+
+		std::mutex mutex_;
+		uint32_t next_page_ = 0;
+		uint32_t free_heads_[max_order + 1] = {};
+		uint32_t quarantine_head_ = no_slot;
+		uint32_t quarantine_tail_ = no_slot;
+		size_t quarantine_bytes_ = 0;
+		size_t quarantine_limit_ = 0;
+		size_t live_allocations_ = 0;
+	};
+
+	// Guard sampling rates by allocation tag. sys_allocator reads the rate of its
+	// tag on every allocation, so changing a rate affects allocators that
+	// already exist.
+	class ARES_CORE_API guard_selection
+	{
+	public:
+		guard_selection();
+		guard_selection(const guard_selection&) = delete;
+		guard_selection& operator=(const guard_selection&) = delete;
+
+		void set_sample_rate(const char* name, uint32_t rate);
+		uint32_t sample_rate(const char* name);
+		// Acquire pairs with set_sample_rate, so a block guarded on any thread is
+		// freed after active() turned true.
+		inline uint32_t sample_rate(allocation_tags::tag value) const noexcept { return rates_[value].load(memory_order_acquire); }
+
+		// False until a rate is first set above 0, and true from then on since
+		// guarded blocks outlive their rate. Until then frees skip the guarded
+		// allocator entirely, so it is never created.
+		inline bool active() const noexcept { return active_.load(memory_order_relaxed); }
+
+	private:
+		atomic<uint32_t> rates_[allocation_tags::max_tags];
+		atomic<bool> active_;
+	};
+
+	// The allocator that guarded sys_allocator allocations come from. It has no
+	// backing allocator; sampling is decided by guard_selection.
+	guarded_allocator& get_guarded_allocator();
+	guard_selection& get_guard_selection();
+
+}
+
+#endif // ARES_CORE_GUARDED_ALLOCATOR_H
\ No newline at end of file
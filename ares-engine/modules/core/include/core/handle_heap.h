@@ -0,0 +1,134 @@
+#ifndef ARES_CORE_HANDLE_HEAP_H
+#define ARES_CORE_HANDLE_HEAP_H
+#include <stddef.h>
+#include <stdint.h>
+#include "core/core_api.h"
+#include "core/internal/os_page_interface.h"
+
+namespace ares::core {
+
+	// Reference to a handle_heap block. A handle whose block has been freed stops
+	// resolving, even when its slot is reused.
+	struct heap_handle
+	{
+		uint32_t index = 0;
+		uint32_t generation = 0;   // 0 for the null handle
+
+		inline explicit operator bool() const noexcept { return generation != 0; }
+		inline bool operator==(const heap_handle& other) const noexcept { return index == other.index && generation == other.generation; }
+		inline bool operator!=(const heap_handle& other) const noexcept { return !(*this == other); }
+	};
+
+	struct handle_heap_stats
+	{
+		size_t live_blocks = 0;
+		size_t used_bytes = 0;            // live blocks, headers included
+		size_t free_bytes = 0;            // holes below the top of the heap
+		size_t largest_free_block = 0;
+		size_t top = 0;                   // end of the last live block
+		size_t committed_bytes = 0;
+		size_t reserved_bytes = 0;
+		// 1 - largest free block / free bytes: how scattered the holes are.
+		double fragmentation = 0.0;
+	};
+
+	// Heap of movable blocks referenced through generation-checked handles.
+	// compact() slides live blocks down over the holes between them, a time
+	// budget at a time, so free space ends up in one piece at the top. Pointers
+	// from resolve() stay valid until the next compact() unless the block is
+	// pinned; pinned blocks are never moved. Blocks are 16 byte aligned and the
+	// heap lives in one reserved range committed on demand. Not thread-safe.
+	class ARES_CORE_API handle_heap
+	{
+	public:
+		static constexpr size_t alignment = 16;
+		static constexpr size_t default_reserve_size = 256ull * 1024 * 1024;
+		static constexpr size_t default_max_handles = 1024 * 1024;
+		static constexpr size_t default_commit_size = 64 * 1024;
+		// Decommitting is slow enough to blow a frame budget, so compact() hands the
+		// space it frees back to the OS this much at a time.
+		static constexpr size_t trim_step = 1024 * 1024;
+
+		handle_heap(
+			size_t reserve_size = default_reserve_size,
+			size_t max_handles = default_max_handles,
+			internal::os_page_interface& pages = internal::get_os_page_interface()
+		);
+		~handle_heap();
+		handle_heap(const handle_heap&) = delete;
+		handle_heap& operator=(const handle_heap&) = delete;
+
+		// Returns the null handle when the heap or the handle table is full.
+		heap_handle allocate(size_t size) noexcept;
+		void deallocate(heap_handle handle) noexcept;
+
+		bool valid(heap_handle handle) const noexcept;
+		// nullptr for stale and null handles.
+		void* resolve(heap_handle handle) const noexcept;
+		// Usable size, at least what was asked for.
+		size_t size_of(heap_handle handle) const noexcept;
+
+		// Pins nest; a block moves again once every pin is undone.
+		void pin(heap_handle handle) noexcept;
+		void unpin(heap_handle handle) noexcept;
+
+		// Moves blocks for about budget_us microseconds, carrying on from where the
+		// previous call stopped. Returns true when a pass over the whole heap has
+		// finished, after which the next call starts a new one.
+		bool compact(uint32_t budget_us) noexcept;
+
+		handle_heap_stats get_stats() const noexcept;
+
+	private:
+		struct block_header;
+		struct handle_entry;
+		struct free_links;
+
+		static constexpr uint32_t bin_count = 32;
+		static constexpr uint32_t no_block = ~0u;
+		static constexpr uint32_t free_block = ~0u;
+
+		block_header* block_at(uint32_t granule) const noexcept;
+		handle_entry* entry_of(heap_handle handle) const noexcept;
+		free_links* links_of(uint32_t granule) const noexcept;
+
+		void insert_free(uint32_t granule) noexcept;
+		void remove_free(uint32_t granule) noexcept;
+		uint32_t find_free(uint32_t granules) noexcept;
+		// Joins a free block with free neighbours and gives it to the bins, or to
+		// the top of the heap when it ends there.
+		void release_block(uint32_t granule) noexcept;
+		void split(uint32_t granule, uint32_t granules) noexcept;
+		// compact() resumes at a block boundary; blocks merged or split between
+		// calls move it back to the start of the changed range.
+		void rewind_cursor(uint32_t first, uint32_t last) noexcept;
+		bool grow_top(uint32_t granules) noexcept;
+		bool grow_handles() noexcept;
+		// Decommits up to max_size bytes above the top; false once nothing is left.
+		bool trim(size_t max_size) noexcept;
+
+	private:
+		internal::os_page_interface* pages_ = nullptr;
+		char* base_ = nullptr;
+		size_t reserved_ = 0;
+		size_t committed_ = 0;
+		uint32_t top_ = 0;           // in granules
+		uint32_t last_size_ = 0;     // of the block ending at top_
+
+		handle_entry* handles_ = nullptr;
+		size_t max_handles_ = 0;
+		size_t handles_reserved_ = 0;
+		size_t handles_committed_ = 0;
+		uint32_t handle_count_ = 0;
+		uint32_t free_handle_ = no_block;
+
+		uint32_t bins_[bin_count] = {};
+		uint32_t bin_mask_ = 0;
+		uint32_t compact_cursor_ = 0;
+		size_t live_blocks_ = 0;
+		size_t used_granules_ = 0;
+	};
+
+}
+
+#endif // ARES_CORE_HANDLE_HEAP_H
\ No newline at end of file
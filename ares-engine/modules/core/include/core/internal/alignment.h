@@ -0,0 +1,30 @@
+#ifndef ARES_CORE_ALIGNMENT_H
+#define ARES_CORE_ALIGNMENT_H
+#include <stddef.h>
+#include <stdint.h>
+
+namespace ares::core::internal {
+
+	constexpr bool is_power_of_two(size_t value) noexcept
+	{
+		return value != 0 && (value & (value - 1)) == 0;
+	}
+
+	constexpr size_t align_up(size_t value, size_t alignment) noexcept
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	constexpr size_t align_down(size_t value, size_t alignment) noexcept
+	{
+		return value & ~(alignment - 1);
+	}
+
+	inline void* align_up(void* ptr, size_t alignment) noexcept
+	{
+		return reinterpret_cast<void*>(align_up(reinterpret_cast<uintptr_t>(ptr), alignment));
+	}
+
+}
+
+#endif // ARES_CORE_ALIGNMENT_H
\ No newline at end of file
@@ -0,0 +1,39 @@
+#ifndef ARES_CORE_BITS_H
+#define ARES_CORE_BITS_H
+#include <stddef.h>
+#include <stdint.h>
+#include "core/platform.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace ares::core::internal {
+
+	// Index of the most significant set bit. value must be non-zero.
+	inline uint32_t find_last_set(uint64_t value) noexcept
+	{
+	#if defined(_MSC_VER)
+		unsigned long index = 0;
+		_BitScanReverse64(&index, value);
+		return static_cast<uint32_t>(index);
+	#else
+		return 63u - static_cast<uint32_t>(__builtin_clzll(value));
+	#endif
+	}
+
+	// Index of the least significant set bit. value must be non-zero.
+	inline uint32_t find_first_set(uint64_t value) noexcept
+	{
+	#if defined(_MSC_VER)
+		unsigned long index = 0;
+		_BitScanForward64(&index, value);
+		return static_cast<uint32_t>(index);
+	#else
+		return static_cast<uint32_t>(__builtin_ctzll(value));
+	#endif
+	}
+
+}
+
+#endif // ARES_CORE_BITS_H
\ No newline at end of file
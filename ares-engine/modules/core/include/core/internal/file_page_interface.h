@@ -0,0 +1,23 @@
+#ifndef ARES_CORE_FILE_PAGE_INTERFACE_H
+#define ARES_CORE_FILE_PAGE_INTERFACE_H
+#include "core/platform.h"
+
+#if ARES_PLATFORM_WINDOWS
+#include "core/internal/platform/windows/win32_file_page_interface.h"
+#elif ARES_PLATFORM_UNIX
+#include "core/internal/platform/unix/unix_file_page_interface.h"
+#endif
+
+namespace ares::core::internal {
+
+#if ARES_PLATFORM_WINDOWS
+	using file_page_interface = win32_file_page_interface;
+#elif ARES_PLATFORM_UNIX
+	using file_page_interface = unix_file_page_interface;
+#else
+#error "Unsupported platform"
+#endif
+
+}
+
+#endif // ARES_CORE_FILE_PAGE_INTERFACE_H
\ No newline at end of file
@@ -1,20 +1,102 @@
 #ifndef ARES_CORE_OS_PAGE_INTERFACE_H
 #define ARES_CORE_OS_PAGE_INTERFACE_H
+#include <stddef.h>
+#include <stdint.h>
 
 namespace ares::core::internal {
 
+	enum class page_flags : uint32_t
+	{
+		none = 0,
+		// Back the range with large pages. Falls back to normal pages when the
+		// system has none to give.
+		large_pages = 1 << 0
+	};
+
+	inline constexpr page_flags operator|(page_flags lhs, page_flags rhs) { return static_cast<page_flags>(static_cast<uint32_t>(lhs) | static_cast<uint32_t>(rhs)); }
+	inline constexpr page_flags operator&(page_flags lhs, page_flags rhs) { return static_cast<page_flags>(static_cast<uint32_t>(lhs) & static_cast<uint32_t>(rhs)); }
+	inline constexpr bool has_flag(page_flags flags, page_flags flag) { return (flags & flag) == flag; }
+
+	enum class commit_flags : uint32_t
+	{
+		none = 0,
+		// Fault the pages in while committing instead of on first touch.
+		prefault = 1 << 0,
+		// Keep the pages resident. Best effort: it is skipped when the process
+		// lock limit doesn't allow it.
+		lock = 1 << 1
+	};
+
+	inline constexpr commit_flags operator|(commit_flags lhs, commit_flags rhs) { return static_cast<commit_flags>(static_cast<uint32_t>(lhs) | static_cast<uint32_t>(rhs)); }
+	inline constexpr commit_flags operator&(commit_flags lhs, commit_flags rhs) { return static_cast<commit_flags>(static_cast<uint32_t>(lhs) & static_cast<uint32_t>(rhs)); }
+	inline constexpr bool has_flag(commit_flags flags, commit_flags flag) { return (flags & flag) == flag; }
+
+	enum class file_open_mode : uint32_t
+	{
+		open_or_create,
+		open_existing,
+		// Truncates an existing file.
+		create
+	};
+
 	class os_page_interface
 	{
 	public:
 		virtual ~os_page_interface() = default;
 
 		virtual size_t page_size() const = 0;
+		// Commit granularity of the region holding address, which is larger than
+		// page_size() for large page regions.
+		virtual size_t page_size(const void* address) const { return page_size(); }
+		// Writes the supported large page sizes, smallest first, and returns how
+		// many there are.
+		virtual size_t large_page_sizes(size_t* sizes, size_t capacity) const { return 0; }
+
 		virtual void* reserve_memory(size_t size) = 0;
+		virtual void* reserve_memory(size_t size, page_flags flags) { return reserve_memory(size); }
 		virtual bool commit_memory(void* address, size_t size) = 0;
+		// Committing an already committed range is allowed and keeps its contents,
+		// so this can also prefault or lock memory that is in use.
+		virtual bool commit_memory(void* address, size_t size, commit_flags flags)
+		{
+			if (!commit_memory(address, size))
+			{
+				return false;
+			}
+			if (has_flag(flags, commit_flags::prefault))
+			{
+				touch_pages(address, size, page_size(address));
+			}
+			return true;
+		}
 		virtual bool decommit_memory(void* address, size_t size) = 0;
 		virtual bool release_memory(void* address, size_t size) = 0;
+
+	protected:
+		// Writes each page's first byte back to itself, which faults it in without
+		// changing what it holds.
+		static void touch_pages(void* address, size_t size, size_t page_size)
+		{
+			volatile char* p = static_cast<volatile char*>(address);
+			for (size_t offset = 0; offset < size; offset += page_size)
+			{
+				p[offset] = p[offset];
+			}
+		}
 	};
 
+	// Size that reservations made with these flags should be rounded up to.
+	inline size_t reserve_granularity(const os_page_interface& pages, page_flags flags)
+	{
+		size_t result = pages.page_size();
+		size_t large_size = 0;
+		if (has_flag(flags, page_flags::large_pages) && pages.large_page_sizes(&large_size, 1) > 0 && large_size > result)
+		{
+			result = large_size;
+		}
+		return result;
+	}
+
 	os_page_interface& get_os_page_interface();
 
 }
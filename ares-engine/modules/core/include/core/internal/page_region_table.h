@@ -0,0 +1,90 @@
+#ifndef ARES_CORE_PAGE_REGION_TABLE_H
+#define ARES_CORE_PAGE_REGION_TABLE_H
+#include <shared_mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include "core/atomic.h"
+
+namespace ares::core::internal {
+
+	// Reserved ranges that differ from the default page setup, looked up by address.
+	// Only large page regions are recorded, so the table stays small.
+	class page_region_table
+	{
+	public:
+		static constexpr size_t max_regions = 64;
+
+		struct region
+		{
+			uintptr_t base = 0;
+			size_t size = 0;
+			size_t page_size = 0;
+			uint32_t flags = 0;
+		};
+
+		inline bool insert(const void* base, size_t size, size_t page_size, uint32_t flags = 0)
+		{
+			std::unique_lock<std::shared_mutex> lock(mutex_);
+			size_t count = count_.load(memory_order_relaxed);
+			if (count == max_regions)
+			{
+				return false;
+			}
+
+			regions_[count] = { reinterpret_cast<uintptr_t>(base), size, page_size, flags };
+			count_.store(count + 1, memory_order_release);
+			return true;
+		}
+
+		inline bool find(const void* address, region& out) const
+		{
+			// Most processes never use large pages, so skip the lock when there are none.
+			if (count_.load(memory_order_acquire) == 0)
+			{
+				return false;
+			}
+
+			uintptr_t value = reinterpret_cast<uintptr_t>(address);
+			std::shared_lock<std::shared_mutex> lock(mutex_);
+			size_t count = count_.load(memory_order_relaxed);
+			for (size_t i = 0; i < count; i++)
+			{
+				if (value >= regions_[i].base && value - regions_[i].base < regions_[i].size)
+				{
+					out = regions_[i];
+					return true;
+				}
+			}
+			return false;
+		}
+
+		inline void erase(const void* base)
+		{
+			if (count_.load(memory_order_acquire) == 0)
+			{
+				return;
+			}
+
+			uintptr_t value = reinterpret_cast<uintptr_t>(base);
+			std::unique_lock<std::shared_mutex> lock(mutex_);
+			size_t count = count_.load(memory_order_relaxed);
+			for (size_t i = 0; i < count; i++)
+			{
+				if (regions_[i].base == value)
+				{
+					regions_[i] = regions_[count - 1];
+					count_.store(count - 1, memory_order_release);
+					return;
+				}
+			}
+		}
+
+	private:
+		mutable std::shared_mutex mutex_;
+		region regions_[max_regions];
+		atomic<size_t> count_{ 0 };
+	};
+
+}
+
+#endif // ARES_CORE_PAGE_REGION_TABLE_H
\ No newline at end of file
@@ -0,0 +1,48 @@
+#ifndef ARES_CORE_UNIX_FILE_PAGE_INTERFACE_H
+#define ARES_CORE_UNIX_FILE_PAGE_INTERFACE_H
+#include "core/core_api.h"
+#include "core/internal/os_page_interface.h"
+
+namespace ares::core::internal {
+
+	// Pages backed by a shared mapping of one file instead of anonymous memory.
+	// Reservations are carved out of the mapping in order, commits past the end of
+	// the file extend it, and decommitted pages keep their contents in the file.
+	class ARES_CORE_API unix_file_page_interface : public os_page_interface
+	{
+	public:
+		unix_file_page_interface();
+		~unix_file_page_interface() override;
+		unix_file_page_interface(const unix_file_page_interface&) = delete;
+		unix_file_page_interface& operator=(const unix_file_page_interface&) = delete;
+
+		// Maps capacity bytes of the file, or the whole file if it is larger. What
+		// the file already holds is committed right away.
+		bool open(const char* path, size_t capacity, file_open_mode mode);
+		void close();
+		// Writes dirty pages back and waits for them.
+		bool flush();
+
+		inline bool is_open() const { return base_ != nullptr; }
+		inline char* base() const { return base_; }
+		inline size_t capacity() const { return capacity_; }
+		inline size_t file_size() const { return file_size_; }
+
+		size_t page_size() const override;
+
+		void* reserve_memory(size_t size) override;
+		bool commit_memory(void* address, size_t size) override;
+		bool decommit_memory(void* address, size_t size) override;
+		bool release_memory(void* address, size_t size) override;
+
+	private:
+		int fd_ = -1;
+		char* base_ = nullptr;
+		size_t capacity_ = 0;
+		size_t file_size_ = 0;
+		size_t reserved_ = 0;
+	};
+
+}
+
+#endif // ARES_CORE_UNIX_FILE_PAGE_INTERFACE_H
\ No newline at end of file
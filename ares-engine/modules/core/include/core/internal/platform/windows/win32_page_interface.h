@@ -2,6 +2,7 @@
 #define ARES_CORE_WIN32_PAGE_INTERFACE_H
 #include "core/core_api.h"
 #include "core/internal/os_page_interface.h"
+#include "core/internal/page_region_table.h"
 
 namespace ares::core::internal {
 
@@ -11,10 +12,18 @@ namespace ares::core::internal {
 		win32_page_interface();
 
 		size_t page_size() const override;
+		size_t page_size(const void* address) const override;
+		size_t large_page_sizes(size_t* sizes, size_t capacity) const override;
+
 		void* reserve_memory(size_t size) override;
+		void* reserve_memory(size_t size, page_flags flags) override;
 		bool commit_memory(void* address, size_t size) override;
+		bool commit_memory(void* address, size_t size, commit_flags flags) override;
 		bool decommit_memory(void* address, size_t size) override;
 		bool release_memory(void* address, size_t size) override;
+
+	private:
+		page_region_table regions_;
 	};
 
 }
@@ -0,0 +1,28 @@
+#ifndef ARES_CORE_PREFETCH_H
+#define ARES_CORE_PREFETCH_H
+#include "core/platform.h"
+
+#if defined(_MSC_VER) && (defined(ARES_PROCESSOR_X86) || defined(ARES_PROCESSOR_X86_64))
+#include <xmmintrin.h>
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace ares::core::internal {
+
+	// Hints that address will be read soon. Never faults, so it may point past
+	// the end of an array.
+	inline void prefetch(const void* address) noexcept
+	{
+	#if defined(_MSC_VER) && (defined(ARES_PROCESSOR_X86) || defined(ARES_PROCESSOR_X86_64))
+		_mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+	#elif defined(_MSC_VER) && defined(ARES_PROCESSOR_ARM64)
+		__prefetch(address);
+	#elif defined(__GNUC__) || defined(__clang__)
+		__builtin_prefetch(address);
+	#endif
+	}
+
+}
+
+#endif // ARES_CORE_PREFETCH_H
\ No newline at end of file
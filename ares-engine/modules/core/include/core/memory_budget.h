@@ -0,0 +1,118 @@
+#ifndef ARES_CORE_MEMORY_BUDGET_H
+#define ARES_CORE_MEMORY_BUDGET_H
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include "core/core_api.h"
+#include "core/allocator.h"
+#include "core/atomic.h"
+
+namespace ares::core {
+
+	enum class memory_pressure : uint32_t
+	{
+		soft,   // usage crossed the soft limit
+		hard    // an allocation would cross the hard limit
+	};
+
+	// Memory limits for one subsystem. Usage is a single relaxed counter. Soft
+	// limit callbacks fire once when usage goes above the soft limit, and again
+	// only after usage has dropped below rearm_fraction of it. Charges that would
+	// cross the hard limit fire the callbacks with memory_pressure::hard, are
+	// retried once and then refused.
+	class ARES_CORE_API memory_budget
+	{
+	public:
+		using pressure_callback = void(*)(memory_budget& budget, memory_pressure pressure, void* user_data);
+
+		static constexpr size_t max_callbacks = 8;
+		static constexpr size_t max_name_length = 64;
+		static constexpr size_t unlimited = ~size_t(0);
+		static constexpr double rearm_fraction = 0.875;
+
+		memory_budget(const char* name, size_t soft_limit = unlimited, size_t hard_limit = unlimited);
+		memory_budget(const memory_budget&) = delete;
+		memory_budget& operator=(const memory_budget&) = delete;
+
+		// Returns false, with nothing charged, if the hard limit doesn't allow it.
+		bool charge(size_t size) noexcept;
+		void release(size_t size) noexcept;
+
+		// Returns false when all callback slots are taken.
+		bool add_callback(pressure_callback callback, void* user_data = nullptr);
+		void remove_callback(pressure_callback callback, void* user_data = nullptr);
+
+		void set_limits(size_t soft_limit, size_t hard_limit) noexcept;
+
+		inline const char* get_name() const noexcept { return name_; }
+		inline size_t used() const noexcept { return used_.load(memory_order_relaxed); }
+		inline size_t peak() const noexcept { return peak_.load(memory_order_relaxed); }
+		inline size_t soft_limit() const noexcept { return soft_limit_.load(memory_order_relaxed); }
+		inline size_t hard_limit() const noexcept { return hard_limit_.load(memory_order_relaxed); }
+		// Charges refused by the hard limit.
+		inline uint64_t failures() const noexcept { return failures_.load(memory_order_relaxed); }
+
+	private:
+		struct callback_entry
+		{
+			atomic<pressure_callback> function;
+			atomic<void*> user_data;
+		};
+
+		void notify(memory_pressure pressure) noexcept;
+		void update_peak(size_t used) noexcept;
+
+	private:
+		char name_[max_name_length] = {};
+		atomic<size_t> used_;
+		atomic<size_t> peak_;
+		atomic<size_t> soft_limit_;
+		atomic<size_t> hard_limit_;
+		atomic<size_t> rearm_level_;
+		atomic<bool> soft_armed_;
+		atomic<uint64_t> failures_;
+
+		std::mutex callbacks_mutex_;
+		callback_entry callbacks_[max_callbacks];
+	};
+
+	// Charges every allocation to a budget before passing it on. Each block gets
+	// a small header with its size so unsized frees are accounted exactly.
+	// Thread-safe if the backing allocator is.
+	class ARES_CORE_API budgeted_allocator final : public allocator
+	{
+	public:
+		budgeted_allocator(allocator* backing, memory_budget& budget);
+		// Looks the budget up with find_memory_budget(); it must be registered.
+		budgeted_allocator(allocator* backing, const char* budget_name);
+		budgeted_allocator(const budgeted_allocator&) = delete;
+		budgeted_allocator& operator=(const budgeted_allocator&) = delete;
+
+		using allocator::allocate;
+		using allocator::deallocate;
+
+		void* allocate(size_t size) override;
+		void* allocate(size_t size, size_t alignment) override;
+		void* allocate(size_t size, size_t alignment, size_t offset) override;
+		void deallocate(void* ptr) override;
+
+		inline memory_budget* get_budget() const noexcept { return budget_; }
+		inline allocator* get_backing_allocator() const noexcept { return backing_; }
+
+	private:
+		struct header;
+
+	private:
+		allocator* backing_ = nullptr;
+		memory_budget* budget_ = nullptr;
+	};
+
+	// Budgets by name, so allocators can find the budget matching their
+	// sys_allocator name. The registry doesn't own them.
+	ARES_CORE_API bool register_memory_budget(memory_budget* budget);
+	ARES_CORE_API void unregister_memory_budget(memory_budget* budget);
+	ARES_CORE_API memory_budget* find_memory_budget(const char* name);
+
+}
+
+#endif // ARES_CORE_MEMORY_BUDGET_H
\ No newline at end of file
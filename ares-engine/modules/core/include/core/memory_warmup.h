@@ -0,0 +1,59 @@
+#ifndef ARES_CORE_MEMORY_WARMUP_H
+#define ARES_CORE_MEMORY_WARMUP_H
+#include <thread>
+#include <stddef.h>
+#include <stdint.h>
+#include "core/core_api.h"
+#include "core/atomic.h"
+#include "core/internal/os_page_interface.h"
+
+namespace ares::core {
+
+	class temp_allocator;
+	class tlsf_allocator;
+
+	// Warms arenas on a worker thread at startup so the main loop doesn't take
+	// their first-touch page faults. The arenas must not be used until wait()
+	// returns.
+	class ARES_CORE_API memory_warmup
+	{
+	public:
+		using warm_function = bool(*)(void* target, size_t size, internal::commit_flags flags);
+
+		static constexpr size_t max_jobs = 32;
+
+		memory_warmup() = default;
+		~memory_warmup();
+		memory_warmup(const memory_warmup&) = delete;
+		memory_warmup& operator=(const memory_warmup&) = delete;
+
+		// Jobs can only be added before start(). Returns false when the list is full.
+		bool add(warm_function function, void* target, size_t size, internal::commit_flags flags = internal::commit_flags::prefault);
+		bool add(temp_allocator& arena, size_t size, internal::commit_flags flags = internal::commit_flags::prefault);
+		bool add(tlsf_allocator& heap, size_t size, internal::commit_flags flags = internal::commit_flags::prefault);
+
+		void start();
+		// Blocks until every job has run. Returns false if any of them failed.
+		bool wait();
+		inline bool finished() const noexcept { return finished_.load(memory_order_acquire); }
+
+	private:
+		struct job
+		{
+			warm_function function;
+			void* target;
+			size_t size;
+			internal::commit_flags flags;
+		};
+
+	private:
+		job jobs_[max_jobs] = {};
+		size_t job_count_ = 0;
+		std::thread thread_;
+		atomic<bool> finished_{ false };
+		bool succeeded_ = true;
+	};
+
+}
+
+#endif // ARES_CORE_MEMORY_WARMUP_H
\ No newline at end of file
@@ -0,0 +1,59 @@
+#ifndef ARES_CORE_OFFSET_PTR_H
+#define ARES_CORE_OFFSET_PTR_H
+#include <cstddef>
+#include <stdint.h>
+#include <EASTL/type_traits.h>
+
+namespace ares::core {
+
+	// Pointer stored as the distance from itself to its target, so a block of
+	// memory holding both can be mapped at any address and stay valid. Copying
+	// recomputes the distance; copying the bytes doesn't. A distance of 1 is
+	// reserved for null, so it can't point one byte past itself.
+	template <typename T>
+	class offset_ptr
+	{
+	public:
+		using element_type = T;
+
+		offset_ptr() noexcept = default;
+		offset_ptr(std::nullptr_t) noexcept {}
+		offset_ptr(T* ptr) noexcept { set(ptr); }
+		offset_ptr(const offset_ptr& other) noexcept { set(other.get()); }
+
+		inline offset_ptr& operator=(const offset_ptr& other) noexcept { set(other.get()); return *this; }
+		inline offset_ptr& operator=(T* ptr) noexcept { set(ptr); return *this; }
+		inline offset_ptr& operator=(std::nullptr_t) noexcept { offset_ = null_offset; return *this; }
+
+		inline T* get() const noexcept
+		{
+			return offset_ == null_offset ? nullptr : reinterpret_cast<T*>(reinterpret_cast<uintptr_t>(this) + static_cast<uintptr_t>(offset_));
+		}
+
+		template <typename U = T, typename = eastl::enable_if_t<!eastl::is_void_v<U>>>
+		inline U& operator*() const noexcept { return *get(); }
+		inline T* operator->() const noexcept { return get(); }
+		inline explicit operator bool() const noexcept { return offset_ != null_offset; }
+
+		inline bool operator==(const offset_ptr& other) const noexcept { return get() == other.get(); }
+		inline bool operator!=(const offset_ptr& other) const noexcept { return get() != other.get(); }
+		inline bool operator==(const T* ptr) const noexcept { return get() == ptr; }
+		inline bool operator!=(const T* ptr) const noexcept { return get() != ptr; }
+		inline bool operator==(std::nullptr_t) const noexcept { return offset_ == null_offset; }
+		inline bool operator!=(std::nullptr_t) const noexcept { return offset_ != null_offset; }
+
+	private:
+		static constexpr intptr_t null_offset = 1;
+
+		inline void set(T* ptr) noexcept
+		{
+			offset_ = ptr ? static_cast<intptr_t>(reinterpret_cast<uintptr_t>(ptr) - reinterpret_cast<uintptr_t>(this)) : null_offset;
+		}
+
+	private:
+		intptr_t offset_ = null_offset;
+	};
+
+}
+
+#endif // ARES_CORE_OFFSET_PTR_H
\ No newline at end of file
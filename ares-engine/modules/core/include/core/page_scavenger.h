@@ -0,0 +1,80 @@
+#ifndef ARES_CORE_PAGE_SCAVENGER_H
+#define ARES_CORE_PAGE_SCAVENGER_H
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <stddef.h>
+#include <stdint.h>
+#include "core/core_api.h"
+#include "core/internal/os_page_interface.h"
+
+namespace ares::core {
+
+	// Deferred decommit. Allocators retire committed ranges they stop using, and
+	// ranges still retired after the delay are decommitted by scavenge(), either
+	// from the background thread or by hand. An owner taking a range back calls
+	// reclaim() and only has to commit it again when that returns false.
+	class ARES_CORE_API page_scavenger
+	{
+	public:
+		static constexpr uint32_t default_delay_ms = 2000;
+		static constexpr size_t max_ranges = 1024;
+
+		page_scavenger(uint32_t delay_ms = default_delay_ms, internal::os_page_interface& pages = internal::get_os_page_interface());
+		~page_scavenger();
+		page_scavenger(const page_scavenger&) = delete;
+		page_scavenger& operator=(const page_scavenger&) = delete;
+
+		// With no room left the range is decommitted straight away.
+		void retire(void* address, size_t size);
+		// Takes back a range passed to retire(). Returns true if it is still committed.
+		bool reclaim(void* address, size_t size);
+		// Drops every retired range inside [address, address + size) without
+		// touching it. Owners call this before releasing their reservation.
+		void forget(const void* address, size_t size);
+
+		// Decommits the ranges retired at least min_age_ms ago and returns the number
+		// of bytes given back.
+		size_t scavenge(uint32_t min_age_ms);
+		inline size_t scavenge() { return scavenge(delay_ms_); }
+
+		// Runs scavenge() every interval_ms on a background thread. Without an
+		// interval half the delay is used.
+		void start(uint32_t interval_ms = 0);
+		void stop();
+
+		inline uint32_t delay_ms() const noexcept { return delay_ms_; }
+		size_t retired_bytes();
+		size_t released_bytes();
+
+	private:
+		struct range
+		{
+			char* address;
+			size_t size;
+			uint64_t retired_ms;
+		};
+
+		static uint64_t now_ms();
+
+	private:
+		internal::os_page_interface* pages_ = nullptr;
+		uint32_t delay_ms_ = 0;
+
+		std::mutex mutex_;
+		range ranges_[max_ranges] = {};
+		size_t range_count_ = 0;
+		size_t retired_bytes_ = 0;
+		size_t released_bytes_ = 0;
+
+		std::mutex thread_mutex_;
+		std::condition_variable thread_signal_;
+		std::thread thread_;
+		bool thread_stop_ = false;
+	};
+
+	page_scavenger& get_page_scavenger();
+
+}
+
+#endif // ARES_CORE_PAGE_SCAVENGER_H
\ No newline at end of file
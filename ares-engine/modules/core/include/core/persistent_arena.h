@@ -0,0 +1,83 @@
+#ifndef ARES_CORE_PERSISTENT_ARENA_H
+#define ARES_CORE_PERSISTENT_ARENA_H
+#include <stddef.h>
+#include <stdint.h>
+#include <EASTL/utility.h>
+#include "core/core_api.h"
+#include "core/allocator.h"
+#include "core/offset_ptr.h"
+#include "core/internal/file_page_interface.h"
+
+namespace ares::core {
+
+	// Linear arena living in a memory mapped file. Structures built in it with
+	// offset_ptr links can be saved by closing the arena and loaded again by
+	// opening it, without any parsing. Individual frees do nothing. Not
+	// thread-safe.
+	class ARES_CORE_API persistent_arena final : public allocator
+	{
+	public:
+		static constexpr size_t default_capacity = 1024ull * 1024 * 1024;
+		static constexpr size_t default_commit_size = 1024 * 1024;
+
+		persistent_arena();
+		// See open().
+		persistent_arena(const char* path, uint64_t schema, size_t capacity = default_capacity, internal::file_open_mode mode = internal::file_open_mode::open_or_create);
+		~persistent_arena() override;
+		persistent_arena(const persistent_arena&) = delete;
+		persistent_arena& operator=(const persistent_arena&) = delete;
+
+		// schema identifies the layout of what is stored; an existing file made
+		// with another schema, or one whose writer never closed it, is refused.
+		// The caller rebuilds in that case, typically by reopening with
+		// file_open_mode::create.
+		bool open(const char* path, uint64_t schema, size_t capacity = default_capacity, internal::file_open_mode mode = internal::file_open_mode::open_or_create);
+		// Marks the file as complete, flushes it and unmaps it.
+		void close();
+		// Writes everything to disk without closing.
+		bool flush();
+
+		using allocator::allocate;
+		using allocator::deallocate;
+
+		void* allocate(size_t size) override;
+		void* allocate(size_t size, size_t alignment) override;
+		void* allocate(size_t size, size_t alignment, size_t offset) override;
+		void deallocate(void* ptr) override {}
+
+		template <typename T, typename... Args>
+		T* create(Args&&... args)
+		{
+			void* mem = allocate(sizeof(T), alignof(T));
+			return mem ? new (mem) T(eastl::forward<Args>(args)...) : nullptr;
+		}
+
+		// The entry point to what is stored, kept in the file header.
+		void set_root(void* root) noexcept;
+		void* root() const noexcept;
+		template <typename T>
+		inline T* root() const noexcept { return static_cast<T*>(root()); }
+
+		inline bool is_open() const noexcept { return header_ != nullptr; }
+		// True when open() found an existing arena instead of starting an empty one.
+		inline bool loaded() const noexcept { return loaded_; }
+		size_t used() const noexcept;
+		inline size_t committed() const noexcept { return committed_; }
+		inline size_t capacity() const noexcept { return file_.capacity(); }
+
+	private:
+		struct header;
+
+		bool grow(size_t required) noexcept;
+
+	private:
+		internal::file_page_interface file_;
+		header* header_ = nullptr;
+		char* base_ = nullptr;
+		size_t committed_ = 0;
+		bool loaded_ = false;
+	};
+
+}
+
+#endif // ARES_CORE_PERSISTENT_ARENA_H
\ No newline at end of file
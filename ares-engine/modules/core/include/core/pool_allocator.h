@@ -0,0 +1,179 @@
+#ifndef ARES_CORE_POOL_ALLOCATOR_H
+#define ARES_CORE_POOL_ALLOCATOR_H
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "core/core_api.h"
+#include "core/allocator.h"
+#include "core/platform.h"
+#include "core/internal/os_page_interface.h"
+
+namespace ares::core {
+
+	class page_scavenger;
+
+	// Fixed-size block allocator. Blocks are carved out of slabs that are committed
+	// from a single reserved range, so consecutive allocations are laid out
+	// contiguously. Each slab keeps its own intrusive free list. Not thread-safe.
+	class ARES_CORE_API pool_allocator final : public allocator
+	{
+	public:
+		static constexpr size_t default_reserve_size = 1ull * 1024 * 1024 * 1024;
+		static constexpr size_t default_slab_size = 64 * 1024;
+
+		pool_allocator(
+			size_t block_size,
+			size_t block_alignment = ARES_PLATFORM_MIN_MALLOC_ALIGNMENT,
+			size_t reserve_size = default_reserve_size,
+			size_t slab_size = default_slab_size,
+			internal::os_page_interface& pages = internal::get_os_page_interface()
+		);
+		~pool_allocator() override;
+		pool_allocator(const pool_allocator&) = delete;
+		pool_allocator& operator=(const pool_allocator&) = delete;
+
+		using allocator::allocate;
+		using allocator::deallocate;
+
+		void* allocate(size_t size) override;
+		void* allocate(size_t size, size_t alignment) override;
+		void deallocate(void* ptr) override;
+
+		bool owns(const void* ptr) const noexcept;
+
+		inline size_t block_size() const noexcept { return block_size_; }
+		inline size_t block_alignment() const noexcept { return block_alignment_; }
+		inline size_t blocks_per_slab() const noexcept { return blocks_per_slab_; }
+		inline size_t slab_count() const noexcept { return slab_count_; }
+		inline size_t live_blocks() const noexcept { return live_blocks_; }
+
+		// With a scavenger, slabs that empty out while another empty slab is
+		// already on hand have their block pages retired to it.
+		void set_scavenger(page_scavenger* scavenger) noexcept;
+		inline page_scavenger* scavenger() const noexcept { return scavenger_; }
+
+	private:
+		struct free_block
+		{
+			free_block* next;
+		};
+
+		struct slab_header
+		{
+			free_block* free_list;
+			slab_header* next_partial;
+			uint32_t live;
+			uint32_t carved;
+			bool in_partial_list;
+			bool retired;
+		};
+
+		slab_header* new_slab() noexcept;
+		bool take_empty_slab(slab_header* slab) noexcept;
+		void release_empty_slab(slab_header* slab) noexcept;
+		inline char* slab_retire_begin(slab_header* slab) const noexcept;
+		inline slab_header* slab_of(const void* ptr) const noexcept;
+		inline char* slab_blocks(slab_header* slab) const noexcept { return reinterpret_cast<char*>(slab) + header_size_; }
+
+	private:
+		internal::os_page_interface* pages_ = nullptr;
+		page_scavenger* scavenger_ = nullptr;
+		char* base_ = nullptr;
+		size_t reserved_ = 0;
+		size_t slab_size_ = 0;
+		size_t block_size_ = 0;
+		size_t block_alignment_ = 0;
+		size_t header_size_ = 0;
+		size_t blocks_per_slab_ = 0;
+		size_t slab_count_ = 0;
+		size_t live_blocks_ = 0;
+		size_t empty_slabs_ = 0;   // empty slabs that aren't retired
+		slab_header* partial_ = nullptr;
+	};
+
+	// The allocation paths live here so statically dispatched callers can inline
+	// them; only slab creation goes out of line.
+	inline void* pool_allocator::allocate(size_t size)
+	{
+		return allocate(size, block_alignment_);
+	}
+
+	inline void* pool_allocator::allocate(size_t size, size_t alignment)
+	{
+		assert(size <= block_size_ && "Allocation is larger than the pool's block size!");
+		assert(alignment <= block_alignment_ && "Allocation alignment exceeds the pool's block alignment!");
+		if (size > block_size_ || alignment > block_alignment_)
+		{
+			return nullptr;
+		}
+
+		slab_header* slab = partial_;
+		if (!slab)
+		{
+			slab = new_slab();
+			if (!slab) return nullptr;
+		}
+		if (slab->live == 0 && !take_empty_slab(slab))
+		{
+			return nullptr;
+		}
+
+		void* result = nullptr;
+		if (slab->free_list)
+		{
+			result = slab->free_list;
+			slab->free_list = slab->free_list->next;
+		}
+		else
+		{
+			result = slab_blocks(slab) + static_cast<size_t>(slab->carved) * block_size_;
+			slab->carved++;
+		}
+
+		slab->live++;
+		live_blocks_++;
+
+		if (!slab->free_list && slab->carved == blocks_per_slab_)
+		{
+			partial_ = slab->next_partial;
+			slab->next_partial = nullptr;
+			slab->in_partial_list = false;
+		}
+
+		return result;
+	}
+
+	inline void pool_allocator::deallocate(void* ptr)
+	{
+		if (!ptr) return;
+		assert(owns(ptr) && "Pointer does not belong to this pool!");
+
+		slab_header* slab = slab_of(ptr);
+		free_block* block = static_cast<free_block*>(ptr);
+		block->next = slab->free_list;
+		slab->free_list = block;
+		slab->live--;
+		live_blocks_--;
+
+		if (slab->live == 0)
+		{
+			release_empty_slab(slab);
+		}
+
+		if (!slab->in_partial_list)
+		{
+			slab->next_partial = partial_;
+			slab->in_partial_list = true;
+			partial_ = slab;
+		}
+	}
+
+	inline pool_allocator::slab_header* pool_allocator::slab_of(const void* ptr) const noexcept
+	{
+		size_t offset = static_cast<size_t>(static_cast<const char*>(ptr) - base_);
+		return reinterpret_cast<slab_header*>(base_ + (offset / slab_size_) * slab_size_);
+	}
+
+}
+
+#endif // ARES_CORE_POOL_ALLOCATOR_H
\ No newline at end of file
@@ -0,0 +1,123 @@
+#ifndef ARES_CORE_STACK_ALLOCATOR_H
+#define ARES_CORE_STACK_ALLOCATOR_H
+#include <stddef.h>
+#include <stdint.h>
+#include "core/core_api.h"
+#include "core/allocator.h"
+#include "core/internal/os_page_interface.h"
+
+namespace ares::core {
+
+	// LIFO scratch arena. Memory is reserved up front and committed on demand;
+	// allocations are released by rewinding to a marker, usually through a scope.
+	// A freed allocation is given back once everything above it has been freed
+	// too, so growing containers reclaim their old buffers. Every allocation has
+	// a small header for this, in every build. Inside a scope, a block from
+	// before the scope is only given back once the scope ends, so the scope's
+	// marker stays valid. Not thread-safe; each thread gets its own instance from
+	// get_thread_stack_allocator().
+	//
+	// Debug builds grow the header to catch frees of memory that a rewind
+	// already released, and scopes that end out of order.
+	class ARES_CORE_API stack_allocator final : public allocator
+	{
+	public:
+		static constexpr size_t default_reserve_size = 64ull * 1024 * 1024;
+		static constexpr size_t default_commit_size = 64 * 1024;
+
+		using marker = size_t;
+
+		// Rewinds the stack to where it was when the scope began.
+		class scope
+		{
+		public:
+			explicit scope(stack_allocator& stack) noexcept : stack_(stack), marker_(stack.get_marker()), outer_floor_(stack.floor_)
+			{
+				stack_.floor_ = marker_;
+			}
+			~scope()
+			{
+				assert(stack_.floor_ == marker_ && "Scopes must end in reverse order!");
+				stack_.floor_ = outer_floor_;
+				stack_.rewind(marker_);
+			}
+			scope(const scope&) = delete;
+			scope& operator=(const scope&) = delete;
+
+			inline stack_allocator& get_stack() const noexcept { return stack_; }
+
+		private:
+			stack_allocator& stack_;
+			marker marker_;
+			marker outer_floor_;
+		};
+
+		stack_allocator(
+			size_t reserve_size = default_reserve_size,
+			internal::os_page_interface& pages = internal::get_os_page_interface()
+		);
+		~stack_allocator() override;
+		stack_allocator(const stack_allocator&) = delete;
+		stack_allocator& operator=(const stack_allocator&) = delete;
+
+		using allocator::allocate;
+		using allocator::deallocate;
+
+		void* allocate(size_t size) override;
+		void* allocate(size_t size, size_t alignment) override;
+		void* allocate(size_t size, size_t alignment, size_t offset) override;
+		void deallocate(void* ptr) override;
+
+		inline marker get_marker() const noexcept { return offset_; }
+		// A marker that frees have already dropped below leaves the stack as is.
+		void rewind(marker position) noexcept;
+
+		inline size_t used() const noexcept { return offset_; }
+		inline size_t committed() const noexcept { return committed_; }
+		inline size_t reserved() const noexcept { return reserved_; }
+		// Highest used(), headers included. Debug headers are larger, so debug
+		// builds read somewhat higher than release for the same allocations.
+		inline size_t high_water() const noexcept { return high_water_; }
+
+	private:
+		static constexpr size_t no_allocation = ~size_t(0);
+
+		struct header
+		{
+			size_t previous_offset;   // offset_ before the allocation, freed_flag once freed
+			size_t previous_top;      // header offset of the allocation below
+		#if ARES_BUILD_DEBUG
+			static constexpr uint32_t live_magic = 0x57ACA11Cu;
+			static constexpr uint32_t dead_magic = 0xDEADA11Cu;
+
+			uint32_t magic;
+			uint32_t padding;
+		#endif
+		};
+
+		// Offsets stay below the reservation, so their top bit is free.
+		static constexpr size_t freed_flag = ~(~size_t(0) >> 1);
+
+		header read_header(size_t header_offset) const noexcept;
+		void write_header(size_t header_offset, const header& value) noexcept;
+		void pop_freed() noexcept;
+
+		bool grow(size_t required) noexcept;
+
+	private:
+		internal::os_page_interface* pages_ = nullptr;
+		char* base_ = nullptr;
+		size_t reserved_ = 0;
+		size_t committed_ = 0;
+		size_t offset_ = 0;
+		size_t high_water_ = 0;
+		size_t top_ = no_allocation;   // header offset of the last allocation
+		size_t floor_ = 0;             // marker of the innermost scope
+	};
+
+	// The calling thread's stack, created on first use.
+	stack_allocator& get_thread_stack_allocator();
+
+}
+
+#endif // ARES_CORE_STACK_ALLOCATOR_H
\ No newline at end of file
@@ -1,21 +1,42 @@
 #ifndef ARES_CORE_SYS_ALLOCATOR_H
 #define ARES_CORE_SYS_ALLOCATOR_H
+#include <assert.h>
 #include <EASTL/type_traits.h>
 #include <EASTL/utility.h>
+#include "core/allocation_tags.h"
+#include "core/allocation_telemetry.h"
 #include "core/allocator.h"
 #include "core/allocator_manager.h"
+#include "core/guarded_allocator.h"
+#include "core/platform.h"
 
 namespace ares::core {
 
+	// Dispatch policies for sys_allocator. static_dispatch calls T's members
+	// directly so they can be inlined. It needs an explicitly passed instance
+	// that is a T, which debug builds assert.
+	// virtual_dispatch goes through the allocator vtable and accepts any instance,
+	// for allocators selected at runtime. Instances resolved from a registry slot
+	// always use it, since a slot can be re-registered with any allocator.
+	struct static_dispatch {};
+	struct virtual_dispatch {};
+
 	template <typename T>
+	using default_dispatch = eastl::conditional_t<eastl::is_final_v<T> && !has_allocator_slot_v<T>, static_dispatch, virtual_dispatch>;
+
+	template <typename T, typename dispatch = default_dispatch<T>>
 	class sys_allocator
 	{
 	private:
 		static_assert(eastl::is_base_of<allocator, T>::value, "Allocator must derive from 'allocator'!");
+		static_assert(eastl::is_same_v<dispatch, static_dispatch> || eastl::is_same_v<dispatch, virtual_dispatch>, "Invalid dispatch policy!");
+		static constexpr bool is_static = eastl::is_same_v<dispatch, static_dispatch>;
 	public:
+		using dispatch_type = dispatch;
+
 		sys_allocator(
 			const char* name = EASTL_NAME_VAL(EASTL_ALLOCATOR_DEFAULT_NAME),
-			allocator* alloc = get_allocator<T>()
+			allocator* alloc = nullptr
 		);
 		sys_allocator(allocator* alloc);
 		sys_allocator(const sys_allocator& other);
@@ -24,64 +45,205 @@ namespace ares::core {
 		sys_allocator& operator=(sys_allocator&& other) noexcept;
 		~sys_allocator() = default;
 
-		inline void* allocate(size_t size, int flags = 0) { return allocator_->allocate(size); }
-		inline void* allocate(size_t size, size_t alignment, size_t offset = 0, int flags = 0) { return allocator_->allocate(size, alignment); }
-		inline void deallocate(void* ptr, size_t size = 0) { allocator_->deallocate(ptr); }
+		inline void* allocate(size_t size, int flags = 0)
+		{
+			void* result = allocate_guarded(size, ARES_PLATFORM_MIN_MALLOC_ALIGNMENT, 0);
+			if (!result)
+			{
+				if constexpr (is_static) result = static_cast<T*>(allocator_)->T::allocate(size);
+				else result = allocator_->allocate(size);
+			}
+			record_allocate(result, size);
+			return result;
+		}
+		inline void* allocate(size_t size, size_t alignment, size_t offset = 0, int flags = 0)
+		{
+			void* result = allocate_guarded(size, alignment, offset);
+			if (!result)
+			{
+				if constexpr (is_static) result = offset == 0 ? static_cast<T*>(allocator_)->T::allocate(size, alignment) : static_cast<T*>(allocator_)->T::allocate(size, alignment, offset);
+				else result = allocator_->allocate(size, alignment, offset);
+			}
+			record_allocate(result, size);
+			return result;
+		}
+		inline void deallocate(void* ptr)
+		{
+			record_deallocate(ptr, 0);
+			if (deallocate_guarded(ptr)) return;
+			if constexpr (is_static) static_cast<T*>(allocator_)->T::deallocate(ptr);
+			else allocator_->deallocate(ptr);
+		}
+		inline void deallocate(void* ptr, size_t size)
+		{
+			record_deallocate(ptr, size);
+			if (deallocate_guarded(ptr)) return;
+			if constexpr (is_static) static_cast<T*>(allocator_)->T::deallocate(ptr, size);
+			else allocator_->deallocate(ptr, size);
+		}
+		inline void deallocate(void* ptr, size_t size, size_t alignment)
+		{
+			record_deallocate(ptr, size);
+			if (deallocate_guarded(ptr)) return;
+			if constexpr (is_static) static_cast<T*>(allocator_)->T::deallocate(ptr, size, alignment);
+			else allocator_->deallocate(ptr, size, alignment);
+		}
+
+		inline const char* get_name() const { return name_; }
+		inline void set_name(const char* name)
+		{
+			name_ = name;
+		#if ARES_ALLOCATION_TELEMETRY || ARES_GUARDED_ALLOCATIONS
+			tag_ = get_allocation_tags().intern(name);
+		#endif
+		}
+		inline allocator* get_backing_allocator() const { return allocator_; }
+	private:
+		// Sampled allocations of this sys_allocator's name go to the guarded
+		// allocator; once any name is sampled, frees check its range first.
+		inline void* allocate_guarded(size_t size, size_t alignment, size_t offset)
+		{
+		#if ARES_GUARDED_ALLOCATIONS
+			uint32_t rate = get_guard_selection().sample_rate(tag_);
+			if (rate && guarded_allocator::should_sample(rate))
+			{
+				return get_guarded_allocator().allocate_guarded(size, alignment, offset);
+			}
+		#endif
+			return nullptr;
+		}
+		inline bool deallocate_guarded(void* ptr)
+		{
+		#if ARES_GUARDED_ALLOCATIONS
+			if (!get_guard_selection().active())
+			{
+				return false;
+			}
+
+			guarded_allocator& guarded = get_guarded_allocator();
+			if (guarded.owns(ptr))
+			{
+				guarded.deallocate_guarded(ptr);
+				return true;
+			}
+		#endif
+			return false;
+		}
+		inline void resolve(allocator* alloc)
+		{
+			if constexpr (is_static)
+			{
+				assert(alloc && "static_dispatch requires an explicit instance!");
+				assert(dynamic_cast<T*>(alloc) && "static_dispatch requires the backing allocator to be a T!");
+			}
+			else if constexpr (has_allocator_slot_v<T>)
+			{
+				if (!alloc)
+				{
+					alloc = get_allocator<T>();
+				}
+			}
+			assert(alloc && "Allocator type has no registry slot, an instance must be provided!");
+			allocator_ = alloc;
+		}
+		inline void record_allocate(void* ptr, size_t size)
+		{
+		#if ARES_ALLOCATION_TELEMETRY
+			if (ptr) get_allocation_telemetry().record_allocate(tag_, size);
+		#endif
+		}
+		inline void record_deallocate(void* ptr, size_t size)
+		{
+		#if ARES_ALLOCATION_TELEMETRY
+			if (ptr) get_allocation_telemetry().record_deallocate(tag_, size);
+		#endif
+		}
 	private:
 		const char* name_;
 		allocator* allocator_;
+	#if ARES_ALLOCATION_TELEMETRY || ARES_GUARDED_ALLOCATIONS
+		allocation_tags::tag tag_ = allocation_tags::other_tag;
+	#endif
 	};
 
-	template <typename T>
-	sys_allocator<T>::sys_allocator(const char* name, allocator* alloc)
-		: name_(name), allocator_(alloc)
+	template <typename T, typename dispatch>
+	sys_allocator<T, dispatch>::sys_allocator(const char* name, allocator* alloc)
+		: name_(name)
 	{
+		resolve(alloc);
+	#if ARES_ALLOCATION_TELEMETRY || ARES_GUARDED_ALLOCATIONS
+		tag_ = get_allocation_tags().intern(name_);
+	#endif
 	}
 
-	template <typename T>
-	sys_allocator<T>::sys_allocator(allocator* alloc)
-		: name_(EASTL_NAME_VAL(EASTL_ALLOCATOR_DEFAULT_NAME)), allocator_(alloc)
+	template <typename T, typename dispatch>
+	sys_allocator<T, dispatch>::sys_allocator(allocator* alloc)
+		: name_(EASTL_NAME_VAL(EASTL_ALLOCATOR_DEFAULT_NAME))
 	{
-		if (!alloc)
-		{
-			allocator_ = get_allocator<T>();
-		}
+		resolve(alloc);
+	#if ARES_ALLOCATION_TELEMETRY || ARES_GUARDED_ALLOCATIONS
+		tag_ = get_allocation_tags().intern(name_);
+	#endif
 	}
 
-	template <typename T>
-	sys_allocator<T>::sys_allocator(const sys_allocator& other)
+	template <typename T, typename dispatch>
+	sys_allocator<T, dispatch>::sys_allocator(const sys_allocator& other)
 		: name_(other.name_), allocator_(other.allocator_)
 	{
+	#if ARES_ALLOCATION_TELEMETRY || ARES_GUARDED_ALLOCATIONS
+		tag_ = other.tag_;
+	#endif
 	}
 
-	template <typename T>
-	sys_allocator<T>& sys_allocator<T>::operator=(const sys_allocator& other)
+	template <typename T, typename dispatch>
+	sys_allocator<T, dispatch>& sys_allocator<T, dispatch>::operator=(const sys_allocator& other)
 	{
 		if (this != &other)
 		{
 			name_ = other.name_;
 			allocator_ = other.allocator_;
+		#if ARES_ALLOCATION_TELEMETRY || ARES_GUARDED_ALLOCATIONS
+			tag_ = other.tag_;
+		#endif
 		}
 		return *this;
 	}
 
-	template <typename T>
-	sys_allocator<T>::sys_allocator(sys_allocator&& other) noexcept
+	template <typename T, typename dispatch>
+	sys_allocator<T, dispatch>::sys_allocator(sys_allocator&& other) noexcept
 		: name_(eastl::exchange(other.name_, nullptr)), allocator_(eastl::exchange(other.allocator_, nullptr))
 	{
+	#if ARES_ALLOCATION_TELEMETRY || ARES_GUARDED_ALLOCATIONS
+		tag_ = other.tag_;
+	#endif
 	}
 
-	template <typename T>
-	sys_allocator<T>& sys_allocator<T>::operator=(sys_allocator&& other) noexcept
+	template <typename T, typename dispatch>
+	sys_allocator<T, dispatch>& sys_allocator<T, dispatch>::operator=(sys_allocator&& other) noexcept
 	{
 		if (this != &other)
 		{
 			name_ = eastl::exchange(other.name_, nullptr);
 			allocator_ = eastl::exchange(other.allocator_, nullptr);
+		#if ARES_ALLOCATION_TELEMETRY || ARES_GUARDED_ALLOCATIONS
+			tag_ = other.tag_;
+		#endif
 		}
 		return *this;
 	}
 
+	template <typename T, typename dispatch>
+	inline bool operator==(const sys_allocator<T, dispatch>& lhs, const sys_allocator<T, dispatch>& rhs)
+	{
+		return lhs.get_backing_allocator() == rhs.get_backing_allocator();
+	}
+
+	template <typename T, typename dispatch>
+	inline bool operator!=(const sys_allocator<T, dispatch>& lhs, const sys_allocator<T, dispatch>& rhs)
+	{
+		return lhs.get_backing_allocator() != rhs.get_backing_allocator();
+	}
+
 }
 
 #endif // ARES_CORE_SYS_ALLOCATOR_H
\ No newline at end of file
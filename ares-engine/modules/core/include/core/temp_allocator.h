@@ -1,18 +1,91 @@
 #ifndef ARES_CORE_TEMP_ALLOCATOR_H
 #define ARES_CORE_TEMP_ALLOCATOR_H
-#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "core/core_api.h"
 #include "core/allocator.h"
+#include "core/allocator_manager.h"
+#include "core/internal/os_page_interface.h"
 
 namespace ares::core {
 
-	class temp_allocator : public allocator
+	class page_scavenger;
+
+	// Linear frame arena. Memory is reserved up front, committed on demand and
+	// released all at once by reset() at the end of the frame. Not thread-safe.
+	class ARES_CORE_API temp_allocator final : public allocator
 	{
 	public:
-		temp_allocator() {}
+		static constexpr allocator_slot slot = allocator_slot::temp;
+		static constexpr size_t default_reserve_size = 256ull * 1024 * 1024;
+		static constexpr size_t default_commit_size = 64 * 1024;
+
+		// decommit_after_frames: number of consecutive frames that leave the committed
+		// tail untouched before that tail is handed back to the OS (0 disables it).
+		// page_flags::large_pages rounds the reservation up to the large page size
+		// and commits in large pages when the system provides them.
+		temp_allocator(
+			size_t reserve_size = default_reserve_size,
+			uint32_t decommit_after_frames = 0,
+			internal::page_flags flags = internal::page_flags::none,
+			internal::os_page_interface& pages = internal::get_os_page_interface()
+		);
+		~temp_allocator() override;
+		temp_allocator(const temp_allocator&) = delete;
+		temp_allocator& operator=(const temp_allocator&) = delete;
+
+		using allocator::allocate;
+		using allocator::deallocate;
+
+		void* allocate(size_t size) override;
+		void* allocate(size_t size, size_t alignment) override;
+		void* allocate(size_t size, size_t alignment, size_t offset) override;
+		void deallocate(void* ptr) override {}
+		// Freeing the most recent allocation gives its bytes back to the frame.
+		void deallocate(void* ptr, size_t size) override;
+
+		void reset() noexcept;
+
+		inline size_t used() const noexcept { return offset_; }
+		inline size_t committed() const noexcept { return committed_; }
+		inline size_t reserved() const noexcept { return reserved_; }
+		inline size_t page_size() const noexcept { return page_size_; }
+		inline size_t high_water() const noexcept { return high_water_; }
+		inline uint32_t decommit_after_frames() const noexcept { return decommit_after_frames_; }
+		inline void set_decommit_after_frames(uint32_t frames) noexcept { decommit_after_frames_ = frames; quiet_frames_ = 0; }
+		// With a scavenger the unused tail is retired to it instead of decommitted,
+		// and only goes back to the OS if the arena doesn't grow into it in time.
+		void set_scavenger(page_scavenger* scavenger) noexcept;
+		inline page_scavenger* scavenger() const noexcept { return scavenger_; }
+
+		// Flags for every commit the arena makes from now on.
+		inline void set_commit_flags(internal::commit_flags flags) noexcept { commit_flags_ = flags; }
+		inline internal::commit_flags commit_flags() const noexcept { return commit_flags_; }
+		// Commits the first size bytes up front and faults them in, so the frames
+		// that later reach them don't pay for it. Not thread-safe with allocation:
+		// run it before the arena is used, on whichever thread.
+		bool warm(size_t size, internal::commit_flags flags = internal::commit_flags::prefault) noexcept;
+
+	private:
+		bool grow(size_t required) noexcept;
+		void trim(size_t keep) noexcept;
+		bool reclaim_tail() noexcept;
 
-		void* allocate(size_t size) override { return malloc(size); }
-		void* allocate(size_t size, size_t alignment) override { return malloc(size); }
-		void deallocate(void* ptr) override { free(ptr); }
+	private:
+		internal::os_page_interface* pages_ = nullptr;
+		page_scavenger* scavenger_ = nullptr;
+		internal::commit_flags commit_flags_ = internal::commit_flags::none;
+		char* base_ = nullptr;
+		size_t reserved_ = 0;
+		size_t page_size_ = 0;
+		size_t committed_ = 0;
+		size_t retired_end_ = 0;   // [committed_, retired_end_) is with the scavenger
+		size_t offset_ = 0;
+		size_t frame_peak_ = 0;
+		size_t high_water_ = 0;
+		size_t window_peak_ = 0;
+		uint32_t decommit_after_frames_ = 0;
+		uint32_t quiet_frames_ = 0;
 	};
 
 	temp_allocator& get_temp_allocator();
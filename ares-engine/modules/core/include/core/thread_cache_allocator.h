@@ -0,0 +1,121 @@
+#ifndef ARES_CORE_THREAD_CACHE_ALLOCATOR_H
+#define ARES_CORE_THREAD_CACHE_ALLOCATOR_H
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include "core/core_api.h"
+#include "core/allocator.h"
+#include "core/allocator_manager.h"
+#include "core/internal/os_page_interface.h"
+
+namespace ares::core {
+
+	class page_scavenger;
+
+	// General purpose allocator with per-thread caches and size-class bins.
+	//
+	// Small blocks live in spans carved from one reserved range. Each span belongs to
+	// the thread that allocated from it: that thread allocates and frees without
+	// atomics, while frees from other threads are pushed onto the span's lock-free
+	// remote list and reclaimed by the owner later. Blocks above max_small_size map
+	// their own pages. Threads that exit hand their spans to the next thread that
+	// needs one of the same size class. Empty spans go back to a pool of unit runs
+	// that merges neighbours and splits to fit, so memory freed by one mix of size
+	// classes serves any other.
+	class ARES_CORE_API thread_cache_allocator final : public allocator
+	{
+	public:
+		static constexpr allocator_slot slot = allocator_slot::thread_cache;
+		static constexpr size_t default_reserve_size = 16ull * 1024 * 1024 * 1024;
+		static constexpr size_t span_unit_size = 64 * 1024;
+		static constexpr size_t max_small_size = 256 * 1024;
+		static constexpr size_t max_small_alignment = 4096;
+		static constexpr size_t class_count = 52;
+		static constexpr size_t max_instances = 64;
+		// Largest span, for the class with max_small_size blocks.
+		static constexpr size_t max_span_units = 33;
+
+		thread_cache_allocator(
+			size_t reserve_size = default_reserve_size,
+			internal::os_page_interface& pages = internal::get_os_page_interface()
+		);
+		~thread_cache_allocator() override;
+		thread_cache_allocator(const thread_cache_allocator&) = delete;
+		thread_cache_allocator& operator=(const thread_cache_allocator&) = delete;
+
+		using allocator::allocate;
+		using allocator::deallocate;
+
+		void* allocate(size_t size) override;
+		void* allocate(size_t size, size_t alignment) override;
+		void deallocate(void* ptr) override;
+
+		// Hands the calling thread's spans back to the shared pool. This runs
+		// automatically when a thread exits.
+		void flush_thread_cache();
+
+		// With a scavenger, units of empty spans are retired to it and go back to
+		// the OS if no span needs them in time. Set it before the allocator is used.
+		void set_scavenger(page_scavenger* scavenger) noexcept;
+		inline page_scavenger* scavenger() const noexcept { return scavenger_; }
+
+		static size_t size_class_of(size_t size) noexcept;
+		static size_t size_of_class(size_t size_class) noexcept;
+
+	private:
+		struct free_block;
+		struct span;
+		struct thread_cache;
+		struct thread_cache_table;
+		struct unit_run;
+
+		static constexpr uint32_t no_run = ~0u;
+
+		static thread_cache_table& local_caches();
+		thread_cache* local_cache() const;
+		thread_cache* get_thread_cache();
+		void abandon_thread_cache(thread_cache* cache);
+
+		void* allocate_small(size_t size_class);
+		void* allocate_slow(thread_cache* cache, size_t size_class);
+		void* allocate_large(size_t size, size_t alignment);
+		void deallocate_small(span* owner_span, void* ptr);
+		void deallocate_large(void* ptr);
+
+		span* acquire_span(thread_cache* cache, size_t size_class);
+		void release_span(span* target);  // mutex_ must be held
+		// Free unit runs, binned by length. mutex_ must be held.
+		void free_units(uint32_t first, uint32_t count);
+		uint32_t take_units(uint32_t count);
+		void insert_run(uint32_t first, uint32_t length);
+		void remove_run(uint32_t first);
+		bool reclaim_units(uint32_t first, uint32_t count);
+		void collect_remote_frees(span* target);
+		void reclaim_full_spans(thread_cache* cache, size_t size_class);
+
+		inline bool owns_small(const void* ptr) const noexcept;
+
+	private:
+		internal::os_page_interface* pages_ = nullptr;
+		char* reserve_base_ = nullptr;
+		size_t reserve_size_ = 0;
+		char* base_ = nullptr;
+		size_t unit_count_ = 0;
+		size_t next_unit_ = 0;
+		span** span_map_ = nullptr;      // null for free units below next_unit_
+		unit_run* runs_ = nullptr;       // follows span_map_ in the same pages
+		size_t span_map_size_ = 0;
+		uint32_t instance_ = max_instances;
+		uint64_t generation_ = 0;
+		page_scavenger* scavenger_ = nullptr;
+
+		std::mutex mutex_;
+		uint32_t free_runs_[max_span_units + 1] = {};
+		span* abandoned_[class_count] = {};
+		thread_cache* free_caches_ = nullptr;
+		thread_cache* all_caches_ = nullptr;
+	};
+
+}
+
+#endif // ARES_CORE_THREAD_CACHE_ALLOCATOR_H
\ No newline at end of file
@@ -0,0 +1,94 @@
+#ifndef ARES_CORE_TLSF_ALLOCATOR_H
+#define ARES_CORE_TLSF_ALLOCATOR_H
+#include <stddef.h>
+#include <stdint.h>
+#include "core/core_api.h"
+#include "core/allocator.h"
+#include "core/internal/os_page_interface.h"
+
+namespace ares::core {
+
+	// Two-level segregated fit allocator. Allocation and deallocation are O(1):
+	// free blocks are binned by a first level (power of two) and a second level
+	// (sl_count linear steps within it), and both levels are found through bitmaps.
+	// Blocks are carved from one reserved range that is committed in grow_size steps.
+	// Not thread-safe.
+	class ARES_CORE_API tlsf_allocator final : public allocator
+	{
+	public:
+		static constexpr size_t default_reserve_size = 1024ull * 1024 * 1024;
+		static constexpr size_t default_grow_size = 1024 * 1024;
+
+		tlsf_allocator(
+			size_t reserve_size = default_reserve_size,
+			size_t grow_size = default_grow_size,
+			internal::page_flags flags = internal::page_flags::none,
+			internal::os_page_interface& pages = internal::get_os_page_interface()
+		);
+		~tlsf_allocator() override;
+		tlsf_allocator(const tlsf_allocator&) = delete;
+		tlsf_allocator& operator=(const tlsf_allocator&) = delete;
+
+		using allocator::allocate;
+		using allocator::deallocate;
+
+		void* allocate(size_t size) override;
+		void* allocate(size_t size, size_t alignment) override;
+		void deallocate(void* ptr) override;
+
+		bool owns(const void* ptr) const noexcept;
+		// Usable size of a live allocation.
+		size_t block_size(const void* ptr) const noexcept;
+
+		inline size_t used() const noexcept { return used_; }
+		inline size_t committed() const noexcept { return committed_; }
+
+		// Flags for every commit the heap makes from now on.
+		inline void set_commit_flags(internal::commit_flags flags) noexcept { commit_flags_ = flags; }
+		inline internal::commit_flags commit_flags() const noexcept { return commit_flags_; }
+		// Grows the heap to at least size bytes and faults it in. Not thread-safe
+		// with allocation: run it before the heap is used, on whichever thread.
+		bool warm(size_t size, internal::commit_flags flags = internal::commit_flags::prefault) noexcept;
+		inline size_t reserved() const noexcept { return reserved_; }
+
+	private:
+		static constexpr uint32_t align_log2 = 4;
+		static constexpr uint32_t sl_log2 = 5;
+		static constexpr uint32_t sl_count = 1u << sl_log2;
+		static constexpr uint32_t fl_shift = sl_log2 + align_log2;
+		static constexpr uint32_t fl_count = 32;
+		static constexpr size_t small_block_size = size_t(1) << fl_shift;
+		static constexpr size_t block_alignment = size_t(1) << align_log2;
+
+		struct block_header;
+
+		static void mapping_insert(size_t size, uint32_t& fl, uint32_t& sl) noexcept;
+		static void mapping_search(size_t size, uint32_t& fl, uint32_t& sl) noexcept;
+
+		void insert_free(block_header* block) noexcept;
+		void remove_free(block_header* block) noexcept;
+		block_header* locate_free(size_t size) noexcept;
+		block_header* trim_front(block_header* block, size_t alignment) noexcept;
+		void split(block_header* block, size_t size) noexcept;
+		block_header* merge(block_header* block) noexcept;
+		bool grow(size_t size) noexcept;
+
+	private:
+		internal::os_page_interface* pages_ = nullptr;
+		char* base_ = nullptr;
+		size_t reserved_ = 0;
+		size_t committed_ = 0;
+		size_t grow_size_ = 0;
+		internal::commit_flags commit_flags_ = internal::commit_flags::none;
+		size_t page_size_ = 0;
+		size_t used_ = 0;
+		block_header* sentinel_ = nullptr;
+
+		uint32_t fl_bitmap_ = 0;
+		uint32_t sl_bitmap_[fl_count] = {};
+		block_header* free_lists_[fl_count][sl_count] = {};
+	};
+
+}
+
+#endif // ARES_CORE_TLSF_ALLOCATOR_H
\ No newline at end of file
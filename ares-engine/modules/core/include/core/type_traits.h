@@ -4,8 +4,7 @@
 
 namespace ares::core {
 
-	// This forward declaration is temporary!
-	class allocator_base;
+	class allocator;
 
 	template <typename T, typename = void>
 	struct is_ares_allocator : eastl::false_type{};
@@ -13,15 +12,26 @@ namespace ares::core {
 	template <typename T>
 	struct is_ares_allocator<T, eastl::void_t<
 		decltype(eastl::declval<T&>().allocate(eastl::declval<size_t>())),
-		decltype(eastl::declval<T&>().allocate(eastl::declval<size_t>(),
-			eastl::declval<size_t>(),
-			eastl::declval<size_t>())),
-		decltype(eastl::declval<T&>().deallocate(eastl::declval<void*>()))>
-	> : eastl::is_base_of<allocator_base, T> {};
+		decltype(eastl::declval<T&>().allocate(eastl::declval<size_t>(), eastl::declval<size_t>())),
+		decltype(eastl::declval<T&>().allocate(eastl::declval<size_t>(), eastl::declval<size_t>(), eastl::declval<size_t>())),
+		decltype(eastl::declval<T&>().deallocate(eastl::declval<void*>())),
+		decltype(eastl::declval<T&>().deallocate(eastl::declval<void*>(), eastl::declval<size_t>())),
+		decltype(eastl::declval<T&>().deallocate(eastl::declval<void*>(), eastl::declval<size_t>(), eastl::declval<size_t>()))>
+	> : eastl::is_base_of<allocator, T> {};
 
 	template <typename T>
 	inline constexpr bool is_ares_allocator_v = is_ares_allocator<T>::value;
 
+	// Allocators that only hand out blocks of one size, such as pool_allocator.
+	template <typename T, typename = void>
+	struct is_fixed_size_allocator : eastl::false_type{};
+
+	template <typename T>
+	struct is_fixed_size_allocator<T, eastl::void_t<decltype(eastl::declval<const T&>().block_size())>> : eastl::true_type{};
+
+	template <typename T>
+	inline constexpr bool is_fixed_size_allocator_v = is_fixed_size_allocator<T>::value;
+
 	template <typename T>
 	struct is_nothrow_swappable : eastl::bool_constant<eastl::is_nothrow_move_constructible_v<T> && eastl::is_nothrow_move_assignable_v<T>>
 	{
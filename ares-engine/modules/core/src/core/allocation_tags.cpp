@@ -0,0 +1,58 @@
+#include <ares_core_pch.h>
+#include "core/allocation_tags.h"
+#include <string.h>
+
+namespace ares::core {
+
+	allocation_tags::allocation_tags()
+	{
+		count_.store(1, memory_order_relaxed);
+		strcpy(names_[other_tag], "<other>");
+	}
+
+	allocation_tags::tag allocation_tags::intern(const char* name)
+	{
+		if (!name) return other_tag;
+
+		// Tags are never removed, so the published prefix can be searched unlocked.
+		size_t count = count_.load(memory_order_acquire);
+		for (size_t i = 1; i < count; i++)
+		{
+			if (strncmp(names_[i], name, max_name_length - 1) == 0)
+			{
+				return static_cast<tag>(i);
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		count = count_.load(memory_order_relaxed);
+		for (size_t i = 1; i < count; i++)
+		{
+			if (strncmp(names_[i], name, max_name_length - 1) == 0)
+			{
+				return static_cast<tag>(i);
+			}
+		}
+
+		if (count == max_tags)
+		{
+			return other_tag;
+		}
+
+		strncpy(names_[count], name, max_name_length - 1);
+		count_.store(count + 1, memory_order_release);
+		return static_cast<tag>(count);
+	}
+
+	const char* allocation_tags::name_of(tag value) const noexcept
+	{
+		return value < count() ? names_[value] : names_[other_tag];
+	}
+
+	allocation_tags& get_allocation_tags()
+	{
+		static allocation_tags result;
+		return result;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,331 @@
+#include <ares_core_pch.h>
+#include "core/allocation_telemetry.h"
+
+#if ARES_ALLOCATION_TELEMETRY
+#include <chrono>
+#include <stdio.h>
+#include "core/internal/alignment.h"
+#include "core/internal/bits.h"
+
+namespace ares::core {
+
+	// Written only by the owning thread, so increments are a relaxed load and
+	// store rather than a locked read-modify-write.
+	struct allocation_telemetry::tag_counters
+	{
+		atomic<uint64_t> allocations;
+		atomic<uint64_t> deallocations;
+		atomic<uint64_t> unsized_deallocations;
+		atomic<uint64_t> allocated_bytes;
+		atomic<uint64_t> deallocated_bytes;
+		atomic<uint64_t> peak_bytes;   // highest allocated_bytes - deallocated_bytes
+		atomic<uint64_t> size_histogram[allocation_stats::size_bucket_count];
+	};
+
+	struct allocation_telemetry::thread_counters
+	{
+		tag_counters tags[max_tags];
+		thread_counters* next_all = nullptr;
+		thread_counters* next_free = nullptr;
+	};
+
+	struct allocation_telemetry::tag_sample
+	{
+		uint64_t allocations = 0;
+		uint64_t allocated_bytes = 0;
+		std::chrono::steady_clock::time_point time;
+	};
+
+	namespace {
+
+		// Ids are reused once an instance is destroyed; the generation tells a
+		// thread's counters for the old owner of an id from those for the new one.
+		atomic<uint64_t> next_generation{ 1 };
+		atomic<allocation_telemetry*> live_instances[allocation_telemetry::max_instances];
+
+		inline void add(atomic<uint64_t>& counter, uint64_t value) noexcept
+		{
+			counter.store(counter.load(memory_order_relaxed) + value, memory_order_relaxed);
+		}
+
+		inline size_t size_bucket(size_t size) noexcept
+		{
+			if (size <= 16) return 0;
+			size_t bucket = internal::find_last_set(size - 1) - 3;
+			return bucket < allocation_stats::size_bucket_count ? bucket : allocation_stats::size_bucket_count - 1;
+		}
+
+	}
+
+	// Hands a thread's counters back at thread exit so the next thread can reuse
+	// them. Their totals are kept.
+	struct allocation_telemetry::thread_counters_table
+	{
+		thread_counters* counters[max_instances] = {};
+		uint64_t generations[max_instances] = {};
+
+		~thread_counters_table()
+		{
+			for (uint32_t i = 0; i < max_instances; i++)
+			{
+				thread_counters* entry = counters[i];
+				counters[i] = nullptr;
+				if (!entry) continue;
+
+				allocation_telemetry* owner = live_instances[i].load(memory_order_acquire);
+				if (owner && owner->generation_ == generations[i])
+				{
+					owner->release_thread_counters(entry);
+				}
+			}
+		}
+	};
+
+	allocation_telemetry::allocation_telemetry(internal::os_page_interface& pages)
+		: pages_(&pages)
+	{
+		samples_ = new tag_sample[max_tags];
+		auto now = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < max_tags; i++)
+		{
+			samples_[i].time = now;
+		}
+
+		generation_ = next_generation.fetch_add(1, memory_order_relaxed);
+		for (uint32_t i = 0; i < max_instances; i++)
+		{
+			allocation_telemetry* expected = nullptr;
+			if (live_instances[i].compare_exchange_strong(expected, this))
+			{
+				instance_ = i;
+				break;
+			}
+		}
+		assert(instance_ < max_instances && "Too many live allocation_telemetry instances!");
+	}
+
+	allocation_telemetry::~allocation_telemetry()
+	{
+		stop_periodic_dump();
+
+		if (instance_ < max_instances)
+		{
+			live_instances[instance_].store(nullptr, memory_order_release);
+		}
+
+		size_t block_size = internal::align_up(sizeof(thread_counters), pages_->page_size());
+		for (thread_counters* counters = all_counters_; counters;)
+		{
+			thread_counters* next = counters->next_all;
+			pages_->release_memory(counters, block_size);
+			counters = next;
+		}
+
+		delete[] samples_;
+	}
+
+	void allocation_telemetry::record_allocate(tag value, size_t size) noexcept
+	{
+		thread_counters* counters = get_thread_counters();
+		if (!counters) return;
+
+		tag_counters& entry = counters->tags[value < max_tags ? value : other_tag];
+		add(entry.allocations, 1);
+		add(entry.size_histogram[size_bucket(size)], 1);
+
+		uint64_t allocated = entry.allocated_bytes.load(memory_order_relaxed) + size;
+		entry.allocated_bytes.store(allocated, memory_order_relaxed);
+		// Negative when this thread freed more than it allocated.
+		int64_t live = static_cast<int64_t>(allocated - entry.deallocated_bytes.load(memory_order_relaxed));
+		if (live > 0 && static_cast<uint64_t>(live) > entry.peak_bytes.load(memory_order_relaxed))
+		{
+			entry.peak_bytes.store(static_cast<uint64_t>(live), memory_order_relaxed);
+		}
+	}
+
+	void allocation_telemetry::record_deallocate(tag value, size_t size) noexcept
+	{
+		thread_counters* counters = get_thread_counters();
+		if (!counters) return;
+
+		tag_counters& entry = counters->tags[value < max_tags ? value : other_tag];
+		add(entry.deallocations, 1);
+		if (size)
+		{
+			add(entry.deallocated_bytes, size);
+		}
+		else
+		{
+			add(entry.unsized_deallocations, 1);
+		}
+	}
+
+	bool allocation_telemetry::query(tag value, allocation_stats& out)
+	{
+		if (value >= tag_count()) return false;
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		aggregate(value, out);
+		return true;
+	}
+
+	size_t allocation_telemetry::snapshot(allocation_stats* out, size_t capacity)
+	{
+		size_t count = tag_count();
+		if (count > capacity) count = capacity;
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		for (size_t i = 0; i < count; i++)
+		{
+			aggregate(static_cast<tag>(i), out[i]);
+		}
+		return count;
+	}
+
+	void allocation_telemetry::start_periodic_dump(uint32_t interval_ms, dump_function function, void* user_data)
+	{
+		stop_periodic_dump();
+		if (!function) function = &print_stats;
+
+		dump_stop_ = false;
+		dump_thread_ = std::thread([this, interval_ms, function, user_data]()
+		{
+			allocation_stats* stats = new allocation_stats[max_tags];
+			std::unique_lock<std::mutex> lock(dump_mutex_);
+			while (!dump_signal_.wait_for(lock, std::chrono::milliseconds(interval_ms), [this] { return dump_stop_; }))
+			{
+				size_t count = snapshot(stats, max_tags);
+				function(stats, count, user_data);
+			}
+			delete[] stats;
+		});
+	}
+
+	void allocation_telemetry::stop_periodic_dump()
+	{
+		if (!dump_thread_.joinable()) return;
+
+		{
+			std::lock_guard<std::mutex> lock(dump_mutex_);
+			dump_stop_ = true;
+		}
+		dump_signal_.notify_all();
+		dump_thread_.join();
+	}
+
+	void allocation_telemetry::print_stats(const allocation_stats* stats, size_t count, void* user_data)
+	{
+		FILE* stream = user_data ? static_cast<FILE*>(user_data) : stderr;
+		fprintf(stream, "%-32s %14s %14s %12s %14s\n", "tag", "live", "peak", "allocs/s", "bytes/s");
+		for (size_t i = 0; i < count; i++)
+		{
+			const allocation_stats& entry = stats[i];
+			if (entry.allocations == 0) continue;
+
+			fprintf(stream, "%-32s %14llu %14llu %12.0f %14.0f\n", entry.name,
+				static_cast<unsigned long long>(entry.live_bytes), static_cast<unsigned long long>(entry.peak_bytes),
+				entry.allocations_per_second, entry.bytes_per_second);
+		}
+		fflush(stream);
+	}
+
+	allocation_telemetry::thread_counters_table& allocation_telemetry::local_counters()
+	{
+		thread_local thread_counters_table table;
+		return table;
+	}
+
+	allocation_telemetry::thread_counters* allocation_telemetry::get_thread_counters() noexcept
+	{
+		if (instance_ >= max_instances) return nullptr;
+
+		// Counters left behind by an earlier instance with the same id were freed
+		// with it, so they don't count.
+		thread_counters_table& table = local_counters();
+		if (table.generations[instance_] == generation_ && table.counters[instance_])
+		{
+			return table.counters[instance_];
+		}
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		thread_counters* counters = free_counters_;
+		if (counters)
+		{
+			free_counters_ = counters->next_free;
+			counters->next_free = nullptr;
+		}
+		else
+		{
+			size_t block_size = internal::align_up(sizeof(thread_counters), pages_->page_size());
+			void* mem = pages_->reserve_memory(block_size);
+			if (!mem) return nullptr;
+			if (!pages_->commit_memory(mem, block_size))
+			{
+				pages_->release_memory(mem, block_size);
+				return nullptr;
+			}
+
+			counters = new (mem) thread_counters();
+			counters->next_all = all_counters_;
+			all_counters_ = counters;
+		}
+
+		table.counters[instance_] = counters;
+		table.generations[instance_] = generation_;
+		return counters;
+	}
+
+	void allocation_telemetry::release_thread_counters(thread_counters* counters)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		counters->next_free = free_counters_;
+		free_counters_ = counters;
+	}
+
+	void allocation_telemetry::aggregate(tag value, allocation_stats& out)
+	{
+		out = allocation_stats{};
+		out.name = name_of(value);
+
+		uint64_t deallocated_bytes = 0;
+		for (thread_counters* counters = all_counters_; counters; counters = counters->next_all)
+		{
+			const tag_counters& entry = counters->tags[value];
+			out.allocations += entry.allocations.load(memory_order_relaxed);
+			out.deallocations += entry.deallocations.load(memory_order_relaxed);
+			out.unsized_deallocations += entry.unsized_deallocations.load(memory_order_relaxed);
+			out.allocated_bytes += entry.allocated_bytes.load(memory_order_relaxed);
+			deallocated_bytes += entry.deallocated_bytes.load(memory_order_relaxed);
+			out.peak_bytes += entry.peak_bytes.load(memory_order_relaxed);
+			for (size_t bucket = 0; bucket < allocation_stats::size_bucket_count; bucket++)
+			{
+				out.size_histogram[bucket] += entry.size_histogram[bucket].load(memory_order_relaxed);
+			}
+		}
+
+		// Threads are read one after another, so a block freed on another thread
+		// can be seen before its allocation.
+		out.live_bytes = out.allocated_bytes > deallocated_bytes ? out.allocated_bytes - deallocated_bytes : 0;
+
+		if (out.peak_bytes < out.live_bytes)
+		{
+			out.peak_bytes = out.live_bytes;
+		}
+
+		tag_sample& sample = samples_[value];
+
+		auto now = std::chrono::steady_clock::now();
+		double seconds = std::chrono::duration<double>(now - sample.time).count();
+		if (seconds > 0.0)
+		{
+			out.allocations_per_second = static_cast<double>(out.allocations - sample.allocations) / seconds;
+			out.bytes_per_second = static_cast<double>(out.allocated_bytes - sample.allocated_bytes) / seconds;
+		}
+		sample.allocations = out.allocations;
+		sample.allocated_bytes = out.allocated_bytes;
+		sample.time = now;
+	}
+
+}
+
+#endif // ARES_ALLOCATION_TELEMETRY
\ No newline at end of file
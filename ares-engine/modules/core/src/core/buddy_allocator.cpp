@@ -0,0 +1,302 @@
+#include <ares_core_pch.h>
+#include "core/buddy_allocator.h"
+#include "core/internal/alignment.h"
+#include "core/internal/bits.h"
+
+namespace ares::core {
+
+	buddy_allocator::buddy_allocator(size_t reserve_size, size_t decommit_size, internal::os_page_interface& pages)
+		: pages_(&pages)
+	{
+		static_assert((min_block_size << max_order) == max_block_size, "Block sizes don't match the order count!");
+
+		for (uint32_t& head : free_heads_)
+		{
+			head = no_unit;
+		}
+		decommit_order_ = order_of(decommit_size);
+
+		// Blocks are aligned to their size, so the range is over-reserved by one top
+		// block and its start rounded up. The slack is never committed.
+		size_t usable = internal::align_up(reserve_size, max_block_size);
+		reservation_size_ = usable + max_block_size;
+		reservation_ = static_cast<char*>(pages_->reserve_memory(reservation_size_));
+		if (!reservation_)
+		{
+			reservation_size_ = 0;
+			return;
+		}
+		base_ = static_cast<char*>(internal::align_up(reservation_, max_block_size));
+
+		size_t count = usable / min_block_size;
+		units_size_ = internal::align_up(count * sizeof(unit), pages_->page_size());
+		void* table = pages_->reserve_memory(units_size_);
+		if (!table || !pages_->commit_memory(table, units_size_))
+		{
+			if (table) pages_->release_memory(table, units_size_);
+			pages_->release_memory(reservation_, reservation_size_);
+			reservation_ = nullptr;
+			base_ = nullptr;
+			reservation_size_ = 0;
+			units_size_ = 0;
+			return;
+		}
+
+		units_ = new (table) unit[count]();
+		unit_count_ = static_cast<uint32_t>(count);
+
+		// Push the top blocks in reverse so the lowest addresses are used first.
+		uint32_t top_units = 1u << max_order;
+		for (uint32_t index = unit_count_; index > 0;)
+		{
+			index -= top_units;
+			push_free(index, max_order);
+		}
+	}
+
+	buddy_allocator::~buddy_allocator()
+	{
+		if (units_)
+		{
+			pages_->release_memory(units_, units_size_);
+		}
+		if (reservation_)
+		{
+			pages_->release_memory(reservation_, reservation_size_);
+		}
+	}
+
+	void* buddy_allocator::allocate(size_t size)
+	{
+		return allocate(size, min_block_size);
+	}
+
+	void* buddy_allocator::allocate(size_t size, size_t alignment)
+	{
+		assert(internal::is_power_of_two(alignment) && "Alignment must be a power of two!");
+
+		// Blocks are aligned to their size, so a larger alignment just asks for a
+		// larger block.
+		size_t block = size > alignment ? size : alignment;
+		if (block > max_block_size || !units_)
+		{
+			return nullptr;
+		}
+
+		uint32_t order = order_of(block);
+		uint32_t available = free_mask_ >> order;
+		if (!available)
+		{
+			return nullptr;
+		}
+
+		uint32_t found = order + internal::find_first_set(available);
+		uint32_t index = free_heads_[found];
+		remove_free(index, found);
+
+		// Split down to the requested order; the upper halves go back as free blocks.
+		while (found > order)
+		{
+			found--;
+			push_free(index + (1u << found), found);
+		}
+
+		if (!commit_units(index, 1u << order))
+		{
+			release_block(index, order);
+			return nullptr;
+		}
+
+		unit& entry = units_[index];
+		entry.block_start = 1;
+		entry.free = 0;
+		entry.order = static_cast<uint8_t>(order);
+		entry.requested = static_cast<uint32_t>(size);
+		allocated_bytes_ += min_block_size << order;
+		requested_bytes_ += size;
+		return unit_address(index);
+	}
+
+	void buddy_allocator::deallocate(void* ptr)
+	{
+		if (!ptr) return;
+		assert(owns(ptr) && "Pointer does not belong to this allocator!");
+
+		uint32_t index = static_cast<uint32_t>((static_cast<char*>(ptr) - base_) / min_block_size);
+		unit& entry = units_[index];
+		assert(entry.block_start && !entry.free && "Pointer is not a live block!");
+
+		allocated_bytes_ -= min_block_size << entry.order;
+		requested_bytes_ -= entry.requested;
+		entry.requested = 0;
+		release_block(index, entry.order);
+	}
+
+	// Merges the block with its free buddies as far as possible and puts the
+	// result on its free list.
+	void buddy_allocator::release_block(uint32_t index, uint32_t order) noexcept
+	{
+		while (order < max_order)
+		{
+			uint32_t buddy = index ^ (1u << order);
+			const unit& other = units_[buddy];
+			if (!other.block_start || !other.free || other.order != order)
+			{
+				break;
+			}
+
+			remove_free(buddy, order);
+			units_[index > buddy ? index : buddy].block_start = 0;
+			index = index < buddy ? index : buddy;
+			order++;
+		}
+
+		push_free(index, order);
+		if (order >= decommit_order_)
+		{
+			decommit_units(index, 1u << order);
+		}
+	}
+
+	bool buddy_allocator::owns(const void* ptr) const noexcept
+	{
+		const char* p = static_cast<const char*>(ptr);
+		return p >= base_ && p < base_ + static_cast<size_t>(unit_count_) * min_block_size;
+	}
+
+	size_t buddy_allocator::block_size(const void* ptr) const noexcept
+	{
+		uint32_t index = static_cast<uint32_t>((static_cast<const char*>(ptr) - base_) / min_block_size);
+		return min_block_size << units_[index].order;
+	}
+
+	buddy_stats buddy_allocator::get_stats() const noexcept
+	{
+		buddy_stats stats;
+		stats.allocated_bytes = allocated_bytes_;
+		stats.requested_bytes = requested_bytes_;
+		stats.committed_bytes = committed();
+		for (uint32_t order = 0; order <= max_order; order++)
+		{
+			stats.free_blocks[order] = free_counts_[order];
+			stats.free_bytes += free_counts_[order] * (min_block_size << order);
+		}
+		if (free_mask_)
+		{
+			stats.largest_free_block = min_block_size << internal::find_last_set(free_mask_);
+		}
+
+		if (stats.allocated_bytes)
+		{
+			stats.internal_fragmentation = 1.0 - static_cast<double>(stats.requested_bytes) / static_cast<double>(stats.allocated_bytes);
+		}
+		if (stats.free_bytes)
+		{
+			stats.external_fragmentation = 1.0 - static_cast<double>(stats.largest_free_block) / static_cast<double>(stats.free_bytes);
+		}
+		return stats;
+	}
+
+	uint32_t buddy_allocator::order_of(size_t size) noexcept
+	{
+		if (size <= min_block_size)
+		{
+			return 0;
+		}
+		uint32_t order = internal::find_last_set(size - 1) + 1 - internal::find_last_set(min_block_size);
+		return order < max_order ? order : max_order;
+	}
+
+	void buddy_allocator::push_free(uint32_t index, uint32_t order) noexcept
+	{
+		unit& entry = units_[index];
+		entry.block_start = 1;
+		entry.free = 1;
+		entry.order = static_cast<uint8_t>(order);
+		entry.prev = no_unit;
+		entry.next = free_heads_[order];
+		if (entry.next != no_unit)
+		{
+			units_[entry.next].prev = index;
+		}
+		free_heads_[order] = index;
+		free_counts_[order]++;
+		free_mask_ |= 1u << order;
+	}
+
+	void buddy_allocator::remove_free(uint32_t index, uint32_t order) noexcept
+	{
+		unit& entry = units_[index];
+		if (entry.prev != no_unit) units_[entry.prev].next = entry.next;
+		else free_heads_[order] = entry.next;
+		if (entry.next != no_unit) units_[entry.next].prev = entry.prev;
+
+		entry.free = 0;
+		entry.next = no_unit;
+		entry.prev = no_unit;
+		if (--free_counts_[order] == 0)
+		{
+			free_mask_ &= ~(1u << order);
+		}
+	}
+
+	// Commits the uncommitted runs of units in [index, index + count).
+	bool buddy_allocator::commit_units(uint32_t index, uint32_t count) noexcept
+	{
+		uint32_t end = index + count;
+		for (uint32_t run = index; run < end;)
+		{
+			if (units_[run].committed)
+			{
+				run++;
+				continue;
+			}
+
+			uint32_t run_end = run + 1;
+			while (run_end < end && !units_[run_end].committed)
+			{
+				run_end++;
+			}
+			if (!pages_->commit_memory(unit_address(run), static_cast<size_t>(run_end - run) * min_block_size))
+			{
+				return false;
+			}
+			for (uint32_t i = run; i < run_end; i++)
+			{
+				units_[i].committed = 1;
+			}
+			committed_units_ += run_end - run;
+			run = run_end;
+		}
+		return true;
+	}
+
+	void buddy_allocator::decommit_units(uint32_t index, uint32_t count) noexcept
+	{
+		uint32_t end = index + count;
+		for (uint32_t run = index; run < end;)
+		{
+			if (!units_[run].committed)
+			{
+				run++;
+				continue;
+			}
+
+			uint32_t run_end = run + 1;
+			while (run_end < end && units_[run_end].committed)
+			{
+				run_end++;
+			}
+			if (pages_->decommit_memory(unit_address(run), static_cast<size_t>(run_end - run) * min_block_size))
+			{
+				for (uint32_t i = run; i < run_end; i++)
+				{
+					units_[i].committed = 0;
+				}
+				committed_units_ -= run_end - run;
+			}
+			run = run_end;
+		}
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,132 @@
+#include <ares_core_pch.h>
+#include "core/concurrent_bump_allocator.h"
+#include "core/internal/alignment.h"
+
+namespace ares::core {
+
+	namespace {
+
+		atomic<uint64_t> next_serial{ 1 };
+
+	}
+
+	concurrent_bump_allocator::concurrent_bump_allocator(size_t reserve_size, size_t chunk_size, internal::os_page_interface& pages)
+		: pages_(&pages)
+	{
+		cursor_.store(0, memory_order_relaxed);
+		epoch_.store(0, memory_order_relaxed);
+		commit_failed_.store(false, memory_order_relaxed);
+		serial_ = next_serial.fetch_add(1, memory_order_relaxed);
+
+		page_size_ = pages_->page_size();
+		chunk_size_ = internal::align_up(chunk_size, page_size_);
+		reserved_ = internal::align_up(reserve_size, chunk_size_);
+		base_ = static_cast<char*>(pages_->reserve_memory(reserved_));
+		if (!base_)
+		{
+			reserved_ = 0;
+		}
+	}
+
+	concurrent_bump_allocator::~concurrent_bump_allocator()
+	{
+		if (base_)
+		{
+			pages_->release_memory(base_, reserved_);
+		}
+	}
+
+	void* concurrent_bump_allocator::allocate(size_t size)
+	{
+		return allocate(size, ARES_PLATFORM_MIN_MALLOC_ALIGNMENT, 0);
+	}
+
+	void* concurrent_bump_allocator::allocate(size_t size, size_t alignment)
+	{
+		return allocate(size, alignment, 0);
+	}
+
+	void concurrent_bump_allocator::reset() noexcept
+	{
+		// Every claim of the ending epoch has finished committing by now, so the
+		// claimed prefix can be skipped from here on unless a commit failed in it.
+		size_t claimed = used();
+		if (claimed > committed_ && !commit_failed_.load(memory_order_relaxed))
+		{
+			committed_ = claimed;
+		}
+
+		commit_failed_.store(false, memory_order_relaxed);
+		cursor_.store(0, memory_order_relaxed);
+		epoch_.store(epoch_.load(memory_order_relaxed) + 1, memory_order_relaxed);
+	}
+
+	size_t concurrent_bump_allocator::used() const noexcept
+	{
+		size_t cursor = cursor_.load(memory_order_relaxed);
+		return cursor < reserved_ ? cursor : reserved_;
+	}
+
+	concurrent_bump_allocator::thread_chunk& concurrent_bump_allocator::local_chunk(uint64_t serial) noexcept
+	{
+		thread_local thread_chunk chunks[thread_chunk_slots] = {};
+		return chunks[serial % thread_chunk_slots];
+	}
+
+	void* concurrent_bump_allocator::allocate_slow(thread_chunk& chunk, uint64_t epoch, size_t size, size_t alignment, size_t offset) noexcept
+	{
+		assert(internal::is_power_of_two(alignment) && "Alignment must be a power of two!");
+
+		// Requests larger than the reservation fail here, before the sums below
+		// can wrap.
+		if (size > reserved_ || offset > reserved_ - size || alignment - 1 > reserved_ - size - offset)
+		{
+			return nullptr;
+		}
+
+		// Big requests would waste most of a chunk, so they claim their own range
+		// and leave the thread's chunk as it is.
+		size_t worst_case = size + offset + alignment - 1;
+		if (worst_case > chunk_size_ / 4)
+		{
+			char* range = claim(internal::align_up(worst_case, page_size_));
+			if (!range) return nullptr;
+			return static_cast<char*>(internal::align_up(range + offset, alignment)) - offset;
+		}
+
+		char* fresh = claim(chunk_size_);
+		if (!fresh) return nullptr;
+
+		char* start = static_cast<char*>(internal::align_up(fresh + offset, alignment)) - offset;
+		chunk.serial = serial_;
+		chunk.epoch = epoch;
+		chunk.cursor = start + size;
+		chunk.end = fresh + chunk_size_;
+		return start;
+	}
+
+	char* concurrent_bump_allocator::claim(size_t size) noexcept
+	{
+		size_t begin = cursor_.fetch_add(size, memory_order_relaxed);
+		if (!base_ || begin + size > reserved_)
+		{
+			// The cursor moved past what was committed; keep reset() from trusting it.
+			commit_failed_.store(true, memory_order_relaxed);
+			return nullptr;
+		}
+
+		// Ranges are disjoint, so each claimer commits its own without coordination.
+		size_t end = begin + size;
+		if (end > committed_)
+		{
+			size_t commit_begin = begin > committed_ ? begin : committed_;
+			if (!pages_->commit_memory(base_ + commit_begin, end - commit_begin))
+			{
+				commit_failed_.store(true, memory_order_relaxed);
+				return nullptr;
+			}
+		}
+		return base_ + begin;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,127 @@
+#include <ares_core_pch.h>
+#include "core/frame_allocator.h"
+#include "core/internal/alignment.h"
+
+namespace ares::core {
+
+	frame_allocator::frame_allocator(uint32_t buffer_count, size_t reserve_size, internal::os_page_interface& pages)
+		: pages_(&pages)
+	{
+		assert(buffer_count >= 2 && buffer_count <= max_buffers && "Buffer count must be between 2 and max_buffers!");
+		buffer_count_ = buffer_count < 2 ? 2 : buffer_count > max_buffers ? max_buffers : buffer_count;
+		buffer_size_ = internal::align_up(reserve_size, pages_->page_size());
+
+		// One reservation holds every buffer back to back.
+		base_ = static_cast<char*>(pages_->reserve_memory(buffer_size_ * buffer_count_));
+		if (!base_)
+		{
+			buffer_size_ = 0;
+		}
+
+		for (uint32_t i = 0; i < max_buffers; i++)
+		{
+			buffer& entry = buffers_[i];
+			entry.offset.store(0, memory_order_relaxed);
+			entry.committed.store(0, memory_order_relaxed);
+			entry.base = base_ && i < buffer_count_ ? base_ + i * buffer_size_ : nullptr;
+		}
+	}
+
+	frame_allocator::~frame_allocator()
+	{
+		if (base_)
+		{
+			pages_->release_memory(base_, buffer_size_ * buffer_count_);
+		}
+	}
+
+	void* frame_allocator::allocate(size_t size)
+	{
+		return allocate(size, ARES_PLATFORM_MIN_MALLOC_ALIGNMENT);
+	}
+
+	void* frame_allocator::allocate(size_t size, size_t alignment)
+	{
+		return allocate(size, alignment, 0);
+	}
+
+	void* frame_allocator::allocate(size_t size, size_t alignment, size_t offset)
+	{
+		assert(internal::is_power_of_two(alignment) && "Alignment must be a power of two!");
+
+		buffer& current = buffers_[current_];
+		uintptr_t base = reinterpret_cast<uintptr_t>(current.base);
+
+		size_t start = 0;
+		size_t end = 0;
+		size_t top = current.offset.load(memory_order_relaxed);
+		do
+		{
+			start = internal::align_up(base + top + offset, alignment) - offset - base;
+			end = start + size;
+			if (end > buffer_size_)
+			{
+				return nullptr;
+			}
+		} while (!current.offset.compare_exchange_weak(top, end, memory_order_relaxed));
+
+		if (end > current.committed.load(memory_order_acquire) && !grow(current, end))
+		{
+			return nullptr;
+		}
+
+		return current.base + start;
+	}
+
+	void frame_allocator::flip() noexcept
+	{
+		size_t used = buffers_[current_].offset.load(memory_order_relaxed);
+		if (used > high_water_)
+		{
+			high_water_ = used;
+		}
+
+		// The buffer coming up holds the oldest frame, which nobody reads anymore.
+		current_ = (current_ + 1) % buffer_count_;
+		buffers_[current_].offset.store(0, memory_order_relaxed);
+		frame_++;
+	}
+
+	size_t frame_allocator::committed() const noexcept
+	{
+		size_t result = 0;
+		for (uint32_t i = 0; i < buffer_count_; i++)
+		{
+			result += buffers_[i].committed.load(memory_order_relaxed);
+		}
+		return result;
+	}
+
+	bool frame_allocator::grow(buffer& target, size_t required) noexcept
+	{
+		std::lock_guard<std::mutex> lock(grow_mutex_);
+
+		// Another thread may have committed past this allocation while we waited.
+		size_t committed = target.committed.load(memory_order_relaxed);
+		if (required <= committed)
+		{
+			return true;
+		}
+
+		size_t new_committed = internal::align_up(required, default_commit_size);
+		new_committed = internal::align_up(new_committed, pages_->page_size());
+		if (new_committed > buffer_size_)
+		{
+			new_committed = buffer_size_;
+		}
+
+		if (!pages_->commit_memory(target.base + committed, new_committed - committed))
+		{
+			return false;
+		}
+
+		target.committed.store(new_committed, memory_order_release);
+		return true;
+	}
+
+}
\ No newline at end of file
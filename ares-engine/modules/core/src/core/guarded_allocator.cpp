@@ -0,0 +1,290 @@
+#include <ares_core_pch.h>
+#include "core/guarded_allocator.h"
+#include "core/internal/alignment.h"
+#include "core/internal/bits.h"
+#include <string.h>
+
+namespace ares::core {
+
+	// Sits right before the user pointer. A bad magic on free means the block
+	// was underrun or never came from here.
+	struct guarded_allocator::header
+	{
+		static constexpr uint32_t live_magic = 0x6A2D1E5Bu;
+		// Fills the alignment padding between the block and the guard page, which
+		// a small overflow can write without faulting.
+		static constexpr uint8_t tail_fill = 0xFD;
+
+		uint32_t slot;
+		uint32_t magic;
+		uint64_t size;
+	};
+
+	guarded_allocator::guarded_allocator(allocator* backing, uint32_t sample_rate, size_t quarantine_size, size_t reserve_size, internal::os_page_interface& pages)
+		: pages_(&pages), backing_(backing), quarantine_limit_(quarantine_size)
+	{
+		sample_rate_.store(sample_rate, memory_order_relaxed);
+		for (uint32_t& head : free_heads_)
+		{
+			head = no_slot;
+		}
+
+		page_size_ = pages_->page_size();
+		reserved_ = internal::align_up(reserve_size, page_size_);
+		page_count_ = static_cast<uint32_t>(reserved_ / page_size_);
+
+		// The metadata is committed whole but only the pages of slots in use are
+		// ever touched.
+		metadata_size_ = internal::align_up(static_cast<size_t>(page_count_) * (sizeof(uint32_t) + sizeof(uint8_t)), page_size_);
+		void* metadata = pages_->reserve_memory(metadata_size_);
+		base_ = static_cast<char*>(pages_->reserve_memory(reserved_));
+		if (!metadata || !base_ || !pages_->commit_memory(metadata, metadata_size_))
+		{
+			if (metadata) pages_->release_memory(metadata, metadata_size_);
+			if (base_) pages_->release_memory(base_, reserved_);
+			base_ = nullptr;
+			reserved_ = 0;
+			page_count_ = 0;
+			metadata_size_ = 0;
+			return;
+		}
+
+		links_ = static_cast<uint32_t*>(metadata);
+		orders_ = reinterpret_cast<uint8_t*>(links_ + page_count_);
+	}
+
+	guarded_allocator::~guarded_allocator()
+	{
+		if (base_)
+		{
+			pages_->release_memory(base_, reserved_);
+			pages_->release_memory(links_, metadata_size_);
+		}
+	}
+
+	void* guarded_allocator::allocate(size_t size)
+	{
+		return allocate(size, ARES_PLATFORM_MIN_MALLOC_ALIGNMENT, 0);
+	}
+
+	void* guarded_allocator::allocate(size_t size, size_t alignment)
+	{
+		return allocate(size, alignment, 0);
+	}
+
+	void* guarded_allocator::allocate(size_t size, size_t alignment, size_t offset)
+	{
+		if (!backing_)
+		{
+			return allocate_guarded(size, alignment, offset);
+		}
+
+		if (should_sample(sample_rate_.load(memory_order_relaxed)))
+		{
+			if (void* result = allocate_guarded(size, alignment, offset))
+			{
+				return result;
+			}
+		}
+		return backing_->allocate(size, alignment, offset);
+	}
+
+	void guarded_allocator::deallocate(void* ptr)
+	{
+		if (owns(ptr))
+		{
+			deallocate_guarded(ptr);
+		}
+		else if (backing_)
+		{
+			backing_->deallocate(ptr);
+		}
+	}
+
+	void* guarded_allocator::allocate_guarded(size_t size, size_t alignment, size_t offset)
+	{
+		assert(internal::is_power_of_two(alignment) && "Alignment must be a power of two!");
+		if (!base_)
+		{
+			return nullptr;
+		}
+
+		// Anything the largest slot cannot hold fails here, before needed can wrap.
+		size_t room = ((size_t(1) << max_order) - 1) * page_size_ - sizeof(header);
+		if (size > room || offset > room - size || alignment > room - size - offset)
+		{
+			return nullptr;
+		}
+
+		// Room for the block, its header and the alignment slack, plus the guard.
+		size_t needed = size + sizeof(header) + offset + alignment;
+		size_t slot_pages = (needed + page_size_ - 1) / page_size_ + 1;
+		uint32_t order = internal::find_last_set(slot_pages - 1) + 1;
+		if (order > max_order)
+		{
+			return nullptr;
+		}
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		uint32_t slot = take_slot(order);
+		if (slot == no_slot)
+		{
+			return nullptr;
+		}
+
+		char* start = base_ + static_cast<size_t>(slot) * page_size_;
+		size_t data_size = ((size_t(1) << order) - 1) * page_size_;
+		if (!pages_->commit_memory(start, data_size))
+		{
+			links_[slot] = free_heads_[order];
+			free_heads_[order] = slot;
+			return nullptr;
+		}
+
+		// End the block flush against the guard page.
+		uintptr_t guard = reinterpret_cast<uintptr_t>(start + data_size);
+		uintptr_t result = internal::align_down(guard - size + offset, alignment) - offset;
+
+		header entry{ slot, header::live_magic, size };
+		memcpy(reinterpret_cast<char*>(result) - sizeof(header), &entry, sizeof(header));
+		memset(reinterpret_cast<char*>(result + size), header::tail_fill, guard - result - size);
+		live_allocations_++;
+		return reinterpret_cast<void*>(result);
+	}
+
+	void guarded_allocator::deallocate_guarded(void* ptr)
+	{
+		if (!ptr) return;
+
+		// Reading the header of a block that was already freed faults here, at the
+		// second free, because its pages are decommitted.
+		header entry;
+		memcpy(&entry, static_cast<char*>(ptr) - sizeof(header), sizeof(header));
+		assert(entry.magic == header::live_magic && "Guarded allocation header is corrupt; the block was underrun or is not from this allocator!");
+		if (entry.magic != header::live_magic || entry.slot >= page_count_)
+		{
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		uint32_t slot = entry.slot;
+		uint32_t order = orders_[slot];
+		size_t data_size = ((size_t(1) << order) - 1) * page_size_;
+
+		const uint8_t* tail = static_cast<const uint8_t*>(ptr) + entry.size;
+		const uint8_t* guard = reinterpret_cast<const uint8_t*>(base_ + static_cast<size_t>(slot) * page_size_ + data_size);
+		for (; tail < guard; tail++)
+		{
+			assert(*tail == header::tail_fill && "Guarded allocation was overrun into its alignment padding!");
+		}
+
+		pages_->decommit_memory(base_ + static_cast<size_t>(slot) * page_size_, data_size);
+		live_allocations_--;
+
+		links_[slot] = no_slot;
+		if (quarantine_tail_ != no_slot) links_[quarantine_tail_] = slot;
+		else quarantine_head_ = slot;
+		quarantine_tail_ = slot;
+		quarantine_bytes_ += data_size;
+
+		release_quarantine();
+	}
+
+	bool guarded_allocator::should_sample(uint32_t rate) noexcept
+	{
+		if (rate <= 1)
+		{
+			return rate == 1;
+		}
+
+		// xorshift per thread, so sampling costs no shared writes and doesn't lock
+		// onto a periodic allocation pattern.
+		thread_local uint64_t state = 0;
+		if (!state)
+		{
+			state = reinterpret_cast<uintptr_t>(&state) | 1;
+		}
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		return state % rate == 0;
+	}
+
+	size_t guarded_allocator::live_allocations()
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		return live_allocations_;
+	}
+
+	size_t guarded_allocator::quarantined_bytes()
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		return quarantine_bytes_;
+	}
+
+	uint32_t guarded_allocator::take_slot(uint32_t order) noexcept
+	{
+		uint32_t slot = free_heads_[order];
+		if (slot != no_slot)
+		{
+			free_heads_[order] = links_[slot];
+			return slot;
+		}
+
+		uint32_t slot_pages = 1u << order;
+		size_t start = internal::align_up(static_cast<size_t>(next_page_), slot_pages);
+		if (start + slot_pages > page_count_)
+		{
+			return no_slot;
+		}
+
+		slot = static_cast<uint32_t>(start);
+		next_page_ = slot + slot_pages;
+		orders_[slot] = static_cast<uint8_t>(order);
+		return slot;
+	}
+
+	// Oldest slots leave the quarantine first and go back to their free lists,
+	// still decommitted.
+	void guarded_allocator::release_quarantine() noexcept
+	{
+		while (quarantine_bytes_ > quarantine_limit_ && quarantine_head_ != no_slot)
+		{
+			uint32_t slot = quarantine_head_;
+			uint32_t order = orders_[slot];
+			quarantine_head_ = links_[slot];
+			if (quarantine_head_ == no_slot)
+			{
+				quarantine_tail_ = no_slot;
+			}
+			quarantine_bytes_ -= ((size_t(1) << order) - 1) * page_size_;
+
+			links_[slot] = free_heads_[order];
+			free_heads_[order] = slot;
+		}
+	}
+
+	guard_selection::guard_selection()
+	{
+		for (atomic<uint32_t>& rate : rates_)
+		{
+			rate.store(0, memory_order_relaxed);
+		}
+		active_.store(false, memory_order_relaxed);
+	}
+
+	void guard_selection::set_sample_rate(const char* name, uint32_t rate)
+	{
+		if (rate)
+		{
+			active_.store(true, memory_order_relaxed);
+		}
+		rates_[get_allocation_tags().intern(name)].store(rate, memory_order_release);
+	}
+
+	uint32_t guard_selection::sample_rate(const char* name)
+	{
+		return sample_rate(get_allocation_tags().intern(name));
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,508 @@
+#include <ares_core_pch.h>
+#include "core/handle_heap.h"
+#include "core/internal/alignment.h"
+#include "core/internal/bits.h"
+#include <chrono>
+#include <string.h>
+
+namespace ares::core {
+
+	// Sizes and offsets are in granules of alignment bytes. The header takes the
+	// first granule of every block.
+	struct handle_heap::block_header
+	{
+		uint32_t size;
+		uint32_t prev_size;   // of the block right below, 0 for the first one
+		uint32_t handle;      // free_block for holes
+		uint32_t pins;
+	};
+
+	// Kept in the first payload granule of a hole.
+	struct handle_heap::free_links
+	{
+		uint32_t prev;
+		uint32_t next;
+	};
+
+	// Generations are odd while the handle is live and even while the slot is
+	// free, so stale handles never match. Free slots chain through block.
+	struct handle_heap::handle_entry
+	{
+		uint32_t block;
+		uint32_t generation;
+	};
+
+	namespace {
+
+		constexpr uint32_t min_block_granules = 2;
+
+		inline uint32_t bin_of(uint32_t granules) noexcept
+		{
+			return internal::find_last_set(granules);
+		}
+
+	}
+
+	handle_heap::handle_heap(size_t reserve_size, size_t max_handles, internal::os_page_interface& pages)
+		: pages_(&pages)
+	{
+		static_assert(sizeof(block_header) == alignment, "Block header must fill one granule!");
+		static_assert(sizeof(free_links) <= alignment, "Free links must fit in one granule!");
+
+		for (uint32_t& head : bins_)
+		{
+			head = no_block;
+		}
+
+		size_t granule_limit = static_cast<size_t>(no_block) * alignment;
+		reserve_size = reserve_size < granule_limit ? reserve_size : granule_limit;
+		max_handles_ = max_handles < no_block ? max_handles : no_block - 1;
+
+		reserved_ = internal::align_up(reserve_size, pages_->page_size());
+		base_ = static_cast<char*>(pages_->reserve_memory(reserved_));
+		handles_reserved_ = internal::align_up(max_handles_ * sizeof(handle_entry), pages_->page_size());
+		handles_ = static_cast<handle_entry*>(pages_->reserve_memory(handles_reserved_));
+		if (!base_ || !handles_)
+		{
+			if (base_) pages_->release_memory(base_, reserved_);
+			if (handles_) pages_->release_memory(handles_, handles_reserved_);
+			base_ = nullptr;
+			handles_ = nullptr;
+			reserved_ = 0;
+			handles_reserved_ = 0;
+			max_handles_ = 0;
+		}
+	}
+
+	handle_heap::~handle_heap()
+	{
+		if (base_)
+		{
+			pages_->release_memory(base_, reserved_);
+		}
+		if (handles_)
+		{
+			pages_->release_memory(handles_, handles_reserved_);
+		}
+	}
+
+	heap_handle handle_heap::allocate(size_t size) noexcept
+	{
+		if (!base_ || size > reserved_)
+		{
+			return heap_handle{};
+		}
+		if (free_handle_ == no_block && handle_count_ == max_handles_)
+		{
+			return heap_handle{};
+		}
+		if (free_handle_ == no_block && !grow_handles())
+		{
+			return heap_handle{};
+		}
+
+		uint32_t granules = static_cast<uint32_t>(1 + (size + alignment - 1) / alignment);
+		granules = granules < min_block_granules ? min_block_granules : granules;
+
+		uint32_t block = find_free(granules);
+		if (block != no_block)
+		{
+			remove_free(block);
+			split(block, granules);
+		}
+		else
+		{
+			block = top_;
+			if (!grow_top(granules))
+			{
+				return heap_handle{};
+			}
+		}
+
+		uint32_t index = free_handle_;
+		handle_entry& entry = handles_[index];
+		free_handle_ = entry.block;
+		entry.block = block;
+		entry.generation++;
+
+		block_header* header = block_at(block);
+		header->handle = index;
+		header->pins = 0;
+
+		live_blocks_++;
+		used_granules_ += header->size;
+		return heap_handle{ index, entry.generation };
+	}
+
+	void handle_heap::deallocate(heap_handle handle) noexcept
+	{
+		handle_entry* entry = entry_of(handle);
+		if (!entry)
+		{
+			assert(!handle && "Freeing a stale handle!");
+			return;
+		}
+
+		uint32_t block = entry->block;
+		block_header* header = block_at(block);
+		assert(header->pins == 0 && "Freeing a pinned block!");
+
+		live_blocks_--;
+		used_granules_ -= header->size;
+
+		entry->generation++;
+		entry->block = free_handle_;
+		free_handle_ = handle.index;
+
+		header->handle = free_block;
+		release_block(block);
+	}
+
+	bool handle_heap::valid(heap_handle handle) const noexcept
+	{
+		return entry_of(handle) != nullptr;
+	}
+
+	void* handle_heap::resolve(heap_handle handle) const noexcept
+	{
+		handle_entry* entry = entry_of(handle);
+		return entry ? base_ + (static_cast<size_t>(entry->block) + 1) * alignment : nullptr;
+	}
+
+	size_t handle_heap::size_of(heap_handle handle) const noexcept
+	{
+		handle_entry* entry = entry_of(handle);
+		return entry ? (static_cast<size_t>(block_at(entry->block)->size) - 1) * alignment : 0;
+	}
+
+	void handle_heap::pin(heap_handle handle) noexcept
+	{
+		if (handle_entry* entry = entry_of(handle))
+		{
+			block_at(entry->block)->pins++;
+		}
+	}
+
+	void handle_heap::unpin(heap_handle handle) noexcept
+	{
+		if (handle_entry* entry = entry_of(handle))
+		{
+			block_header* header = block_at(entry->block);
+			assert(header->pins > 0 && "Unpinning a block that isn't pinned!");
+			header->pins--;
+		}
+	}
+
+	bool handle_heap::compact(uint32_t budget_us) noexcept
+	{
+		using clock = std::chrono::steady_clock;
+		const clock::time_point deadline = clock::now() + std::chrono::microseconds(budget_us);
+
+		uint32_t cursor = compact_cursor_;
+		if (cursor == 0)
+		{
+			// Left over from the end of the previous pass.
+			while (trim(trim_step) && clock::now() < deadline)
+			{
+			}
+		}
+
+		uint32_t skipped = 0;
+		while (cursor < top_)
+		{
+			block_header* hole = block_at(cursor);
+			if (hole->handle != free_block)
+			{
+				cursor += hole->size;
+				// Walking past live blocks is cheap, but a large heap still needs the
+				// clock looked at now and then.
+				if ((++skipped & 1023) == 0 && clock::now() >= deadline)
+				{
+					compact_cursor_ = cursor;
+					return false;
+				}
+				continue;
+			}
+
+			// Holes are always merged with their neighbours, so the next block is live.
+			uint32_t hole_size = hole->size;
+			uint32_t next = cursor + hole_size;
+			block_header* moved = block_at(next);
+			if (moved->pins)
+			{
+				cursor = next + moved->size;
+				continue;
+			}
+
+			remove_free(cursor);
+			uint32_t hole_prev = hole->prev_size;
+			uint32_t moved_size = moved->size;
+			memmove(hole, moved, static_cast<size_t>(moved_size) * alignment);
+
+			moved = block_at(cursor);
+			moved->prev_size = hole_prev;
+			handles_[moved->handle].block = cursor;
+
+			// The hole now sits above the block it made room for.
+			uint32_t shifted = cursor + moved_size;
+			hole = block_at(shifted);
+			hole->size = hole_size;
+			hole->prev_size = moved_size;
+			hole->handle = free_block;
+			hole->pins = 0;
+			release_block(shifted);
+
+			cursor = shifted;
+			if (clock::now() >= deadline)
+			{
+				compact_cursor_ = cursor;
+				return false;
+			}
+		}
+
+		compact_cursor_ = 0;
+		while (clock::now() < deadline && trim(trim_step))
+		{
+		}
+		return true;
+	}
+
+	handle_heap_stats handle_heap::get_stats() const noexcept
+	{
+		handle_heap_stats result;
+		result.live_blocks = live_blocks_;
+		result.used_bytes = used_granules_ * alignment;
+		result.top = static_cast<size_t>(top_) * alignment;
+		result.committed_bytes = committed_;
+		result.reserved_bytes = reserved_;
+
+		for (uint32_t bin = 0; bin < bin_count; bin++)
+		{
+			for (uint32_t block = bins_[bin]; block != no_block; block = links_of(block)->next)
+			{
+				size_t size = static_cast<size_t>(block_at(block)->size) * alignment;
+				result.free_bytes += size;
+				if (size > result.largest_free_block)
+				{
+					result.largest_free_block = size;
+				}
+			}
+		}
+
+		if (result.free_bytes)
+		{
+			result.fragmentation = 1.0 - static_cast<double>(result.largest_free_block) / static_cast<double>(result.free_bytes);
+		}
+		return result;
+	}
+
+	handle_heap::block_header* handle_heap::block_at(uint32_t granule) const noexcept
+	{
+		return reinterpret_cast<block_header*>(base_ + static_cast<size_t>(granule) * alignment);
+	}
+
+	handle_heap::handle_entry* handle_heap::entry_of(heap_handle handle) const noexcept
+	{
+		if (handle.index >= handle_count_ || !(handle.generation & 1))
+		{
+			return nullptr;
+		}
+
+		handle_entry* entry = &handles_[handle.index];
+		return entry->generation == handle.generation ? entry : nullptr;
+	}
+
+	handle_heap::free_links* handle_heap::links_of(uint32_t granule) const noexcept
+	{
+		return reinterpret_cast<free_links*>(base_ + (static_cast<size_t>(granule) + 1) * alignment);
+	}
+
+	void handle_heap::insert_free(uint32_t granule) noexcept
+	{
+		uint32_t bin = bin_of(block_at(granule)->size);
+		free_links* links = links_of(granule);
+		links->prev = no_block;
+		links->next = bins_[bin];
+		if (bins_[bin] != no_block)
+		{
+			links_of(bins_[bin])->prev = granule;
+		}
+		bins_[bin] = granule;
+		bin_mask_ |= 1u << bin;
+	}
+
+	void handle_heap::remove_free(uint32_t granule) noexcept
+	{
+		uint32_t bin = bin_of(block_at(granule)->size);
+		free_links* links = links_of(granule);
+		if (links->prev != no_block)
+		{
+			links_of(links->prev)->next = links->next;
+		}
+		else
+		{
+			bins_[bin] = links->next;
+			if (bins_[bin] == no_block)
+			{
+				bin_mask_ &= ~(1u << bin);
+			}
+		}
+		if (links->next != no_block)
+		{
+			links_of(links->next)->prev = links->prev;
+		}
+	}
+
+	uint32_t handle_heap::find_free(uint32_t granules) noexcept
+	{
+		// Holes in the request's own bin may be too small, so that bin is searched;
+		// any hole in a higher bin fits.
+		uint32_t bin = bin_of(granules);
+		for (uint32_t block = bins_[bin]; block != no_block; block = links_of(block)->next)
+		{
+			if (block_at(block)->size >= granules)
+			{
+				return block;
+			}
+		}
+
+		uint64_t mask = static_cast<uint64_t>(bin_mask_) & ~((uint64_t(2) << bin) - 1);
+		return mask ? bins_[internal::find_first_set(mask)] : no_block;
+	}
+
+	void handle_heap::release_block(uint32_t granule) noexcept
+	{
+		block_header* header = block_at(granule);
+		if (header->prev_size)
+		{
+			uint32_t prev = granule - header->prev_size;
+			block_header* prev_header = block_at(prev);
+			if (prev_header->handle == free_block)
+			{
+				remove_free(prev);
+				prev_header->size += header->size;
+				granule = prev;
+				header = prev_header;
+			}
+		}
+
+		uint32_t next = granule + header->size;
+		if (next == top_)
+		{
+			top_ = granule;
+			last_size_ = header->prev_size;
+			rewind_cursor(granule, no_block);
+			return;
+		}
+
+		block_header* next_header = block_at(next);
+		if (next_header->handle == free_block)
+		{
+			remove_free(next);
+			header->size += next_header->size;
+			next = granule + header->size;
+		}
+		block_at(next)->prev_size = header->size;
+		insert_free(granule);
+		rewind_cursor(granule, next);
+	}
+
+	void handle_heap::rewind_cursor(uint32_t first, uint32_t last) noexcept
+	{
+		if (compact_cursor_ > first && compact_cursor_ < last)
+		{
+			compact_cursor_ = first;
+		}
+	}
+
+	void handle_heap::split(uint32_t granule, uint32_t granules) noexcept
+	{
+		block_header* header = block_at(granule);
+		uint32_t rest_size = header->size - granules;
+		if (rest_size < min_block_granules)
+		{
+			return;
+		}
+
+		// A hole never ends at the top, so the rest has a block above it.
+		rewind_cursor(granule, granule + header->size);
+		header->size = granules;
+		uint32_t rest = granule + granules;
+		block_header* rest_header = block_at(rest);
+		rest_header->size = rest_size;
+		rest_header->prev_size = granules;
+		rest_header->handle = free_block;
+		rest_header->pins = 0;
+		block_at(rest + rest_size)->prev_size = rest_size;
+		insert_free(rest);
+	}
+
+	bool handle_heap::grow_top(uint32_t granules) noexcept
+	{
+		size_t end = (static_cast<size_t>(top_) + granules) * alignment;
+		if (end > reserved_)
+		{
+			return false;
+		}
+
+		if (end > committed_)
+		{
+			size_t new_committed = internal::align_up(end, default_commit_size);
+			new_committed = internal::align_up(new_committed, pages_->page_size());
+			new_committed = new_committed > reserved_ ? reserved_ : new_committed;
+			if (!pages_->commit_memory(base_ + committed_, new_committed - committed_))
+			{
+				return false;
+			}
+			committed_ = new_committed;
+		}
+
+		block_header* header = block_at(top_);
+		header->size = granules;
+		header->prev_size = last_size_;
+		top_ += granules;
+		last_size_ = granules;
+		return true;
+	}
+
+	bool handle_heap::grow_handles() noexcept
+	{
+		size_t end = (static_cast<size_t>(handle_count_) + 1) * sizeof(handle_entry);
+		if (end > handles_committed_)
+		{
+			size_t new_committed = internal::align_up(end, pages_->page_size());
+			if (!pages_->commit_memory(reinterpret_cast<char*>(handles_) + handles_committed_, new_committed - handles_committed_))
+			{
+				return false;
+			}
+			handles_committed_ = new_committed;
+		}
+
+		handle_entry& entry = handles_[handle_count_];
+		entry.block = no_block;
+		entry.generation = 0;
+		free_handle_ = handle_count_++;
+		return true;
+	}
+
+	bool handle_heap::trim(size_t max_size) noexcept
+	{
+		size_t keep = internal::align_up(static_cast<size_t>(top_) * alignment, default_commit_size);
+		keep = internal::align_up(keep, pages_->page_size());
+		if (keep >= committed_)
+		{
+			return false;
+		}
+
+		// From the end down, so the committed range stays in one piece.
+		size_t start = committed_ - keep > max_size ? committed_ - internal::align_up(max_size, pages_->page_size()) : keep;
+		start = start < keep ? keep : start;
+		if (!pages_->decommit_memory(base_ + start, committed_ - start))
+		{
+			return false;
+		}
+		committed_ = start;
+		return committed_ > keep;
+	}
+
+}
\ No newline at end of file
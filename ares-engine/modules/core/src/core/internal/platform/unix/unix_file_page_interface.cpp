@@ -0,0 +1,141 @@
+#include <ares_core_pch.h>
+#include "core/internal/platform/unix/unix_file_page_interface.h"
+#include "core/internal/alignment.h"
+#include <fcntl.h>
+#include <sys/stat.h>
+
+namespace ares::core::internal {
+
+	unix_file_page_interface::unix_file_page_interface()
+	{
+	}
+
+	unix_file_page_interface::~unix_file_page_interface()
+	{
+		close();
+	}
+
+	bool unix_file_page_interface::open(const char* path, size_t capacity, file_open_mode mode)
+	{
+		close();
+
+		int flags = O_RDWR | O_CLOEXEC;
+		if (mode == file_open_mode::open_or_create) flags |= O_CREAT;
+		if (mode == file_open_mode::create) flags |= O_CREAT | O_TRUNC;
+
+		fd_ = ::open(path, flags, 0644);
+		if (fd_ < 0)
+		{
+			return false;
+		}
+
+		struct stat info;
+		if (::fstat(fd_, &info) != 0)
+		{
+			close();
+			return false;
+		}
+
+		file_size_ = static_cast<size_t>(info.st_size);
+		capacity_ = align_up(capacity > file_size_ ? capacity : file_size_, page_size());
+
+		// Pages past the end of the file stay inaccessible until a commit extends it,
+		// so touching them faults instead of raising SIGBUS.
+		void* ptr = ::mmap(nullptr, capacity_, PROT_NONE, MAP_SHARED, fd_, 0);
+		if (ptr == MAP_FAILED)
+		{
+			close();
+			return false;
+		}
+		base_ = static_cast<char*>(ptr);
+
+		size_t mapped = align_up(file_size_, page_size());
+		if (mapped && ::mprotect(base_, mapped, PROT_READ | PROT_WRITE) != 0)
+		{
+			close();
+			return false;
+		}
+		return true;
+	}
+
+	void unix_file_page_interface::close()
+	{
+		if (base_)
+		{
+			::munmap(base_, capacity_);
+		}
+		if (fd_ >= 0)
+		{
+			::close(fd_);
+		}
+
+		fd_ = -1;
+		base_ = nullptr;
+		capacity_ = 0;
+		file_size_ = 0;
+		reserved_ = 0;
+	}
+
+	bool unix_file_page_interface::flush()
+	{
+		if (!base_ || !file_size_)
+		{
+			return base_ != nullptr;
+		}
+		return ::msync(base_, align_up(file_size_, page_size()), MS_SYNC) == 0;
+	}
+
+	size_t unix_file_page_interface::page_size() const
+	{
+		static size_t page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+		return page_size;
+	}
+
+	void* unix_file_page_interface::reserve_memory(size_t size)
+	{
+		assert(size % page_size() == 0 && "Size must be a multiple of the page size!");
+		if (!base_ || size > capacity_ - reserved_)
+		{
+			return nullptr;
+		}
+
+		void* result = base_ + reserved_;
+		reserved_ += size;
+		return result;
+	}
+
+	bool unix_file_page_interface::commit_memory(void* address, size_t size)
+	{
+		assert(size % page_size() == 0 && "Size must be a multiple of the page size!");
+		size_t end = static_cast<size_t>(static_cast<char*>(address) - base_) + size;
+		if (end > file_size_)
+		{
+			if (::ftruncate(fd_, static_cast<off_t>(end)) != 0)
+			{
+				return false;
+			}
+			file_size_ = end;
+		}
+		return ::mprotect(address, size, PROT_READ | PROT_WRITE) == 0;
+	}
+
+	bool unix_file_page_interface::decommit_memory(void* address, size_t size)
+	{
+		assert(size % page_size() == 0 && "Size must be a multiple of the page size!");
+		// On a shared mapping this only unmaps the pages. Dirty ones are still
+		// written back, so the file keeps the contents.
+		::madvise(address, size, MADV_DONTNEED);
+		return ::mprotect(address, size, PROT_NONE) == 0;
+	}
+
+	bool unix_file_page_interface::release_memory(void* address, size_t size)
+	{
+		// The mapping lives until close(). Only the last reservation can be taken back.
+		if (static_cast<char*>(address) + size == base_ + reserved_)
+		{
+			reserved_ -= size;
+		}
+		return true;
+	}
+
+}
\ No newline at end of file
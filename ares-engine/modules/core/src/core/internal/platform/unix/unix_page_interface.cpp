@@ -1,38 +1,248 @@
 #include <ares_core_pch.h>
 #include "core/internal/platform/unix/unix_page_interface.h"
-
-constexpr size_t PAGE_SIZE = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#include "core/internal/alignment.h"
+#include "core/internal/bits.h"
+#include <dirent.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
 
 namespace ares::core::internal {
 
+	namespace {
+
+		struct large_page_info
+		{
+			static constexpr size_t max_sizes = 8;
+
+			size_t hugetlb_sizes[max_sizes] = {};   // hugetlbfs pools, smallest first
+			size_t hugetlb_count = 0;
+			size_t transparent_size = 0;            // 0 when transparent huge pages are off
+		};
+
+		size_t read_size_file(const char* path)
+		{
+			size_t result = 0;
+			if (FILE* file = fopen(path, "r"))
+			{
+				unsigned long long value = 0;
+				if (fscanf(file, "%llu", &value) == 1)
+				{
+					result = static_cast<size_t>(value);
+				}
+				fclose(file);
+			}
+			return result;
+		}
+
+		const large_page_info& query_large_pages()
+		{
+			static large_page_info info = [] {
+				large_page_info result;
+			#if ARES_PLATFORM_LINUX
+				if (DIR* dir = ::opendir("/sys/kernel/mm/hugepages"))
+				{
+					while (dirent* entry = ::readdir(dir))
+					{
+						unsigned long kib = 0;
+						if (sscanf(entry->d_name, "hugepages-%lukB", &kib) != 1 || result.hugetlb_count == large_page_info::max_sizes)
+						{
+							continue;
+						}
+
+						size_t size = static_cast<size_t>(kib) * 1024;
+						size_t index = result.hugetlb_count++;
+						while (index > 0 && result.hugetlb_sizes[index - 1] > size)
+						{
+							result.hugetlb_sizes[index] = result.hugetlb_sizes[index - 1];
+							index--;
+						}
+						result.hugetlb_sizes[index] = size;
+					}
+					::closedir(dir);
+				}
+
+				char mode[128] = {};
+				if (FILE* file = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r"))
+				{
+					if (!fgets(mode, sizeof(mode), file))
+					{
+						mode[0] = 0;
+					}
+					fclose(file);
+				}
+				if (mode[0] && !strstr(mode, "[never]"))
+				{
+					result.transparent_size = read_size_file("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size");
+				}
+			#endif
+				return result;
+			}();
+			return info;
+		}
+
+	}
+
 	unix_page_interface::unix_page_interface()
 	{
 	}
 
 	size_t unix_page_interface::page_size() const
 	{
-		return PAGE_SIZE;
+		static size_t page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+		return page_size;
+	}
+
+	size_t unix_page_interface::page_size(const void* address) const
+	{
+		page_region_table::region region;
+		return regions_.find(address, region) ? region.page_size : page_size();
+	}
+
+	size_t unix_page_interface::large_page_sizes(size_t* sizes, size_t capacity) const
+	{
+		const large_page_info& info = query_large_pages();
+
+		size_t merged[large_page_info::max_sizes + 1] = {};
+		size_t count = 0;
+		bool transparent_added = info.transparent_size == 0;
+		for (size_t i = 0; i < info.hugetlb_count; i++)
+		{
+			if (!transparent_added && info.transparent_size <= info.hugetlb_sizes[i])
+			{
+				if (info.transparent_size != info.hugetlb_sizes[i])
+				{
+					merged[count++] = info.transparent_size;
+				}
+				transparent_added = true;
+			}
+			merged[count++] = info.hugetlb_sizes[i];
+		}
+		if (!transparent_added)
+		{
+			merged[count++] = info.transparent_size;
+		}
+
+		for (size_t i = 0; i < count && i < capacity; i++)
+		{
+			sizes[i] = merged[i];
+		}
+		return count;
 	}
 
 	void* unix_page_interface::reserve_memory(size_t size)
 	{
-		assert(size % PAGE_SIZE == 0 && "Size must be a multiple of the page size!");
+		assert(size % page_size() == 0 && "Size must be a multiple of the page size!");
 		void* ptr = ::mmap(nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
 		assert(ptr != MAP_FAILED && "Failed to reserve virtual memory!");
 		return ptr;
 	}
 
+	void* unix_page_interface::reserve_memory(size_t size, page_flags flags)
+	{
+		if (!has_flag(flags, page_flags::large_pages))
+		{
+			return reserve_memory(size);
+		}
+		assert(size % page_size() == 0 && "Size must be a multiple of the page size!");
+
+		const large_page_info& info = query_large_pages();
+
+	#if defined(MAP_HUGETLB)
+		// Explicit huge pages come from the preallocated hugetlbfs pool. The mapping
+		// fails up front when the pool can't cover it, which is the cue to fall back.
+		if (info.hugetlb_count && size % info.hugetlb_sizes[0] == 0)
+		{
+			size_t huge_size = info.hugetlb_sizes[0];
+			int huge_flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+		#if defined(MAP_HUGE_SHIFT)
+			huge_flags |= static_cast<int>(find_last_set(huge_size)) << MAP_HUGE_SHIFT;
+		#endif
+			void* ptr = ::mmap(nullptr, size, PROT_NONE, huge_flags, -1, 0);
+			if (ptr != MAP_FAILED)
+			{
+				if (regions_.insert(ptr, size, huge_size))
+				{
+					return ptr;
+				}
+				::munmap(ptr, size);
+			}
+		}
+	#endif
+
+	#if defined(MADV_HUGEPAGE)
+		// Transparent huge pages only need the range to be aligned and advised.
+		if (info.transparent_size && size % info.transparent_size == 0)
+		{
+			size_t huge_size = info.transparent_size;
+			char* raw = static_cast<char*>(::mmap(nullptr, size + huge_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+			if (raw != MAP_FAILED)
+			{
+				char* aligned = static_cast<char*>(align_up(raw, huge_size));
+				size_t head = static_cast<size_t>(aligned - raw);
+				if (head)
+				{
+					::munmap(raw, head);
+				}
+				::munmap(aligned + size, huge_size - head);
+
+				::madvise(aligned, size, MADV_HUGEPAGE);
+				// A full table only costs the caller the larger commit granularity.
+				regions_.insert(aligned, size, huge_size);
+				return aligned;
+			}
+		}
+	#endif
+
+		return reserve_memory(size);
+	}
+
 	bool unix_page_interface::commit_memory(void* address, size_t size)
 	{
-		assert(size % PAGE_SIZE == 0 && "Size must be a multiple of the page size!");
+		assert(size % page_size(address) == 0 && "Size must be a multiple of the page size!");
 		int result = ::mprotect(address, size, PROT_READ | PROT_WRITE);
 		assert(result == 0 && "Failed to commit virtual memory!");
 		return result == 0;
 	}
 
+	bool unix_page_interface::commit_memory(void* address, size_t size, commit_flags flags)
+	{
+		if (!commit_memory(address, size))
+		{
+			return false;
+		}
+
+		// mlock faults the whole range in, so it covers prefault as well.
+		if (has_flag(flags, commit_flags::lock) && ::mlock(address, size) == 0)
+		{
+			return true;
+		}
+
+		if (has_flag(flags, commit_flags::prefault))
+		{
+		#if defined(MADV_POPULATE_WRITE)
+			// Linux 5.14+. Older kernels reject it and the pages are touched instead.
+			if (::madvise(address, size, MADV_POPULATE_WRITE) == 0)
+			{
+				return true;
+			}
+		#endif
+			touch_pages(address, size, page_size(address));
+		}
+		return true;
+	}
+
 	bool unix_page_interface::decommit_memory(void* address, size_t size)
 	{
-		assert(size % PAGE_SIZE == 0 && "Size must be a multiple of the page size!");
+		assert(size % page_size(address) == 0 && "Size must be a multiple of the page size!");
+		// PROT_NONE alone keeps the pages resident. MADV_DONTNEED drops them right
+		// away so RSS goes down; MADV_FREE would only do so under memory pressure.
+		// Locked pages refuse the advice until they are unlocked.
+		if (::madvise(address, size, MADV_DONTNEED) != 0 && errno == EINVAL)
+		{
+			::munlock(address, size);
+			::madvise(address, size, MADV_DONTNEED);
+		}
 		int result = ::mprotect(address, size, PROT_NONE);
 		assert(result == 0 && "Failed to decommit virtual memory!");
 		return result == 0;
@@ -40,7 +250,8 @@ namespace ares::core::internal {
 
 	bool unix_page_interface::release_memory(void* address, size_t size)
 	{
-		assert(size % PAGE_SIZE == 0 && "Size must be a multiple of the page size!");
+		assert(size % page_size(address) == 0 && "Size must be a multiple of the page size!");
+		regions_.erase(address);
 		int result = ::munmap(address, size);
 		assert(result == 0 && "Failed to release virtual memory!");
 		return result == 0;
@@ -0,0 +1,159 @@
+#include <ares_core_pch.h>
+#include "core/internal/platform/windows/win32_file_page_interface.h"
+#include "core/internal/alignment.h"
+#include <winioctl.h>
+
+namespace ares::core::internal {
+
+	win32_file_page_interface::win32_file_page_interface()
+	{
+	}
+
+	win32_file_page_interface::~win32_file_page_interface()
+	{
+		close();
+	}
+
+	bool win32_file_page_interface::open(const char* path, size_t capacity, file_open_mode mode)
+	{
+		close();
+
+		DWORD disposition = OPEN_ALWAYS;
+		if (mode == file_open_mode::open_existing) disposition = OPEN_EXISTING;
+		if (mode == file_open_mode::create) disposition = CREATE_ALWAYS;
+
+		HANDLE file = ::CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, disposition, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+		file_ = file;
+
+		LARGE_INTEGER length;
+		if (!::GetFileSizeEx(file, &length))
+		{
+			close();
+			return false;
+		}
+
+		file_size_ = static_cast<size_t>(length.QuadPart);
+		capacity_ = align_up(capacity > file_size_ ? capacity : file_size_, page_size());
+
+		// A mapping can't be larger than its file, so the file is grown to the full
+		// capacity up front. Sparse files keep that free on disk, and close() cuts
+		// the file back to what was committed.
+		DWORD returned = 0;
+		::DeviceIoControl(file, FSCTL_SET_SPARSE, nullptr, 0, nullptr, 0, &returned, nullptr);
+
+		uint64_t mapping_size = static_cast<uint64_t>(capacity_);
+		HANDLE mapping = ::CreateFileMappingA(file, nullptr, PAGE_READWRITE, static_cast<DWORD>(mapping_size >> 32), static_cast<DWORD>(mapping_size), nullptr);
+		if (!mapping)
+		{
+			close();
+			return false;
+		}
+		mapping_ = mapping;
+
+		base_ = static_cast<char*>(::MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, capacity_));
+		if (!base_)
+		{
+			close();
+			return false;
+		}
+		return true;
+	}
+
+	void win32_file_page_interface::close()
+	{
+		if (base_)
+		{
+			::UnmapViewOfFile(base_);
+		}
+		if (mapping_)
+		{
+			::CloseHandle(mapping_);
+		}
+		if (file_)
+		{
+			LARGE_INTEGER length;
+			length.QuadPart = static_cast<LONGLONG>(file_size_);
+			if (::SetFilePointerEx(file_, length, nullptr, FILE_BEGIN))
+			{
+				::SetEndOfFile(file_);
+			}
+			::CloseHandle(file_);
+		}
+
+		file_ = nullptr;
+		mapping_ = nullptr;
+		base_ = nullptr;
+		capacity_ = 0;
+		file_size_ = 0;
+		reserved_ = 0;
+	}
+
+	bool win32_file_page_interface::flush()
+	{
+		if (!base_)
+		{
+			return false;
+		}
+		return ::FlushViewOfFile(base_, file_size_) && ::FlushFileBuffers(file_);
+	}
+
+	size_t win32_file_page_interface::page_size() const
+	{
+		static size_t page_size = [] {
+			SYSTEM_INFO sys_info;
+			::GetSystemInfo(&sys_info);
+			return static_cast<size_t>(sys_info.dwPageSize);
+		}();
+		return page_size;
+	}
+
+	void* win32_file_page_interface::reserve_memory(size_t size)
+	{
+		assert(size % page_size() == 0 && "Size must be a multiple of the page size!");
+		if (!base_ || size > capacity_ - reserved_)
+		{
+			return nullptr;
+		}
+
+		void* result = base_ + reserved_;
+		reserved_ += size;
+		return result;
+	}
+
+	bool win32_file_page_interface::commit_memory(void* address, size_t size)
+	{
+		assert(size % page_size() == 0 && "Size must be a multiple of the page size!");
+		// The whole view is accessible already; committing only moves the length
+		// the file is cut back to.
+		size_t end = static_cast<size_t>(static_cast<char*>(address) - base_) + size;
+		if (end > file_size_)
+		{
+			file_size_ = end;
+		}
+		return true;
+	}
+
+	bool win32_file_page_interface::decommit_memory(void* address, size_t size)
+	{
+		assert(size % page_size() == 0 && "Size must be a multiple of the page size!");
+		// Views can't be decommitted. Unlocking pages that aren't locked drops them
+		// from the working set, and the file keeps their contents.
+		::VirtualUnlock(address, size);
+		return true;
+	}
+
+	bool win32_file_page_interface::release_memory(void* address, size_t size)
+	{
+		// The view lives until close(). Only the last reservation can be taken back.
+		if (static_cast<char*>(address) + size == base_ + reserved_)
+		{
+			reserved_ -= size;
+		}
+		return true;
+	}
+
+}
\ No newline at end of file
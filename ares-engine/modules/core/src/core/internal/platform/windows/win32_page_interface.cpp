@@ -3,6 +3,35 @@
 
 namespace ares::core::internal {
 
+	namespace {
+
+		// Large page regions are committed when reserved and stay committed.
+		constexpr uint32_t region_pinned = 1;
+
+		// MEM_LARGE_PAGES needs SeLockMemoryPrivilege enabled on the process token.
+		bool enable_lock_memory_privilege()
+		{
+			static bool enabled = [] {
+				HANDLE token = nullptr;
+				if (!::OpenProcessToken(::GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token))
+				{
+					return false;
+				}
+
+				TOKEN_PRIVILEGES privileges = {};
+				privileges.PrivilegeCount = 1;
+				privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+				bool result = ::LookupPrivilegeValue(nullptr, SE_LOCK_MEMORY_NAME, &privileges.Privileges[0].Luid)
+					&& ::AdjustTokenPrivileges(token, FALSE, &privileges, 0, nullptr, nullptr)
+					&& ::GetLastError() == ERROR_SUCCESS;
+				::CloseHandle(token);
+				return result;
+			}();
+			return enabled;
+		}
+
+	}
+
 	win32_page_interface::win32_page_interface()
 	{
 	}
@@ -17,6 +46,27 @@ namespace ares::core::internal {
 		return page_size;
 	}
 
+	size_t win32_page_interface::page_size(const void* address) const
+	{
+		page_region_table::region region;
+		return regions_.find(address, region) ? region.page_size : page_size();
+	}
+
+	size_t win32_page_interface::large_page_sizes(size_t* sizes, size_t capacity) const
+	{
+		size_t minimum = static_cast<size_t>(::GetLargePageMinimum());
+		if (!minimum)
+		{
+			return 0;
+		}
+
+		if (capacity)
+		{
+			sizes[0] = minimum;
+		}
+		return 1;
+	}
+
 	void* win32_page_interface::reserve_memory(size_t size)
 	{
 		assert(size % page_size() == 0 && "Size must be a multiple of the page size!");
@@ -25,17 +75,84 @@ namespace ares::core::internal {
 		return ptr;
 	}
 
+	void* win32_page_interface::reserve_memory(size_t size, page_flags flags)
+	{
+		if (!has_flag(flags, page_flags::large_pages))
+		{
+			return reserve_memory(size);
+		}
+
+		// Large pages can't be reserved without committing them, so the whole range
+		// is committed now and commit/decommit become no-ops for it.
+		size_t large_size = static_cast<size_t>(::GetLargePageMinimum());
+		if (large_size && size % large_size == 0 && enable_lock_memory_privilege())
+		{
+			void* ptr = ::VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+			if (ptr)
+			{
+				if (regions_.insert(ptr, size, large_size, region_pinned))
+				{
+					return ptr;
+				}
+				::VirtualFree(ptr, 0, MEM_RELEASE);
+			}
+		}
+
+		return reserve_memory(size);
+	}
+
 	bool win32_page_interface::commit_memory(void* address, size_t size)
 	{
+		page_region_table::region region;
+		if (regions_.find(address, region) && (region.flags & region_pinned))
+		{
+			return true;
+		}
+
 		assert(size % page_size() == 0 && "Size must be a multiple of the page size!");
 		void* ptr = ::VirtualAlloc(address, size, MEM_COMMIT, PAGE_READWRITE);
 		assert(ptr && "Failed to commit virtual memory!");
 		return ptr != nullptr;
 	}
 
+	bool win32_page_interface::commit_memory(void* address, size_t size, commit_flags flags)
+	{
+		page_region_table::region region;
+		if (regions_.find(address, region) && (region.flags & region_pinned))
+		{
+			// Large pages are resident from the moment they are reserved.
+			return true;
+		}
+
+		if (!commit_memory(address, size))
+		{
+			return false;
+		}
+
+		// VirtualLock faults the range in, so it covers prefault as well.
+		if (has_flag(flags, commit_flags::lock) && ::VirtualLock(address, size))
+		{
+			return true;
+		}
+
+		if (has_flag(flags, commit_flags::prefault))
+		{
+			touch_pages(address, size, page_size());
+		}
+		return true;
+	}
+
 	bool win32_page_interface::decommit_memory(void* address, size_t size)
 	{
+		page_region_table::region region;
+		if (regions_.find(address, region) && (region.flags & region_pinned))
+		{
+			return true;
+		}
+
 		assert(size % page_size() == 0 && "Size must be a multiple of the page size!");
+		// Fails harmlessly when the range was never locked.
+		::VirtualUnlock(address, size);
 		BOOL result = ::VirtualFree(address, size, MEM_DECOMMIT);
 		assert(result && "Failed to decommit virtual memory!");
 		return result != 0;
@@ -43,6 +160,7 @@ namespace ares::core::internal {
 
 	bool win32_page_interface::release_memory(void* address, size_t size)
 	{
+		regions_.erase(address);
 		BOOL result = ::VirtualFree(address, 0, MEM_RELEASE);
 		assert(result && "Failed to release virtual memory!");
 		return result != 0;
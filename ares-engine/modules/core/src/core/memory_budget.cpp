@@ -0,0 +1,255 @@
+#include <ares_core_pch.h>
+#include "core/memory_budget.h"
+#include "core/platform.h"
+#include "core/internal/alignment.h"
+#include <string.h>
+
+namespace ares::core {
+
+	memory_budget::memory_budget(const char* name, size_t soft_limit, size_t hard_limit)
+	{
+		if (name)
+		{
+			strncpy(name_, name, max_name_length - 1);
+		}
+
+		used_.store(0, memory_order_relaxed);
+		peak_.store(0, memory_order_relaxed);
+		soft_armed_.store(true, memory_order_relaxed);
+		failures_.store(0, memory_order_relaxed);
+		for (callback_entry& entry : callbacks_)
+		{
+			entry.function.store(nullptr, memory_order_relaxed);
+			entry.user_data.store(nullptr, memory_order_relaxed);
+		}
+		set_limits(soft_limit, hard_limit);
+	}
+
+	bool memory_budget::charge(size_t size) noexcept
+	{
+		size_t hard = hard_limit_.load(memory_order_relaxed);
+		size_t previous = used_.fetch_add(size, memory_order_relaxed);
+		size_t current = previous + size;
+
+		if (current > hard)
+		{
+			used_.fetch_sub(size, memory_order_relaxed);
+
+			// Give the subsystem one chance to make room before refusing.
+			notify(memory_pressure::hard);
+			previous = used_.fetch_add(size, memory_order_relaxed);
+			current = previous + size;
+			if (current > hard)
+			{
+				used_.fetch_sub(size, memory_order_relaxed);
+				failures_.fetch_add(1, memory_order_relaxed);
+				return false;
+			}
+		}
+
+		size_t soft = soft_limit_.load(memory_order_relaxed);
+		if (current > soft && previous <= soft && soft_armed_.exchange(false, memory_order_relaxed))
+		{
+			notify(memory_pressure::soft);
+		}
+
+		if (current > peak_.load(memory_order_relaxed))
+		{
+			update_peak(current);
+		}
+		return true;
+	}
+
+	void memory_budget::release(size_t size) noexcept
+	{
+		size_t previous = used_.fetch_sub(size, memory_order_relaxed);
+		size_t rearm = rearm_level_.load(memory_order_relaxed);
+		if (previous >= rearm && previous - size < rearm)
+		{
+			soft_armed_.store(true, memory_order_relaxed);
+		}
+	}
+
+	bool memory_budget::add_callback(pressure_callback callback, void* user_data)
+	{
+		std::lock_guard<std::mutex> lock(callbacks_mutex_);
+		for (callback_entry& entry : callbacks_)
+		{
+			if (!entry.function.load(memory_order_relaxed))
+			{
+				// The function is published last so notify() never sees it without
+				// its user data.
+				entry.user_data.store(user_data, memory_order_relaxed);
+				entry.function.store(callback, memory_order_release);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void memory_budget::remove_callback(pressure_callback callback, void* user_data)
+	{
+		std::lock_guard<std::mutex> lock(callbacks_mutex_);
+		for (callback_entry& entry : callbacks_)
+		{
+			if (entry.function.load(memory_order_relaxed) == callback && entry.user_data.load(memory_order_relaxed) == user_data)
+			{
+				entry.function.store(nullptr, memory_order_release);
+			}
+		}
+	}
+
+	void memory_budget::set_limits(size_t soft_limit, size_t hard_limit) noexcept
+	{
+		assert(soft_limit <= hard_limit && "Soft limit must not be above the hard limit!");
+		soft_limit_.store(soft_limit, memory_order_relaxed);
+		hard_limit_.store(hard_limit, memory_order_relaxed);
+		size_t rearm = soft_limit == unlimited ? unlimited : static_cast<size_t>(static_cast<double>(soft_limit) * rearm_fraction);
+		rearm_level_.store(rearm, memory_order_relaxed);
+		soft_armed_.store(used() <= soft_limit, memory_order_relaxed);
+	}
+
+	// Runs on the allocating thread with no locks held, so callbacks may free
+	// memory charged to this budget.
+	void memory_budget::notify(memory_pressure pressure) noexcept
+	{
+		for (callback_entry& entry : callbacks_)
+		{
+			if (pressure_callback function = entry.function.load(memory_order_acquire))
+			{
+				function(*this, pressure, entry.user_data.load(memory_order_relaxed));
+			}
+		}
+	}
+
+	void memory_budget::update_peak(size_t used) noexcept
+	{
+		size_t peak = peak_.load(memory_order_relaxed);
+		while (used > peak && !peak_.compare_exchange_weak(peak, used, memory_order_relaxed))
+		{
+		}
+	}
+
+	// Sits right before the user pointer. prefix is the distance back to the
+	// backing allocation, a multiple of the alignment so offsets stay aligned.
+	struct budgeted_allocator::header
+	{
+		uint64_t size;
+		uint64_t prefix;
+	};
+
+	budgeted_allocator::budgeted_allocator(allocator* backing, memory_budget& budget)
+		: backing_(backing), budget_(&budget)
+	{
+	}
+
+	budgeted_allocator::budgeted_allocator(allocator* backing, const char* budget_name)
+		: backing_(backing), budget_(find_memory_budget(budget_name))
+	{
+		assert(budget_ && "No memory budget has been registered with this name!");
+	}
+
+	void* budgeted_allocator::allocate(size_t size)
+	{
+		return allocate(size, ARES_PLATFORM_MIN_MALLOC_ALIGNMENT, 0);
+	}
+
+	void* budgeted_allocator::allocate(size_t size, size_t alignment)
+	{
+		return allocate(size, alignment, 0);
+	}
+
+	void* budgeted_allocator::allocate(size_t size, size_t alignment, size_t offset)
+	{
+		if (!budget_ || !budget_->charge(size))
+		{
+			return nullptr;
+		}
+
+		size_t prefix = internal::align_up(sizeof(header), alignment);
+		char* block = static_cast<char*>(backing_->allocate(size + prefix, alignment, offset));
+		if (!block)
+		{
+			budget_->release(size);
+			return nullptr;
+		}
+
+		char* result = block + prefix;
+		header entry{ size, prefix };
+		memcpy(result - sizeof(header), &entry, sizeof(header));
+		return result;
+	}
+
+	void budgeted_allocator::deallocate(void* ptr)
+	{
+		if (!ptr) return;
+
+		header entry;
+		memcpy(&entry, static_cast<char*>(ptr) - sizeof(header), sizeof(header));
+		budget_->release(static_cast<size_t>(entry.size));
+		backing_->deallocate(static_cast<char*>(ptr) - entry.prefix);
+	}
+
+	namespace {
+
+		constexpr size_t max_budgets = 64;
+
+		struct budget_registry
+		{
+			std::mutex mutex;
+			memory_budget* budgets[max_budgets] = {};
+		};
+
+		budget_registry& get_budget_registry()
+		{
+			static budget_registry result;
+			return result;
+		}
+
+	}
+
+	bool register_memory_budget(memory_budget* budget)
+	{
+		budget_registry& registry = get_budget_registry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		for (memory_budget*& entry : registry.budgets)
+		{
+			if (!entry)
+			{
+				entry = budget;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void unregister_memory_budget(memory_budget* budget)
+	{
+		budget_registry& registry = get_budget_registry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		for (memory_budget*& entry : registry.budgets)
+		{
+			if (entry == budget)
+			{
+				entry = nullptr;
+			}
+		}
+	}
+
+	memory_budget* find_memory_budget(const char* name)
+	{
+		if (!name) return nullptr;
+
+		budget_registry& registry = get_budget_registry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		for (memory_budget* entry : registry.budgets)
+		{
+			if (entry && strncmp(entry->get_name(), name, memory_budget::max_name_length - 1) == 0)
+			{
+				return entry;
+			}
+		}
+		return nullptr;
+	}
+
+}
\ No newline at end of file
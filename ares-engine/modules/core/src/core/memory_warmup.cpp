@@ -0,0 +1,69 @@
+#include <ares_core_pch.h>
+#include "core/memory_warmup.h"
+#include "core/temp_allocator.h"
+#include "core/tlsf_allocator.h"
+
+namespace ares::core {
+
+	memory_warmup::~memory_warmup()
+	{
+		wait();
+	}
+
+	bool memory_warmup::add(warm_function function, void* target, size_t size, internal::commit_flags flags)
+	{
+		assert(!thread_.joinable() && "Jobs must be added before the warm-up starts!");
+		if (job_count_ == max_jobs || thread_.joinable())
+		{
+			return false;
+		}
+
+		jobs_[job_count_++] = job{ function, target, size, flags };
+		return true;
+	}
+
+	bool memory_warmup::add(temp_allocator& arena, size_t size, internal::commit_flags flags)
+	{
+		return add([](void* target, size_t size, internal::commit_flags flags) {
+			return static_cast<temp_allocator*>(target)->warm(size, flags);
+		}, &arena, size, flags);
+	}
+
+	bool memory_warmup::add(tlsf_allocator& heap, size_t size, internal::commit_flags flags)
+	{
+		return add([](void* target, size_t size, internal::commit_flags flags) {
+			return static_cast<tlsf_allocator*>(target)->warm(size, flags);
+		}, &heap, size, flags);
+	}
+
+	void memory_warmup::start()
+	{
+		if (thread_.joinable())
+		{
+			return;
+		}
+
+		finished_.store(false, memory_order_relaxed);
+		thread_ = std::thread([this]()
+		{
+			bool succeeded = true;
+			for (size_t i = 0; i < job_count_; i++)
+			{
+				const job& entry = jobs_[i];
+				succeeded &= entry.function(entry.target, entry.size, entry.flags);
+			}
+			succeeded_ = succeeded;
+			finished_.store(true, memory_order_release);
+		});
+	}
+
+	bool memory_warmup::wait()
+	{
+		if (thread_.joinable())
+		{
+			thread_.join();
+		}
+		return succeeded_;
+	}
+
+}
\ No newline at end of file
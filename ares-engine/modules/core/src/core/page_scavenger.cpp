@@ -0,0 +1,143 @@
+#include <ares_core_pch.h>
+#include "core/page_scavenger.h"
+#include <chrono>
+
+namespace ares::core {
+
+	page_scavenger::page_scavenger(uint32_t delay_ms, internal::os_page_interface& pages)
+		: pages_(&pages), delay_ms_(delay_ms)
+	{
+	}
+
+	page_scavenger::~page_scavenger()
+	{
+		stop();
+	}
+
+	void page_scavenger::retire(void* address, size_t size)
+	{
+		if (!address || !size) return;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (range_count_ < max_ranges)
+			{
+				ranges_[range_count_++] = range{ static_cast<char*>(address), size, now_ms() };
+				retired_bytes_ += size;
+				return;
+			}
+			released_bytes_ += size;
+		}
+
+		pages_->decommit_memory(address, size);
+	}
+
+	bool page_scavenger::reclaim(void* address, size_t size)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		for (size_t i = 0; i < range_count_; i++)
+		{
+			if (ranges_[i].address == address && ranges_[i].size == size)
+			{
+				retired_bytes_ -= size;
+				ranges_[i] = ranges_[--range_count_];
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void page_scavenger::forget(const void* address, size_t size)
+	{
+		const char* begin = static_cast<const char*>(address);
+		const char* end = begin + size;
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		for (size_t i = 0; i < range_count_;)
+		{
+			if (ranges_[i].address >= begin && ranges_[i].address < end)
+			{
+				retired_bytes_ -= ranges_[i].size;
+				ranges_[i] = ranges_[--range_count_];
+			}
+			else
+			{
+				i++;
+			}
+		}
+	}
+
+	size_t page_scavenger::scavenge(uint32_t min_age_ms)
+	{
+		uint64_t now = now_ms();
+		size_t released = 0;
+
+		// Decommitting under the lock keeps a racing reclaim() from handing the
+		// range back while its pages are going away.
+		std::lock_guard<std::mutex> lock(mutex_);
+		for (size_t i = 0; i < range_count_;)
+		{
+			range& entry = ranges_[i];
+			if (now - entry.retired_ms < min_age_ms)
+			{
+				i++;
+				continue;
+			}
+
+			pages_->decommit_memory(entry.address, entry.size);
+			released += entry.size;
+			retired_bytes_ -= entry.size;
+			entry = ranges_[--range_count_];
+		}
+
+		released_bytes_ += released;
+		return released;
+	}
+
+	void page_scavenger::start(uint32_t interval_ms)
+	{
+		stop();
+		if (!interval_ms) interval_ms = delay_ms_ > 1 ? delay_ms_ / 2 : 1;
+
+		thread_stop_ = false;
+		thread_ = std::thread([this, interval_ms]()
+		{
+			std::unique_lock<std::mutex> lock(thread_mutex_);
+			while (!thread_signal_.wait_for(lock, std::chrono::milliseconds(interval_ms), [this] { return thread_stop_; }))
+			{
+				scavenge(delay_ms_);
+			}
+		});
+	}
+
+	void page_scavenger::stop()
+	{
+		if (!thread_.joinable()) return;
+
+		{
+			std::lock_guard<std::mutex> lock(thread_mutex_);
+			thread_stop_ = true;
+		}
+		thread_signal_.notify_all();
+		thread_.join();
+	}
+
+	size_t page_scavenger::retired_bytes()
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		return retired_bytes_;
+	}
+
+	size_t page_scavenger::released_bytes()
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		return released_bytes_;
+	}
+
+	uint64_t page_scavenger::now_ms()
+	{
+		using namespace std::chrono;
+		return static_cast<uint64_t>(duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count());
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,180 @@
+#include <ares_core_pch.h>
+#include "core/persistent_arena.h"
+#include "core/internal/alignment.h"
+
+namespace ares::core {
+
+	struct persistent_arena::header
+	{
+		static constexpr uint64_t magic_value = 0x414E455241535241ull;   // "ARSARENA"
+		static constexpr uint32_t current_version = 1;
+
+		uint64_t magic;
+		uint32_t version;
+		uint32_t clean;     // set by close(), cleared while the arena is open
+		uint64_t schema;
+		uint64_t used;      // header included
+		int64_t root;       // from the base, 0 when unset
+	};
+
+	persistent_arena::persistent_arena()
+	{
+	}
+
+	persistent_arena::persistent_arena(const char* path, uint64_t schema, size_t capacity, internal::file_open_mode mode)
+	{
+		open(path, schema, capacity, mode);
+	}
+
+	persistent_arena::~persistent_arena()
+	{
+		close();
+	}
+
+	bool persistent_arena::open(const char* path, uint64_t schema, size_t capacity, internal::file_open_mode mode)
+	{
+		close();
+
+		if (!file_.open(path, capacity, mode))
+		{
+			return false;
+		}
+
+		base_ = static_cast<char*>(file_.reserve_memory(file_.capacity()));
+		committed_ = internal::align_up(file_.file_size(), file_.page_size());
+		if (!base_)
+		{
+			file_.close();
+			return false;
+		}
+
+		header* existing = reinterpret_cast<header*>(base_);
+		if (committed_)
+		{
+			if (existing->magic != header::magic_value || existing->version != header::current_version || existing->schema != schema
+				|| !existing->clean || existing->used > committed_)
+			{
+				file_.close();
+				return false;
+			}
+			loaded_ = true;
+		}
+		else
+		{
+			if (!grow(sizeof(header)))
+			{
+				file_.close();
+				return false;
+			}
+			existing->magic = header::magic_value;
+			existing->version = header::current_version;
+			existing->schema = schema;
+			existing->used = internal::align_up(sizeof(header), ARES_PLATFORM_MIN_MALLOC_ALIGNMENT);
+			existing->root = 0;
+			loaded_ = false;
+		}
+
+		// A crash from here on leaves the file marked as incomplete.
+		existing->clean = 0;
+		header_ = existing;
+		return true;
+	}
+
+	void persistent_arena::close()
+	{
+		if (!header_)
+		{
+			return;
+		}
+
+		// The data has to reach the file before the header says it is complete.
+		file_.flush();
+		header_->clean = 1;
+		file_.flush();
+		file_.close();
+
+		header_ = nullptr;
+		base_ = nullptr;
+		committed_ = 0;
+		loaded_ = false;
+	}
+
+	bool persistent_arena::flush()
+	{
+		return header_ && file_.flush();
+	}
+
+	void* persistent_arena::allocate(size_t size)
+	{
+		return allocate(size, ARES_PLATFORM_MIN_MALLOC_ALIGNMENT);
+	}
+
+	void* persistent_arena::allocate(size_t size, size_t alignment)
+	{
+		return allocate(size, alignment, 0);
+	}
+
+	void* persistent_arena::allocate(size_t size, size_t alignment, size_t offset)
+	{
+		assert(internal::is_power_of_two(alignment) && "Alignment must be a power of two!");
+		if (!header_)
+		{
+			return nullptr;
+		}
+
+		// Offsets are aligned from the base, which the mapping aligns to a page, so
+		// the layout is the same wherever the file is mapped.
+		size_t start = internal::align_up(static_cast<size_t>(header_->used) + offset, alignment) - offset;
+		size_t end = start + size;
+
+		if (end > committed_ && !grow(end))
+		{
+			return nullptr;
+		}
+
+		header_->used = end;
+		return base_ + start;
+	}
+
+	void persistent_arena::set_root(void* root) noexcept
+	{
+		if (header_)
+		{
+			header_->root = root ? static_cast<int64_t>(static_cast<char*>(root) - base_) : 0;
+		}
+	}
+
+	void* persistent_arena::root() const noexcept
+	{
+		return header_ && header_->root ? base_ + header_->root : nullptr;
+	}
+
+	size_t persistent_arena::used() const noexcept
+	{
+		return header_ ? static_cast<size_t>(header_->used) : 0;
+	}
+
+	bool persistent_arena::grow(size_t required) noexcept
+	{
+		if (required > file_.capacity())
+		{
+			return false;
+		}
+
+		size_t new_committed = internal::align_up(required, default_commit_size);
+		new_committed = internal::align_up(new_committed, file_.page_size());
+		if (new_committed > file_.capacity())
+		{
+			new_committed = file_.capacity();
+		}
+
+		if (!file_.commit_memory(base_ + committed_, new_committed - committed_))
+		{
+			return false;
+		}
+
+		committed_ = new_committed;
+		return true;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,126 @@
+#include <ares_core_pch.h>
+#include "core/pool_allocator.h"
+#include "core/page_scavenger.h"
+#include "core/internal/alignment.h"
+
+namespace ares::core {
+
+	pool_allocator::pool_allocator(size_t block_size, size_t block_alignment, size_t reserve_size, size_t slab_size, internal::os_page_interface& pages)
+		: pages_(&pages)
+	{
+		assert(internal::is_power_of_two(block_alignment) && "Alignment must be a power of two!");
+
+		block_alignment_ = block_alignment < alignof(free_block) ? alignof(free_block) : block_alignment;
+		block_size_ = internal::align_up(block_size < sizeof(free_block) ? sizeof(free_block) : block_size, block_alignment_);
+		header_size_ = internal::align_up(sizeof(slab_header), block_alignment_);
+
+		slab_size_ = internal::align_up(slab_size, pages_->page_size());
+		while (slab_size_ < header_size_ + block_size_)
+		{
+			slab_size_ *= 2;
+		}
+		blocks_per_slab_ = (slab_size_ - header_size_) / block_size_;
+
+		reserved_ = internal::align_up(reserve_size, slab_size_);
+		base_ = static_cast<char*>(pages_->reserve_memory(reserved_));
+		if (!base_)
+		{
+			reserved_ = 0;
+		}
+	}
+
+	pool_allocator::~pool_allocator()
+	{
+		if (base_)
+		{
+			if (scavenger_)
+			{
+				scavenger_->forget(base_, reserved_);
+			}
+			pages_->release_memory(base_, reserved_);
+		}
+	}
+
+	bool pool_allocator::owns(const void* ptr) const noexcept
+	{
+		const char* p = static_cast<const char*>(ptr);
+		return p >= base_ && p < base_ + slab_count_ * slab_size_;
+	}
+
+	pool_allocator::slab_header* pool_allocator::new_slab() noexcept
+	{
+		if (!base_ || (slab_count_ + 1) * slab_size_ > reserved_)
+		{
+			return nullptr;
+		}
+
+		char* mem = base_ + slab_count_ * slab_size_;
+		if (!pages_->commit_memory(mem, slab_size_))
+		{
+			return nullptr;
+		}
+		slab_count_++;
+
+		slab_header* slab = new (mem) slab_header{};
+		slab->next_partial = partial_;
+		slab->in_partial_list = true;
+		partial_ = slab;
+		empty_slabs_++;
+		return slab;
+	}
+
+	void pool_allocator::set_scavenger(page_scavenger* scavenger) noexcept
+	{
+		if (scavenger_)
+		{
+			// Retired slabs keep their flag; take_empty_slab recommits them, which is
+			// harmless for the ones that were never decommitted.
+			scavenger_->forget(base_, reserved_);
+		}
+		scavenger_ = scavenger;
+	}
+
+	bool pool_allocator::take_empty_slab(slab_header* slab) noexcept
+	{
+		if (!slab->retired)
+		{
+			empty_slabs_--;
+			return true;
+		}
+
+		char* begin = slab_retire_begin(slab);
+		char* end = reinterpret_cast<char*>(slab) + slab_size_;
+		if (!(scavenger_ && scavenger_->reclaim(begin, end - begin)) && !pages_->commit_memory(begin, end - begin))
+		{
+			return false;
+		}
+		slab->retired = false;
+		return true;
+	}
+
+	void pool_allocator::release_empty_slab(slab_header* slab) noexcept
+	{
+		char* begin = slab_retire_begin(slab);
+		char* end = reinterpret_cast<char*>(slab) + slab_size_;
+		// One empty slab stays warm so a pool hovering around a slab boundary
+		// doesn't bounce pages through the scavenger.
+		if (!scavenger_ || empty_slabs_ == 0 || begin == end)
+		{
+			empty_slabs_++;
+			return;
+		}
+
+		// Every block is free, so carving starts over once the slab is taken back.
+		slab->free_list = nullptr;
+		slab->carved = 0;
+		slab->retired = true;
+		scavenger_->retire(begin, end - begin);
+	}
+
+	// The header page stays committed; everything after it can be retired.
+	inline char* pool_allocator::slab_retire_begin(slab_header* slab) const noexcept
+	{
+		return static_cast<char*>(internal::align_up(slab_blocks(slab), pages_->page_size()));
+	}
+
+}
\ No newline at end of file
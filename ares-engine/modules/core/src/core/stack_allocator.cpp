@@ -0,0 +1,164 @@
+#include <ares_core_pch.h>
+#include "core/stack_allocator.h"
+#include "core/internal/alignment.h"
+#include <string.h>
+
+namespace ares::core {
+
+	stack_allocator::stack_allocator(size_t reserve_size, internal::os_page_interface& pages)
+		: pages_(&pages)
+	{
+		reserved_ = internal::align_up(reserve_size, pages_->page_size());
+		base_ = static_cast<char*>(pages_->reserve_memory(reserved_));
+		if (!base_)
+		{
+			reserved_ = 0;
+		}
+	}
+
+	stack_allocator::~stack_allocator()
+	{
+		if (base_)
+		{
+			pages_->release_memory(base_, reserved_);
+		}
+	}
+
+	void* stack_allocator::allocate(size_t size)
+	{
+		return allocate(size, ARES_PLATFORM_MIN_MALLOC_ALIGNMENT);
+	}
+
+	void* stack_allocator::allocate(size_t size, size_t alignment)
+	{
+		return allocate(size, alignment, 0);
+	}
+
+	void* stack_allocator::allocate(size_t size, size_t alignment, size_t offset)
+	{
+		assert(internal::is_power_of_two(alignment) && "Alignment must be a power of two!");
+
+		uintptr_t base = reinterpret_cast<uintptr_t>(base_);
+		size_t start = internal::align_up(base + offset_ + sizeof(header) + offset, alignment) - offset - base;
+		size_t end = start + size;
+
+		if (end > committed_ && !grow(end))
+		{
+			return nullptr;
+		}
+
+	#if ARES_BUILD_DEBUG
+		write_header(start - sizeof(header), header{ offset_, top_, header::live_magic, 0 });
+	#else
+		write_header(start - sizeof(header), header{ offset_, top_ });
+	#endif
+		top_ = start - sizeof(header);
+
+		offset_ = end;
+		if (offset_ > high_water_)
+		{
+			high_water_ = offset_;
+		}
+		return base_ + start;
+	}
+
+	void stack_allocator::deallocate(void* ptr)
+	{
+		if (!ptr) return;
+
+		size_t start = static_cast<size_t>(static_cast<char*>(ptr) - base_);
+		assert(start <= offset_ && "Pointer was released by a rewind before it was freed!");
+
+		size_t header_offset = start - sizeof(header);
+		header entry = read_header(header_offset);
+	#if ARES_BUILD_DEBUG
+		assert(entry.magic == header::live_magic && "Pointer was not allocated from this stack or was already freed!");
+		assert(!(entry.previous_offset & freed_flag) && "Pointer was freed twice!");
+	#endif
+		entry.previous_offset |= freed_flag;
+		write_header(header_offset, entry);
+		pop_freed();
+	}
+
+	// Each allocation is walked past once, so rewinding costs O(1) per allocation.
+	void stack_allocator::rewind(marker position) noexcept
+	{
+		if (position > offset_)
+		{
+			return;
+		}
+
+		while (top_ != no_allocation && top_ >= position)
+		{
+			header entry = read_header(top_);
+			size_t previous_top = entry.previous_top;
+		#if ARES_BUILD_DEBUG
+			entry.magic = header::dead_magic;
+			write_header(top_, entry);
+		#endif
+			top_ = previous_top;
+		}
+
+		offset_ = position;
+		pop_freed();
+	}
+
+	// Headers sit right before the user pointer, which an offset allocation can
+	// leave unaligned.
+	stack_allocator::header stack_allocator::read_header(size_t header_offset) const noexcept
+	{
+		header result;
+		memcpy(&result, base_ + header_offset, sizeof(result));
+		return result;
+	}
+
+	void stack_allocator::write_header(size_t header_offset, const header& value) noexcept
+	{
+		memcpy(base_ + header_offset, &value, sizeof(value));
+	}
+
+	// Freed allocations are only given back once everything above them is gone,
+	// and those from before the innermost scope once it ends.
+	void stack_allocator::pop_freed() noexcept
+	{
+		while (top_ != no_allocation && top_ >= floor_)
+		{
+			header entry = read_header(top_);
+			if (!(entry.previous_offset & freed_flag))
+			{
+				break;
+			}
+
+			offset_ = entry.previous_offset & ~freed_flag;
+		#if ARES_BUILD_DEBUG
+			entry.magic = header::dead_magic;
+			write_header(top_, entry);
+		#endif
+			top_ = entry.previous_top;
+		}
+	}
+
+	bool stack_allocator::grow(size_t required) noexcept
+	{
+		if (required > reserved_)
+		{
+			return false;
+		}
+
+		size_t new_committed = internal::align_up(required, default_commit_size);
+		new_committed = internal::align_up(new_committed, pages_->page_size());
+		if (new_committed > reserved_)
+		{
+			new_committed = reserved_;
+		}
+
+		if (!pages_->commit_memory(base_ + committed_, new_committed - committed_))
+		{
+			return false;
+		}
+
+		committed_ = new_committed;
+		return true;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,215 @@
+#include <ares_core_pch.h>
+#include "core/temp_allocator.h"
+#include "core/page_scavenger.h"
+#include "core/internal/alignment.h"
+
+namespace ares::core {
+
+	temp_allocator::temp_allocator(size_t reserve_size, uint32_t decommit_after_frames, internal::page_flags flags, internal::os_page_interface& pages)
+		: pages_(&pages), decommit_after_frames_(decommit_after_frames)
+	{
+		reserved_ = internal::align_up(reserve_size, internal::reserve_granularity(*pages_, flags));
+		base_ = static_cast<char*>(pages_->reserve_memory(reserved_, flags));
+		if (!base_)
+		{
+			reserved_ = 0;
+			return;
+		}
+		page_size_ = pages_->page_size(base_);
+	}
+
+	temp_allocator::~temp_allocator()
+	{
+		if (base_)
+		{
+			set_scavenger(nullptr);
+			pages_->release_memory(base_, reserved_);
+		}
+	}
+
+	void* temp_allocator::allocate(size_t size)
+	{
+		return allocate(size, ARES_PLATFORM_MIN_MALLOC_ALIGNMENT);
+	}
+
+	void* temp_allocator::allocate(size_t size, size_t alignment)
+	{
+		return allocate(size, alignment, 0);
+	}
+
+	void* temp_allocator::allocate(size_t size, size_t alignment, size_t offset)
+	{
+		assert(internal::is_power_of_two(alignment) && "Alignment must be a power of two!");
+
+		uintptr_t base = reinterpret_cast<uintptr_t>(base_);
+		size_t start = internal::align_up(base + offset_ + offset, alignment) - offset - base;
+		size_t end = start + size;
+
+		if (end > committed_ && !grow(end))
+		{
+			return nullptr;
+		}
+
+		offset_ = end;
+		return base_ + start;
+	}
+
+	void temp_allocator::deallocate(void* ptr, size_t size)
+	{
+		char* p = static_cast<char*>(ptr);
+		if (p && p + size == base_ + offset_)
+		{
+			if (offset_ > frame_peak_)
+			{
+				frame_peak_ = offset_;
+			}
+			offset_ = static_cast<size_t>(p - base_);
+		}
+	}
+
+	void temp_allocator::reset() noexcept
+	{
+		size_t frame_used = offset_ > frame_peak_ ? offset_ : frame_peak_;
+		offset_ = 0;
+		frame_peak_ = 0;
+
+		if (frame_used > high_water_)
+		{
+			high_water_ = frame_used;
+		}
+
+		if (decommit_after_frames_ == 0)
+		{
+			return;
+		}
+
+		if (frame_used > window_peak_)
+		{
+			window_peak_ = frame_used;
+		}
+
+		size_t keep = internal::align_up(window_peak_, default_commit_size);
+		if (keep >= committed_)
+		{
+			// The committed range is still fully in use, so this frame wasn't quiet.
+			quiet_frames_ = 0;
+			window_peak_ = 0;
+			return;
+		}
+
+		if (++quiet_frames_ >= decommit_after_frames_)
+		{
+			trim(keep);
+			quiet_frames_ = 0;
+			window_peak_ = 0;
+		}
+	}
+
+	void temp_allocator::set_scavenger(page_scavenger* scavenger) noexcept
+	{
+		// Whatever the old scavenger hasn't decommitted yet is ours again.
+		if (scavenger_ && retired_end_)
+		{
+			reclaim_tail();
+		}
+		scavenger_ = scavenger;
+	}
+
+	bool temp_allocator::grow(size_t required) noexcept
+	{
+		if (required > reserved_)
+		{
+			return false;
+		}
+
+		if (retired_end_ && reclaim_tail() && required <= committed_)
+		{
+			return true;
+		}
+
+		size_t new_committed = internal::align_up(required, default_commit_size);
+		new_committed = internal::align_up(new_committed, page_size_);
+		if (new_committed > reserved_)
+		{
+			new_committed = reserved_;
+		}
+
+		if (!pages_->commit_memory(base_ + committed_, new_committed - committed_, commit_flags_))
+		{
+			return false;
+		}
+
+		committed_ = new_committed;
+		return true;
+	}
+
+	bool temp_allocator::warm(size_t size, internal::commit_flags flags) noexcept
+	{
+		if (!base_ || size > reserved_)
+		{
+			return false;
+		}
+
+		if (retired_end_)
+		{
+			reclaim_tail();
+		}
+
+		size_t end = internal::align_up(size, page_size_);
+		if (end > committed_)
+		{
+			end = internal::align_up(end, default_commit_size);
+			end = end > reserved_ ? reserved_ : end;
+		}
+		if (!pages_->commit_memory(base_, end, flags | commit_flags_))
+		{
+			return false;
+		}
+
+		if (end > committed_)
+		{
+			committed_ = end;
+		}
+		return true;
+	}
+
+	void temp_allocator::trim(size_t keep) noexcept
+	{
+		keep = internal::align_up(keep, page_size_);
+		if (keep >= committed_)
+		{
+			return;
+		}
+
+		if (scavenger_)
+		{
+			if (retired_end_)
+			{
+				reclaim_tail();
+			}
+			scavenger_->retire(base_ + keep, committed_ - keep);
+			retired_end_ = committed_;
+			committed_ = keep;
+			return;
+		}
+
+		if (pages_->decommit_memory(base_ + keep, committed_ - keep))
+		{
+			committed_ = keep;
+		}
+	}
+
+	// Takes the retired tail back. Returns true if it was still committed, in which
+	// case committed_ covers it again.
+	bool temp_allocator::reclaim_tail() noexcept
+	{
+		bool result = scavenger_->reclaim(base_ + committed_, retired_end_ - committed_);
+		if (result)
+		{
+			committed_ = retired_end_;
+		}
+		retired_end_ = 0;
+		return result;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,797 @@
+#include <ares_core_pch.h>
+#include "core/thread_cache_allocator.h"
+#include "core/atomic.h"
+#include "core/page_scavenger.h"
+#include "core/internal/alignment.h"
+#include "core/internal/bits.h"
+
+namespace ares::core {
+
+	struct thread_cache_allocator::free_block
+	{
+		free_block* next;
+	};
+
+	// Lives at the start of its first unit. 'owner', 'remote_free' and 'full' are
+	// touched by other threads; everything else belongs to the owning thread.
+	struct thread_cache_allocator::span
+	{
+		atomic<thread_cache*> owner;
+		atomic<free_block*> remote_free;
+		atomic<bool> full;
+		span* next = nullptr;
+		span* prev = nullptr;
+		free_block* local_free = nullptr;
+		char* blocks = nullptr;
+		uint32_t size_class = 0;
+		uint32_t units = 0;
+		uint32_t capacity = 0;
+		uint32_t carved = 0;
+		uint32_t live = 0;
+	};
+
+	// Side table entry per unit, so free units need not stay committed. length is
+	// set on the first and last unit of a free run and the links on its first.
+	struct thread_cache_allocator::unit_run
+	{
+		uint32_t length;
+		uint32_t prev;
+		uint32_t next;
+		uint32_t retired;   // handed to the scavenger
+	};
+
+	struct thread_cache_allocator::thread_cache
+	{
+		span* partial[class_count] = {};
+		span* full[class_count] = {};
+		atomic<uint64_t> pending_classes;   // classes with remote frees into full spans
+		thread_cache* next_free = nullptr;
+		thread_cache* next_all = nullptr;
+	};
+
+	namespace {
+
+		constexpr size_t span_header_size = 128;
+		constexpr size_t min_blocks_per_span = 8;
+
+		// Ids are reused once an allocator is destroyed; the generation tells a
+		// thread's cache for the old owner of an id from one for the new owner.
+		atomic<uint64_t> next_generation{ 1 };
+		atomic<thread_cache_allocator*> live_instances[thread_cache_allocator::max_instances];
+
+		struct size_class_info
+		{
+			size_t size;
+			size_t block_offset;
+			size_t units;
+			size_t capacity;
+		};
+
+		// 16 byte steps up to 128, then four classes per power of two.
+		constexpr size_t class_size(size_t index)
+		{
+			if (index < 8)
+			{
+				return (index + 1) * 16;
+			}
+
+			size_t step = index - 8;
+			size_t base = size_t(128) << (step / 4);
+			return base + (base / 4) * (step % 4 + 1);
+		}
+
+		struct size_class_table
+		{
+			size_class_info info[thread_cache_allocator::class_count] = {};
+
+			constexpr size_class_table()
+			{
+				constexpr size_t unit = thread_cache_allocator::span_unit_size;
+				for (size_t i = 0; i < thread_cache_allocator::class_count; i++)
+				{
+					size_t size = class_size(i);
+					size_t alignment = size & (~size + 1);
+					if (alignment > thread_cache_allocator::max_small_alignment)
+					{
+						alignment = thread_cache_allocator::max_small_alignment;
+					}
+
+					size_t offset = (span_header_size + alignment - 1) & ~(alignment - 1);
+					size_t units = (offset + size * min_blocks_per_span + unit - 1) / unit;
+					info[i] = { size, offset, units, (units * unit - offset) / size };
+				}
+			}
+		};
+
+		constexpr size_class_table size_classes;
+		static_assert(class_size(thread_cache_allocator::class_count - 1) == thread_cache_allocator::max_small_size, "Size class table does not end at max_small_size!");
+		static_assert(size_classes.info[thread_cache_allocator::class_count - 1].units == thread_cache_allocator::max_span_units, "max_span_units does not match the size class table!");
+
+		struct large_header
+		{
+			void* base;
+			size_t size;
+		};
+
+		template <typename span_type>
+		inline void list_push(span_type*& head, span_type* target)
+		{
+			target->prev = nullptr;
+			target->next = head;
+			if (head) head->prev = target;
+			head = target;
+		}
+
+		template <typename span_type>
+		inline void list_remove(span_type*& head, span_type* target)
+		{
+			if (target->prev) target->prev->next = target->next;
+			else head = target->next;
+			if (target->next) target->next->prev = target->prev;
+			target->next = nullptr;
+			target->prev = nullptr;
+		}
+
+		template <typename span_type>
+		inline void* pop_block(span_type* target)
+		{
+			void* result = nullptr;
+			if (target->local_free)
+			{
+				result = target->local_free;
+				target->local_free = target->local_free->next;
+			}
+			else if (target->carved < target->capacity)
+			{
+				result = target->blocks + static_cast<size_t>(target->carved) * size_classes.info[target->size_class].size;
+				target->carved++;
+			}
+			else
+			{
+				return nullptr;
+			}
+
+			target->live++;
+			return result;
+		}
+
+	}
+
+	// Keyed by instance id so each allocator gets its own cache per thread. The
+	// destructor runs at thread exit and hands the thread's spans back.
+	struct thread_cache_allocator::thread_cache_table
+	{
+		thread_cache* caches[max_instances] = {};
+		uint64_t generations[max_instances] = {};
+
+		~thread_cache_table()
+		{
+			for (uint32_t i = 0; i < max_instances; i++)
+			{
+				thread_cache* cache = caches[i];
+				caches[i] = nullptr;
+				if (!cache) continue;
+
+				thread_cache_allocator* owner = live_instances[i].load(memory_order_acquire);
+				if (owner && owner->generation_ == generations[i])
+				{
+					owner->abandon_thread_cache(cache);
+				}
+			}
+		}
+	};
+
+	thread_cache_allocator::thread_cache_allocator(size_t reserve_size, internal::os_page_interface& pages)
+		: pages_(&pages)
+	{
+		static_assert(sizeof(span) <= span_header_size, "Span header does not fit its reserved space!");
+
+		for (uint32_t& head : free_runs_)
+		{
+			head = no_run;
+		}
+
+		generation_ = next_generation.fetch_add(1, memory_order_relaxed);
+		for (uint32_t i = 0; i < max_instances; i++)
+		{
+			thread_cache_allocator* expected = nullptr;
+			if (live_instances[i].compare_exchange_strong(expected, this))
+			{
+				instance_ = i;
+				break;
+			}
+		}
+		assert(instance_ < max_instances && "Too many live thread_cache_allocator instances!");
+		if (instance_ >= max_instances)
+		{
+			return;
+		}
+
+		size_t reserved = internal::align_up(reserve_size, span_unit_size);
+		reserve_size_ = reserved + span_unit_size;
+		reserve_base_ = static_cast<char*>(pages_->reserve_memory(reserve_size_));
+		if (!reserve_base_)
+		{
+			reserve_size_ = 0;
+			return;
+		}
+		base_ = static_cast<char*>(internal::align_up(reserve_base_, span_unit_size));
+		unit_count_ = reserved / span_unit_size;
+
+		static_assert(alignof(unit_run) <= alignof(span*), "Unit runs must be able to follow the span map!");
+		span_map_size_ = internal::align_up(unit_count_ * (sizeof(span*) + sizeof(unit_run)), pages_->page_size());
+		span_map_ = static_cast<span**>(pages_->reserve_memory(span_map_size_));
+		if (!span_map_ || !pages_->commit_memory(span_map_, span_map_size_))
+		{
+			if (span_map_) pages_->release_memory(span_map_, span_map_size_);
+			span_map_ = nullptr;
+			return;
+		}
+		runs_ = reinterpret_cast<unit_run*>(span_map_ + unit_count_);
+	}
+
+	thread_cache_allocator::~thread_cache_allocator()
+	{
+		if (instance_ < max_instances)
+		{
+			live_instances[instance_].store(nullptr, memory_order_release);
+		}
+		if (scavenger_ && base_)
+		{
+			scavenger_->forget(base_, unit_count_ * span_unit_size);
+		}
+
+		size_t cache_size = internal::align_up(sizeof(thread_cache), pages_->page_size());
+		for (thread_cache* cache = all_caches_; cache;)
+		{
+			thread_cache* next = cache->next_all;
+			pages_->release_memory(cache, cache_size);
+			cache = next;
+		}
+
+		if (span_map_)
+		{
+			pages_->release_memory(span_map_, span_map_size_);
+		}
+		if (reserve_base_)
+		{
+			pages_->release_memory(reserve_base_, reserve_size_);
+		}
+	}
+
+	void* thread_cache_allocator::allocate(size_t size)
+	{
+		if (size == 0) size = 1;
+		if (size > max_small_size)
+		{
+			return allocate_large(size, ARES_PLATFORM_MIN_MALLOC_ALIGNMENT);
+		}
+		return allocate_small(size_class_of(size));
+	}
+
+	void* thread_cache_allocator::allocate(size_t size, size_t alignment)
+	{
+		assert(internal::is_power_of_two(alignment) && "Alignment must be a power of two!");
+		if (alignment <= ARES_PLATFORM_MIN_MALLOC_ALIGNMENT)
+		{
+			return allocate(size);
+		}
+
+		size_t aligned_size = internal::align_up(size == 0 ? 1 : size, alignment);
+		if (alignment > max_small_alignment || aligned_size > max_small_size)
+		{
+			return allocate_large(size, alignment);
+		}
+
+		// Blocks are aligned to the largest power of two dividing their class size.
+		size_t size_class = size_class_of(aligned_size);
+		while (size_class < class_count && size_of_class(size_class) % alignment != 0)
+		{
+			size_class++;
+		}
+		if (size_class == class_count)
+		{
+			return allocate_large(size, alignment);
+		}
+		return allocate_small(size_class);
+	}
+
+	void thread_cache_allocator::deallocate(void* ptr)
+	{
+		if (!ptr) return;
+
+		if (owns_small(ptr))
+		{
+			size_t unit = static_cast<size_t>(static_cast<char*>(ptr) - base_) / span_unit_size;
+			deallocate_small(span_map_[unit], ptr);
+		}
+		else
+		{
+			deallocate_large(ptr);
+		}
+	}
+
+	void thread_cache_allocator::flush_thread_cache()
+	{
+		if (!span_map_) return;
+
+		if (thread_cache* cache = local_cache())
+		{
+			local_caches().caches[instance_] = nullptr;
+			abandon_thread_cache(cache);
+		}
+	}
+
+	void thread_cache_allocator::set_scavenger(page_scavenger* scavenger) noexcept
+	{
+		// Units stay flagged as retired; reclaim_units commits them again, which is
+		// harmless for the ones that were never decommitted.
+		if (scavenger_ && base_)
+		{
+			scavenger_->forget(base_, unit_count_ * span_unit_size);
+		}
+		scavenger_ = scavenger;
+	}
+
+	size_t thread_cache_allocator::size_class_of(size_t size) noexcept
+	{
+		if (size <= 128)
+		{
+			return size == 0 ? 0 : (size - 1) >> 4;
+		}
+
+		size_t last = size - 1;
+		uint32_t log = internal::find_last_set(last);
+		size_t base = size_t(1) << log;
+		return 8 + (log - 7) * 4 + ((last - base) >> (log - 2));
+	}
+
+	size_t thread_cache_allocator::size_of_class(size_t size_class) noexcept
+	{
+		return size_classes.info[size_class].size;
+	}
+
+	thread_cache_allocator::thread_cache_table& thread_cache_allocator::local_caches()
+	{
+		thread_local thread_cache_table table;
+		return table;
+	}
+
+	// A cache left behind by an earlier allocator with the same id was freed with
+	// it, so it doesn't count.
+	thread_cache_allocator::thread_cache* thread_cache_allocator::local_cache() const
+	{
+		thread_cache_table& table = local_caches();
+		return table.generations[instance_] == generation_ ? table.caches[instance_] : nullptr;
+	}
+
+	thread_cache_allocator::thread_cache* thread_cache_allocator::get_thread_cache()
+	{
+		if (!span_map_) return nullptr;
+
+		if (thread_cache* existing = local_cache())
+		{
+			return existing;
+		}
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		thread_cache* cache = free_caches_;
+		if (cache)
+		{
+			free_caches_ = cache->next_free;
+			cache->next_free = nullptr;
+		}
+		else
+		{
+			size_t cache_size = internal::align_up(sizeof(thread_cache), pages_->page_size());
+			void* mem = pages_->reserve_memory(cache_size);
+			if (!mem) return nullptr;
+			if (!pages_->commit_memory(mem, cache_size))
+			{
+				pages_->release_memory(mem, cache_size);
+				return nullptr;
+			}
+
+			cache = new (mem) thread_cache();
+			cache->next_all = all_caches_;
+			all_caches_ = cache;
+		}
+
+		thread_cache_table& table = local_caches();
+		table.caches[instance_] = cache;
+		table.generations[instance_] = generation_;
+		return cache;
+	}
+
+	void thread_cache_allocator::abandon_thread_cache(thread_cache* cache)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		for (size_t size_class = 0; size_class < class_count; size_class++)
+		{
+			span** lists[] = { &cache->partial[size_class], &cache->full[size_class] };
+			for (span** list : lists)
+			{
+				for (span* target = *list; target;)
+				{
+					span* next = target->next;
+					target->owner.store(nullptr);
+					target->full.store(false);
+					collect_remote_frees(target);
+
+					if (target->live == 0)
+					{
+						release_span(target);
+					}
+					else
+					{
+						list_push(abandoned_[size_class], target);
+					}
+					target = next;
+				}
+				*list = nullptr;
+			}
+		}
+
+		cache->next_free = free_caches_;
+		free_caches_ = cache;
+	}
+
+	void* thread_cache_allocator::allocate_small(size_t size_class)
+	{
+		thread_cache* cache = get_thread_cache();
+		if (!cache) return nullptr;
+
+		if (span* target = cache->partial[size_class])
+		{
+			if (void* result = pop_block(target))
+			{
+				return result;
+			}
+		}
+		return allocate_slow(cache, size_class);
+	}
+
+	void* thread_cache_allocator::allocate_slow(thread_cache* cache, size_t size_class)
+	{
+		for (int pass = 0; pass < 2; pass++)
+		{
+			for (span* target = cache->partial[size_class]; target;)
+			{
+				collect_remote_frees(target);
+				if (void* result = pop_block(target))
+				{
+					return result;
+				}
+
+				// Exhausted. Flag it before the final check of the remote list so a
+				// concurrent remote free either lands here or sees the flag and
+				// marks its class as pending on our cache.
+				span* next = target->next;
+				list_remove(cache->partial[size_class], target);
+				target->full.store(true);
+				if (target->remote_free.load() != nullptr)
+				{
+					target->full.store(false, memory_order_relaxed);
+					list_push(cache->partial[size_class], target);
+					collect_remote_frees(target);
+					return pop_block(target);
+				}
+				list_push(cache->full[size_class], target);
+				target = next;
+			}
+
+			if (pass == 0)
+			{
+				reclaim_full_spans(cache, size_class);
+			}
+		}
+
+		for (;;)
+		{
+			span* target = acquire_span(cache, size_class);
+			if (!target) return nullptr;
+
+			if (void* result = pop_block(target))
+			{
+				list_push(cache->partial[size_class], target);
+				return result;
+			}
+
+			// An adopted span with every block still live.
+			target->full.store(true);
+			if (target->remote_free.load() != nullptr)
+			{
+				target->full.store(false, memory_order_relaxed);
+				list_push(cache->partial[size_class], target);
+				collect_remote_frees(target);
+				return pop_block(target);
+			}
+			list_push(cache->full[size_class], target);
+		}
+	}
+
+	void* thread_cache_allocator::allocate_large(size_t size, size_t alignment)
+	{
+		if (alignment < alignof(large_header)) alignment = alignof(large_header);
+
+		size_t page_size = pages_->page_size();
+		size_t header = internal::align_up(sizeof(large_header), alignment);
+		size_t total = internal::align_up(header + size + (alignment > page_size ? alignment : 0), page_size);
+
+		char* base = static_cast<char*>(pages_->reserve_memory(total));
+		if (!base) return nullptr;
+		if (!pages_->commit_memory(base, total))
+		{
+			pages_->release_memory(base, total);
+			return nullptr;
+		}
+
+		char* result = static_cast<char*>(internal::align_up(base + header, alignment));
+		large_header* info = reinterpret_cast<large_header*>(result) - 1;
+		info->base = base;
+		info->size = total;
+		return result;
+	}
+
+	void thread_cache_allocator::deallocate_small(span* owner_span, void* ptr)
+	{
+		free_block* block = static_cast<free_block*>(ptr);
+		thread_cache* cache = span_map_ ? local_cache() : nullptr;
+
+		if (cache && owner_span->owner.load(memory_order_relaxed) == cache)
+		{
+			size_t size_class = owner_span->size_class;
+			block->next = owner_span->local_free;
+			owner_span->local_free = block;
+			owner_span->live--;
+
+			if (owner_span->full.load(memory_order_relaxed))
+			{
+				list_remove(cache->full[size_class], owner_span);
+				owner_span->full.store(false, memory_order_relaxed);
+				list_push(cache->partial[size_class], owner_span);
+
+				// Only the head of the list is kept once empty, and this one just
+				// replaced it.
+				span* displaced = owner_span->next;
+				if (displaced && displaced->live == 0)
+				{
+					list_remove(cache->partial[size_class], displaced);
+					std::lock_guard<std::mutex> lock(mutex_);
+					release_span(displaced);
+				}
+			}
+			else if (owner_span->live == 0 && cache->partial[size_class] != owner_span)
+			{
+				list_remove(cache->partial[size_class], owner_span);
+				std::lock_guard<std::mutex> lock(mutex_);
+				release_span(owner_span);
+			}
+			return;
+		}
+
+		free_block* head = owner_span->remote_free.load(memory_order_relaxed);
+		do
+		{
+			block->next = head;
+		} while (!owner_span->remote_free.compare_exchange_weak(head, block));
+
+		// The first remote free into a full span tells the owner to look at its
+		// full spans of this class again. A stale owner only costs it a scan.
+		if (!head && owner_span->full.load())
+		{
+			if (thread_cache* owner = owner_span->owner.load(memory_order_acquire))
+			{
+				owner->pending_classes.fetch_or(uint64_t(1) << owner_span->size_class, memory_order_release);
+			}
+		}
+	}
+
+	void thread_cache_allocator::deallocate_large(void* ptr)
+	{
+		large_header* info = static_cast<large_header*>(ptr) - 1;
+		pages_->release_memory(info->base, info->size);
+	}
+
+	thread_cache_allocator::span* thread_cache_allocator::acquire_span(thread_cache* cache, size_t size_class)
+	{
+		const size_class_info& info = size_classes.info[size_class];
+		uint32_t units = static_cast<uint32_t>(info.units);
+		uint32_t first = no_run;
+		bool fresh = false;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (span* adopted = abandoned_[size_class])
+			{
+				list_remove(abandoned_[size_class], adopted);
+				adopted->owner.store(cache);
+				collect_remote_frees(adopted);
+				return adopted;
+			}
+
+			first = take_units(units);
+			if (first == no_run)
+			{
+				if (next_unit_ + units > unit_count_) return nullptr;
+				first = static_cast<uint32_t>(next_unit_);
+				next_unit_ += units;
+				fresh = true;
+			}
+
+			// Mapped under the lock, or a neighbour being freed would take the
+			// units for a free run.
+			span* mapped = reinterpret_cast<span*>(base_ + static_cast<size_t>(first) * span_unit_size);
+			for (uint32_t i = 0; i < units; i++)
+			{
+				span_map_[first + i] = mapped;
+			}
+		}
+
+		char* mem = base_ + static_cast<size_t>(first) * span_unit_size;
+		bool committed = fresh ? pages_->commit_memory(mem, units * span_unit_size) : reclaim_units(first, units);
+		if (!committed)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			free_units(first, units);
+			return nullptr;
+		}
+
+		span* result = new (mem) span();
+		result->owner.store(cache, memory_order_relaxed);
+		result->remote_free.store(nullptr, memory_order_relaxed);
+		result->full.store(false, memory_order_relaxed);
+		result->blocks = mem + info.block_offset;
+		result->size_class = static_cast<uint32_t>(size_class);
+		result->units = units;
+		result->capacity = static_cast<uint32_t>(info.capacity);
+		return result;
+	}
+
+	void thread_cache_allocator::release_span(span* target)
+	{
+		target->owner.store(nullptr, memory_order_relaxed);
+		uint32_t first = static_cast<uint32_t>((reinterpret_cast<char*>(target) - base_) / span_unit_size);
+		free_units(first, target->units);
+	}
+
+	// Merges the units with the free runs on either side. Units that stopped
+	// being free are never read as run edges, so only the new edges are written.
+	void thread_cache_allocator::free_units(uint32_t first, uint32_t count)
+	{
+		for (uint32_t i = first; i < first + count; i++)
+		{
+			span_map_[i] = nullptr;
+			if (scavenger_ && !runs_[i].retired)
+			{
+				runs_[i].retired = 1;
+				scavenger_->retire(base_ + static_cast<size_t>(i) * span_unit_size, span_unit_size);
+			}
+		}
+
+		if (first > 0 && !span_map_[first - 1])
+		{
+			uint32_t below = runs_[first - 1].length;
+			first -= below;
+			count += below;
+			remove_run(first);
+		}
+
+		uint32_t above = first + count;
+		if (above < next_unit_ && !span_map_[above])
+		{
+			count += runs_[above].length;
+			remove_run(above);
+		}
+		insert_run(first, count);
+	}
+
+	// Exact fits first, then the smallest bin with longer runs; the last bin
+	// holds every run of max_span_units or more.
+	uint32_t thread_cache_allocator::take_units(uint32_t count)
+	{
+		uint32_t first = no_run;
+		for (uint32_t bin = count; bin < max_span_units && first == no_run; bin++)
+		{
+			first = free_runs_[bin];
+		}
+		for (uint32_t run = free_runs_[max_span_units]; run != no_run && first == no_run; run = runs_[run].next)
+		{
+			if (runs_[run].length >= count)
+			{
+				first = run;
+			}
+		}
+		if (first == no_run)
+		{
+			return no_run;
+		}
+
+		uint32_t length = runs_[first].length;
+		remove_run(first);
+		if (length > count)
+		{
+			insert_run(first + count, length - count);
+		}
+		return first;
+	}
+
+	void thread_cache_allocator::insert_run(uint32_t first, uint32_t length)
+	{
+		uint32_t bin = length < max_span_units ? length : static_cast<uint32_t>(max_span_units);
+		runs_[first].length = length;
+		runs_[first + length - 1].length = length;
+		runs_[first].prev = no_run;
+		runs_[first].next = free_runs_[bin];
+		if (free_runs_[bin] != no_run)
+		{
+			runs_[free_runs_[bin]].prev = first;
+		}
+		free_runs_[bin] = first;
+	}
+
+	void thread_cache_allocator::remove_run(uint32_t first)
+	{
+		unit_run& run = runs_[first];
+		uint32_t bin = run.length < max_span_units ? run.length : static_cast<uint32_t>(max_span_units);
+		if (run.prev != no_run) runs_[run.prev].next = run.next;
+		else free_runs_[bin] = run.next;
+		if (run.next != no_run) runs_[run.next].prev = run.prev;
+	}
+
+	// The units were taken off the free runs, so no other thread touches them.
+	bool thread_cache_allocator::reclaim_units(uint32_t first, uint32_t count)
+	{
+		for (uint32_t i = first; i < first + count; i++)
+		{
+			if (!runs_[i].retired) continue;
+
+			char* unit = base_ + static_cast<size_t>(i) * span_unit_size;
+			if (!(scavenger_ && scavenger_->reclaim(unit, span_unit_size)) && !pages_->commit_memory(unit, span_unit_size))
+			{
+				return false;
+			}
+			runs_[i].retired = 0;
+		}
+		return true;
+	}
+
+	void thread_cache_allocator::collect_remote_frees(span* target)
+	{
+		free_block* list = target->remote_free.exchange(nullptr, memory_order_acquire);
+		while (list)
+		{
+			free_block* next = list->next;
+			list->next = target->local_free;
+			target->local_free = list;
+			target->live--;
+			list = next;
+		}
+	}
+
+	void thread_cache_allocator::reclaim_full_spans(thread_cache* cache, size_t size_class)
+	{
+		uint64_t bit = uint64_t(1) << size_class;
+		if (!(cache->pending_classes.load(memory_order_relaxed) & bit)) return;
+		cache->pending_classes.fetch_and(~bit, memory_order_acquire);
+
+		for (span* target = cache->full[size_class]; target;)
+		{
+			span* next = target->next;
+			if (target->remote_free.load(memory_order_acquire) != nullptr)
+			{
+				list_remove(cache->full[size_class], target);
+				target->full.store(false, memory_order_relaxed);
+				collect_remote_frees(target);
+				list_push(cache->partial[size_class], target);
+			}
+			target = next;
+		}
+	}
+
+	inline bool thread_cache_allocator::owns_small(const void* ptr) const noexcept
+	{
+		const char* p = static_cast<const char*>(ptr);
+		return p >= base_ && p < base_ + unit_count_ * span_unit_size;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,361 @@
+#include <ares_core_pch.h>
+#include "core/tlsf_allocator.h"
+#include "core/internal/alignment.h"
+#include "core/internal/bits.h"
+
+namespace ares::core {
+
+	// 'size' is the payload size, a multiple of 16, with the state kept in the low
+	// bits. The free list links overlay the payload, so only the first two fields
+	// are overhead.
+	struct tlsf_allocator::block_header
+	{
+		static constexpr size_t free_bit = 1;
+		static constexpr size_t prev_free_bit = 2;
+		static constexpr size_t flag_mask = free_bit | prev_free_bit;
+
+		block_header* prev_physical;
+		size_t size_and_flags;
+		block_header* next_free;
+		block_header* prev_free;
+
+		inline size_t size() const noexcept { return size_and_flags & ~flag_mask; }
+		inline void set_size(size_t size) noexcept { size_and_flags = size | (size_and_flags & flag_mask); }
+		inline bool is_free() const noexcept { return size_and_flags & free_bit; }
+		inline bool is_prev_free() const noexcept { return size_and_flags & prev_free_bit; }
+		inline void set_free(bool value) noexcept { size_and_flags = value ? size_and_flags | free_bit : size_and_flags & ~free_bit; }
+		inline void set_prev_free(bool value) noexcept { size_and_flags = value ? size_and_flags | prev_free_bit : size_and_flags & ~prev_free_bit; }
+
+		inline char* payload() noexcept { return reinterpret_cast<char*>(&next_free); }
+		inline block_header* next_physical() noexcept { return reinterpret_cast<block_header*>(payload() + size()); }
+
+		static inline block_header* from_payload(const void* ptr) noexcept
+		{
+			return reinterpret_cast<block_header*>(const_cast<char*>(static_cast<const char*>(ptr)) - overhead);
+		}
+
+		static constexpr size_t overhead = sizeof(block_header*) + sizeof(size_t);
+		static constexpr size_t min_size = sizeof(block_header*) * 2;
+	};
+
+	tlsf_allocator::tlsf_allocator(size_t reserve_size, size_t grow_size, internal::page_flags flags, internal::os_page_interface& pages)
+		: pages_(&pages)
+	{
+		static_assert(block_header::overhead % block_alignment == 0, "Block header breaks payload alignment!");
+		static_assert(block_alignment >= ARES_PLATFORM_MIN_MALLOC_ALIGNMENT, "Block alignment is below the platform minimum!");
+
+		assert(reserve_size < (size_t(1) << (fl_shift + fl_count - 1)) && "Reserve size exceeds the largest first level!");
+
+		reserved_ = internal::align_up(reserve_size, internal::reserve_granularity(*pages_, flags));
+		base_ = static_cast<char*>(pages_->reserve_memory(reserved_, flags));
+		if (!base_)
+		{
+			reserved_ = 0;
+			return;
+		}
+		page_size_ = pages_->page_size(base_);
+		grow_size_ = internal::align_up(grow_size, page_size_);
+	}
+
+	tlsf_allocator::~tlsf_allocator()
+	{
+		if (base_)
+		{
+			pages_->release_memory(base_, reserved_);
+		}
+	}
+
+	void* tlsf_allocator::allocate(size_t size)
+	{
+		return allocate(size, block_alignment);
+	}
+
+	void* tlsf_allocator::allocate(size_t size, size_t alignment)
+	{
+		assert(internal::is_power_of_two(alignment) && "Alignment must be a power of two!");
+		if (!base_ || size > reserved_)
+		{
+			return nullptr;
+		}
+
+		size_t adjusted = internal::align_up(size < block_header::min_size ? block_header::min_size : size, block_alignment);
+
+		// Over-aligned requests search for enough room to split a free block off
+		// the front.
+		size_t gap = alignment > block_alignment ? alignment + block_header::overhead + block_header::min_size : 0;
+		size_t search = adjusted + gap;
+
+		block_header* block = locate_free(search);
+		if (!block)
+		{
+			if (!grow(search)) return nullptr;
+			block = locate_free(search);
+			if (!block) return nullptr;
+		}
+
+		if (gap)
+		{
+			block = trim_front(block, alignment);
+		}
+		split(block, adjusted);
+
+		block->set_free(false);
+		block->next_physical()->set_prev_free(false);
+		used_ += block->size();
+		return block->payload();
+	}
+
+	void tlsf_allocator::deallocate(void* ptr)
+	{
+		if (!ptr) return;
+		assert(owns(ptr) && "Pointer does not belong to this allocator!");
+
+		block_header* block = block_header::from_payload(ptr);
+		assert(!block->is_free() && "Block is already free!");
+		used_ -= block->size();
+
+		block->set_free(true);
+		block_header* next = block->next_physical();
+		next->set_prev_free(true);
+		next->prev_physical = block;
+
+		insert_free(merge(block));
+	}
+
+	bool tlsf_allocator::owns(const void* ptr) const noexcept
+	{
+		const char* p = static_cast<const char*>(ptr);
+		return p >= base_ && p < base_ + committed_;
+	}
+
+	size_t tlsf_allocator::block_size(const void* ptr) const noexcept
+	{
+		return block_header::from_payload(ptr)->size();
+	}
+
+	void tlsf_allocator::mapping_insert(size_t size, uint32_t& fl, uint32_t& sl) noexcept
+	{
+		if (size < small_block_size)
+		{
+			fl = 0;
+			sl = static_cast<uint32_t>(size / (small_block_size / sl_count));
+		}
+		else
+		{
+			uint32_t log = internal::find_last_set(size);
+			sl = static_cast<uint32_t>(size >> (log - sl_log2)) ^ sl_count;
+			fl = log - (fl_shift - 1);
+		}
+	}
+
+	void tlsf_allocator::mapping_search(size_t size, uint32_t& fl, uint32_t& sl) noexcept
+	{
+		// Round up to the next list so any block found there is large enough.
+		if (size >= small_block_size)
+		{
+			size += (size_t(1) << (internal::find_last_set(size) - sl_log2)) - 1;
+		}
+		mapping_insert(size, fl, sl);
+	}
+
+	void tlsf_allocator::insert_free(block_header* block) noexcept
+	{
+		uint32_t fl = 0, sl = 0;
+		mapping_insert(block->size(), fl, sl);
+
+		block_header* head = free_lists_[fl][sl];
+		block->next_free = head;
+		block->prev_free = nullptr;
+		if (head) head->prev_free = block;
+		free_lists_[fl][sl] = block;
+
+		fl_bitmap_ |= 1u << fl;
+		sl_bitmap_[fl] |= 1u << sl;
+	}
+
+	void tlsf_allocator::remove_free(block_header* block) noexcept
+	{
+		uint32_t fl = 0, sl = 0;
+		mapping_insert(block->size(), fl, sl);
+
+		if (block->prev_free) block->prev_free->next_free = block->next_free;
+		else free_lists_[fl][sl] = block->next_free;
+		if (block->next_free) block->next_free->prev_free = block->prev_free;
+
+		if (!free_lists_[fl][sl])
+		{
+			sl_bitmap_[fl] &= ~(1u << sl);
+			if (!sl_bitmap_[fl])
+			{
+				fl_bitmap_ &= ~(1u << fl);
+			}
+		}
+	}
+
+	tlsf_allocator::block_header* tlsf_allocator::locate_free(size_t size) noexcept
+	{
+		uint32_t fl = 0, sl = 0;
+		mapping_search(size, fl, sl);
+		if (fl >= fl_count)
+		{
+			return nullptr;
+		}
+
+		uint32_t sl_map = sl_bitmap_[fl] & (~0u << sl);
+		if (!sl_map)
+		{
+			uint32_t fl_map = fl + 1 < fl_count ? fl_bitmap_ & (~0u << (fl + 1)) : 0;
+			if (!fl_map)
+			{
+				return nullptr;
+			}
+			fl = internal::find_first_set(fl_map);
+			sl_map = sl_bitmap_[fl];
+		}
+		sl = internal::find_first_set(sl_map);
+
+		block_header* block = free_lists_[fl][sl];
+		remove_free(block);
+		return block;
+	}
+
+	tlsf_allocator::block_header* tlsf_allocator::trim_front(block_header* block, size_t alignment) noexcept
+	{
+		char* payload = block->payload();
+		char* aligned = static_cast<char*>(internal::align_up(payload, alignment));
+		size_t gap = static_cast<size_t>(aligned - payload);
+		if (gap == 0)
+		{
+			return block;
+		}
+
+		// The leading gap becomes a free block of its own, so it needs room for one.
+		if (gap < block_header::overhead + block_header::min_size)
+		{
+			aligned = static_cast<char*>(internal::align_up(payload + block_header::overhead + block_header::min_size, alignment));
+			gap = static_cast<size_t>(aligned - payload);
+		}
+
+		block_header* result = block_header::from_payload(aligned);
+		result->size_and_flags = 0;
+		result->set_size(block->size() - gap);
+		result->set_free(true);
+		result->set_prev_free(true);
+		result->prev_physical = block;
+		result->next_physical()->prev_physical = result;
+
+		block->set_size(gap - block_header::overhead);
+		insert_free(block);
+		return result;
+	}
+
+	void tlsf_allocator::split(block_header* block, size_t size) noexcept
+	{
+		if (block->size() < size + block_header::overhead + block_header::min_size)
+		{
+			return;
+		}
+
+		block_header* remainder = reinterpret_cast<block_header*>(block->payload() + size);
+		remainder->size_and_flags = 0;
+		remainder->set_size(block->size() - size - block_header::overhead);
+		remainder->set_free(true);
+		remainder->set_prev_free(true);
+		remainder->prev_physical = block;
+
+		block_header* next = remainder->next_physical();
+		next->prev_physical = remainder;
+		next->set_prev_free(true);
+
+		block->set_size(size);
+		insert_free(remainder);
+	}
+
+	tlsf_allocator::block_header* tlsf_allocator::merge(block_header* block) noexcept
+	{
+		if (block->is_prev_free())
+		{
+			block_header* prev = block->prev_physical;
+			remove_free(prev);
+			prev->set_size(prev->size() + block_header::overhead + block->size());
+			block = prev;
+		}
+
+		block_header* next = block->next_physical();
+		if (next->is_free())
+		{
+			remove_free(next);
+			block->set_size(block->size() + block_header::overhead + next->size());
+		}
+
+		block->next_physical()->prev_physical = block;
+		return block;
+	}
+
+	bool tlsf_allocator::warm(size_t size, internal::commit_flags flags) noexcept
+	{
+		if (!base_)
+		{
+			return false;
+		}
+
+		// Memory committed before is faulted in as well; what grow() adds already
+		// carries the flags.
+		size_t existing = committed_;
+		if (existing && !pages_->commit_memory(base_, existing, flags | commit_flags_))
+		{
+			return false;
+		}
+
+		if (size > existing)
+		{
+			internal::commit_flags saved = commit_flags_;
+			commit_flags_ = flags | saved;
+			bool result = grow(size - existing);
+			commit_flags_ = saved;
+			return result;
+		}
+		return true;
+	}
+
+	bool tlsf_allocator::grow(size_t size) noexcept
+	{
+		// Leave room for the search rounding, the new sentinel and the first header.
+		size_t required = size + (size >> sl_log2) + block_header::overhead * 3;
+		size_t commit_size = internal::align_up(required > grow_size_ ? required : grow_size_, page_size_);
+		if (!base_ || committed_ + commit_size > reserved_)
+		{
+			return false;
+		}
+		if (!pages_->commit_memory(base_ + committed_, commit_size, commit_flags_))
+		{
+			return false;
+		}
+
+		// The new range turns the old end sentinel into a free block.
+		block_header* block = nullptr;
+		if (sentinel_)
+		{
+			block = sentinel_;
+		}
+		else
+		{
+			block = reinterpret_cast<block_header*>(base_);
+			block->size_and_flags = 0;
+			block->prev_physical = nullptr;
+		}
+		committed_ += commit_size;
+
+		sentinel_ = reinterpret_cast<block_header*>(base_ + committed_ - block_header::overhead);
+		block->set_size(static_cast<size_t>(reinterpret_cast<char*>(sentinel_) - block->payload()));
+		block->set_free(true);
+
+		sentinel_->size_and_flags = 0;
+		sentinel_->set_prev_free(true);
+		sentinel_->prev_physical = block;
+
+		insert_free(merge(block));
+		return true;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,14 @@
+#include <ares_launcher_pch.h>
+#include "core/allocation_telemetry.h"
+
+#if ARES_ALLOCATION_TELEMETRY
+namespace ares::core {
+
+	allocation_telemetry& get_allocation_telemetry()
+	{
+		static allocation_telemetry result;
+		return result;
+	}
+
+}
+#endif
\ No newline at end of file
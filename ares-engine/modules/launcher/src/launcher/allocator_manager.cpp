@@ -0,0 +1,68 @@
+#include <ares_launcher_pch.h>
+#include "core/allocator_manager.h"
+#include "core/default_allocator.h"
+#include "core/frame_allocator.h"
+#include "core/temp_allocator.h"
+#include "core/thread_cache_allocator.h"
+
+namespace ares::core {
+
+	namespace internal {
+
+		atomic<allocator*> allocator_slots[static_cast<size_t>(allocator_slot::count)];
+
+		static std::mutex& allocator_slots_mutex()
+		{
+			static std::mutex result;
+			return result;
+		}
+
+		allocator* resolve_allocator_slot(allocator_slot slot)
+		{
+			std::lock_guard<std::mutex> lock(allocator_slots_mutex());
+
+			atomic<allocator*>& entry = allocator_slots[static_cast<size_t>(slot)];
+			if (allocator* existing = entry.load(memory_order_acquire))
+			{
+				return existing;
+			}
+
+			allocator* result = nullptr;
+			switch (slot)
+			{
+			case allocator_slot::default_heap:
+			{
+				static default_allocator instance;
+				result = &instance;
+				break;
+			}
+			case allocator_slot::temp:
+				result = &get_temp_allocator();
+				break;
+			case allocator_slot::thread_cache:
+			{
+				static thread_cache_allocator instance;
+				result = &instance;
+				break;
+			}
+			case allocator_slot::frame:
+				result = &get_frame_allocator();
+				break;
+			default:
+				break;
+			}
+
+			assert(result && "No allocator has been registered for this slot!");
+			entry.store(result, memory_order_release);
+			return result;
+		}
+
+	}
+
+	void register_allocator(allocator_slot slot, allocator* alloc)
+	{
+		std::lock_guard<std::mutex> lock(internal::allocator_slots_mutex());
+		internal::allocator_slots[static_cast<size_t>(slot)].store(alloc, memory_order_release);
+	}
+
+}
\ No newline at end of file
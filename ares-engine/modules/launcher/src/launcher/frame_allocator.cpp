@@ -0,0 +1,12 @@
+#include <ares_launcher_pch.h>
+#include "core/frame_allocator.h"
+
+namespace ares::core {
+
+	frame_allocator& get_frame_allocator()
+	{
+		static frame_allocator result;
+		return result;
+	}
+
+}
\ No newline at end of file
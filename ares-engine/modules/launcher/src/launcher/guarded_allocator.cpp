@@ -0,0 +1,18 @@
+#include <ares_launcher_pch.h>
+#include "core/guarded_allocator.h"
+
+namespace ares::core {
+
+	guarded_allocator& get_guarded_allocator()
+	{
+		static guarded_allocator result;
+		return result;
+	}
+
+	guard_selection& get_guard_selection()
+	{
+		static guard_selection result;
+		return result;
+	}
+
+}
\ No newline at end of file
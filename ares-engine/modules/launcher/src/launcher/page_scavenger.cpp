@@ -0,0 +1,12 @@
+#include <ares_launcher_pch.h>
+#include "core/page_scavenger.h"
+
+namespace ares::core {
+
+	page_scavenger& get_page_scavenger()
+	{
+		static page_scavenger result;
+		return result;
+	}
+
+}
\ No newline at end of file
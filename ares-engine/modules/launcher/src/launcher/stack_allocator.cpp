@@ -0,0 +1,12 @@
+#include <ares_launcher_pch.h>
+#include "core/stack_allocator.h"
+
+namespace ares::core {
+
+	stack_allocator& get_thread_stack_allocator()
+	{
+		thread_local stack_allocator result;
+		return result;
+	}
+
+}
\ No newline at end of file